@@ -0,0 +1,513 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file KernelNative.hpp
+ */
+
+#ifndef TRES_KERNELNATIVE_HDR
+#define TRES_KERNELNATIVE_HDR
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+#include <tres/Kernel.hpp>
+#include <tres/KernelConfig.hpp>
+#include "../../src/BitmapReadyQueue.hpp"
+#include "../../src/EventQueueNative.hpp"
+#include "../../src/EventNative.hpp"
+#include "../../src/SimTaskNative.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Native (RTSim-free) implementation of tres::Kernel
+     *
+     * A discrete-event scheduling engine built for the co-simulation
+     * protocol: times are integer ticks, jobs execute the instructions
+     * given by the co-simulation one after the other, and the state of
+     * the engine is entirely owned by the instance (several kernels can
+     * be simulated at once, with no shared event queue).
+     *
+     * Supported scheduling policies (SchedulerConfig::policy):
+     *  - "FIXED_PRIORITY" (lower value, higher priority; the priority is
+     *    the first of the TaskConfig::params, tasks with no priority are
+     *    ordered by declaration)
+     *  - "DEADLINE_MONOTONIC", "RATE_MONOTONIC"
+     *  - "EDF"
+     *  - "RR" (round-robin, the first numeric parameter is the quantum
+     *    in ticks)
+     *  - "FIFO" (non-preemptive)
+     *
+     * On multicore platforms, the parameter "global" (default),
+     * "partitioned" or "clustered:<n>" selects the scheduling mode: the
+     * cores are split into clusters of n consecutive cores (1 when
+     * partitioned, all of them when global), each one with its own ready
+     * queue. A task runs in the cluster of the core given by the second
+     * of its TaskConfig::params; tasks with no core are assigned
+     * round-robin or, with the parameter "ffd" (first-fit decreasing) or
+     * "wfd" (worst-fit decreasing), packed by utilization (estimated from
+     * their first instruction). Ties between jobs are broken by
+     * activation order.
+     *
+     * The parameter "heap" (default) or "calendar" selects the event-queue
+     * backend: a binary heap, or a calendar queue for kernels with many
+     * pending events (see CalendarQueue).
+     *
+     * With the parameter "replay", a set of periodic tasks is checked for
+     * a steady state at every hyperperiod boundary (after the largest
+     * phase): if the state (jobs, remaining work, ready queues and pending
+     * events, relative to the boundary) is the same as one hyperperiod
+     * before, the events of the last hyperperiod are replayed with shifted
+     * times instead of being simulated, as long as the co-simulation gives
+     * the same instruction durations. On the first different input, the
+     * engine goes back to simulation from the state at the start of the
+     * hyperperiod. Kernels with aperiodic tasks never replay.
+     *
+     * The whole state of the engine can be saved and restored (see
+     * tres::Kernel::saveState()), into a kernel with the same configuration
+     * that has been initialized. A hyperperiod being replayed is simulated
+     * before saving, and steady-state detection starts over after loading.
+     */
+    class KernelNative : public tres::Kernel
+    {
+
+        friend class SimTaskNative;
+
+    public:
+
+        /** Engine counters */
+        struct Stats
+        {
+            /** Processed events */
+            uint64_t events;
+
+            /** Jobs activated */
+            uint64_t jobs;
+
+            /** Preemptions (including round-robin quantum expirations) */
+            uint64_t preemptions;
+
+            /** Jobs resumed on a core other than the last one */
+            uint64_t migrations;
+
+            /** Jobs completed after their absolute deadline */
+            uint64_t deadline_misses;
+
+            /** Activations dropped because of a full activation buffer */
+            uint64_t lost_activations;
+
+            /** Hyperperiods replayed rather than simulated (the other
+             * counters are updated at the end of each of them) */
+            uint64_t replayed_periods;
+        };
+
+        /** Maximum number of buffered activations of a task */
+        static const std::size_t MAX_BUFFERED_ACTIVATIONS = 1000;
+
+        /** Maximum number of events of a hyperperiod, for replay */
+        static const std::size_t MAX_REPLAY_EVENTS = 1 << 20;
+
+        /**
+         * \brief Creator function used for object construction
+         * according to the Factory Method pattern
+         */
+        static tres::Kernel* createInstance(std::vector<std::string>&);
+
+        /**
+         * \brief Creator function (typed configuration)
+         */
+        static tres::Kernel* createInstance(const KernelConfig&);
+
+        /**
+         * \brief The destructor
+         */
+        virtual ~KernelNative() noexcept(true);
+
+        virtual void initializeSimulation(const double, const double * const *);
+
+        virtual void processNextEvent();
+
+        virtual tres::RTOSEvent* getNextEvent();
+
+        virtual int getTimeOfNextEvent();
+
+        virtual int getNextWakeUpTime();
+
+        virtual void getRunningTasks();
+
+        virtual void activateAperiodicTasks(std::vector<int>&, int);
+
+        /**
+         * \brief Return the current time (ticks)
+         */
+        long long getTime() const { return _now; }
+
+        /**
+         * \brief Return the engine counters
+         */
+        const Stats& getStats() const { return _stats; }
+
+        /**
+         * \brief Whether the engine is replaying a hyperperiod
+         */
+        bool isReplaying() const { return _replay == REPLAY_ON; }
+
+    protected:
+
+        /** Scheduling policies */
+        enum Policy { FP, DM, RM, EDF, RR, FIFO };
+
+        /** Bin-packing heuristics */
+        enum Packing { PACK_NONE, PACK_FFD, PACK_WFD };
+
+        /** Hyperperiod replay: disabled, looking for a steady state, replaying */
+        enum ReplayMode { REPLAY_OFF, REPLAY_DETECT, REPLAY_ON };
+
+        /** Entry of a ready queue (ordered by key, then by activation order) */
+        struct _ReadyEntry
+        {
+            long long key;
+            uint64_t seq;
+            uint32_t task;
+
+            bool operator<(const _ReadyEntry &o) const
+            {
+                if (key != o.key) return key < o.key;
+                return seq < o.seq;
+            }
+        };
+
+        /** A set of cores sharing a ready queue */
+        struct _Cluster
+        {
+            /** The cores of the cluster */
+            std::vector<int> cores;
+
+            /** The ready (not running) jobs (dynamic priorities) */
+            std::set<_ReadyEntry> ready;
+
+            /** The ready (not running) jobs (static priorities) */
+            BitmapReadyQueue bitmap;
+
+            /** The tasks of the cluster (static priorities) */
+            std::vector<uint32_t> members;
+
+            /** The running jobs (the lowest-priority one last) */
+            std::set<_ReadyEntry> running;
+
+            /** The idle cores (min-heap) */
+            std::priority_queue<int, std::vector<int>, std::greater<int> > idle;
+
+            /** Whether a scheduling decision is pending */
+            bool dirty;
+
+            _Cluster() : dirty(false) {}
+        };
+
+        /** Scheduling state of a task */
+        struct _TaskState
+        {
+            /** Timing parameters (ticks) */
+            long long iat;
+            long long rdl;
+            long long ph;
+
+            /** Whether activations are re-armed every iat */
+            bool periodic;
+
+            /** Static priority (FIXED_PRIORITY) */
+            long long prio;
+
+            /** Cluster the task belongs to, and whether it was given by
+             * the configuration */
+            int cluster;
+            bool pinned;
+
+            /** Priority level and index within the cluster (static priorities) */
+            uint32_t level;
+            uint32_t local;
+
+            /** Whether a job is active (ready or running) */
+            bool active;
+
+            /** Core the job runs on (-1 if not running) and last core used */
+            int core;
+            int last_core;
+
+            /** Remaining time of the current instruction and the time
+             * it was last (re)started */
+            long long remaining;
+            long long run_start;
+
+            /** Absolute deadline of the current job */
+            long long deadline;
+
+            /** Ready queue entry of the current job */
+            _ReadyEntry entry;
+
+            /** Generations of the pending instruction end and quantum events */
+            uint32_t instr_gen;
+            uint32_t slice_gen;
+
+            /** Activations received while a job was active */
+            std::deque<long long> buffered;
+
+            /** The task seen by the co-simulation (instructions) */
+            SimTaskNative sim;
+        };
+
+        /** State of the engine at a hyperperiod boundary */
+        struct _Snapshot
+        {
+            bool valid;
+            long long boundary;
+            long long now;
+            std::vector<_TaskState> tasks;
+            std::vector<_Cluster> clusters;
+            std::vector<int> cores;
+
+            /** The valid pending events, in order */
+            std::vector<NativeEvent> events;
+
+            uint64_t evt_seq;
+            uint64_t act_seq;
+            bool dispatch_pending;
+            std::vector<int> dirty;
+            Stats stats;
+
+            _Snapshot() :
+                valid(false), boundary(0), now(0), evt_seq(0), act_seq(0), dispatch_pending(false), stats() {}
+        };
+
+        /** An input of the co-simulation (an instruction added or discarded) */
+        struct _Input
+        {
+            /** Events processed since the boundary, when it was given */
+            uint32_t event;
+            uint32_t task;
+            bool discard;
+            int duration;
+
+            bool operator==(const _Input &o) const
+            {
+                return event == o.event && task == o.task && discard == o.discard && duration == o.duration;
+            }
+        };
+
+        /** A change of the task running on a core */
+        struct _CoreChange
+        {
+            /** The event that caused it */
+            uint32_t event;
+            int core;
+            int task;
+        };
+
+        /** What happened during a hyperperiod (times relative to its start) */
+        struct _Record
+        {
+            std::vector<NativeEvent> events;
+            std::vector<_Input> inputs;
+            std::vector<_CoreChange> cores;
+
+            void clear() { events.clear(); inputs.clear(); cores.clear(); }
+        };
+
+        virtual void saveEngineState(BinaryWriter &);
+
+        virtual void loadEngineState(BinaryReader &);
+
+        /** Post an event */
+        void post(long long time, NativeEventKind kind, uint32_t task = 0, uint32_t gen = 0);
+
+        /** Discard stale events at the head of the queue */
+        void purge();
+
+        /** Whether the event refers to the current state of its task */
+        bool isValid(const NativeEvent &) const;
+
+        /** Ask for a scheduling decision in a cluster at the current time */
+        void requestDispatch(int);
+
+        /** Event handlers */
+        void onEndInstr(uint32_t);
+        void onEndTask(uint32_t);
+        void onArrival(uint32_t);
+        void onQuantum(uint32_t);
+        void dispatch();
+
+        /** Activate a new job of a task (arrived at the given time) */
+        void activate(uint32_t, long long);
+
+        /** Start (or resume) a job on a core */
+        void start(uint32_t, int);
+
+        /** Preempt a running job (back to the ready queue), returning its core */
+        int preempt(uint32_t);
+
+        /** Assign the tasks with no core to the clusters by bin-packing */
+        void pack(const double, const double * const *);
+
+        /** Build the ready queues of the clusters (after task assignment) */
+        void setupReadyQueues();
+
+        /** Set the task running on a core (-1 if idle) */
+        void setCore(int core, int task);
+
+        /** Process the event at the head of the queue (simulation) */
+        void simulateNextEvent();
+
+        /** Hyperperiod replay */
+        void onBoundary();
+        void replayNextEvent();
+        void fallBack();
+        void takeSnapshot(_Snapshot &, long long boundary);
+        void restoreSnapshot(const _Snapshot &, long long shift);
+        bool sameState(const _Snapshot &, const _Snapshot &) const;
+        void applyInput(const _Input &);
+
+        /** Called by the tasks on each input of the co-simulation */
+        void onTaskInput(uint32_t task, bool discard, int duration);
+
+        /** Ready queue key of a job of a task */
+        long long readyKey(const _TaskState &) const;
+
+        /** Ready queue operations (on the queue of the task's cluster) */
+        bool readyEmpty(const _Cluster &) const;
+        const _ReadyEntry& readyFirst(const _Cluster &) const;
+        void readyInsert(uint32_t, bool resumed);
+        void readyRemove(uint32_t);
+
+        /** Scheduling policy */
+        Policy _policy;
+
+        /** Whether running jobs can be preempted by ready ones */
+        bool _preemptive;
+
+        /** Whether priorities are static (bitmap ready queues) */
+        bool _bitmap;
+
+        /** Assignment of the tasks with no core to the clusters */
+        Packing _packing;
+
+        /** Round-robin quantum (ticks) */
+        long long _quantum;
+
+        /** Time resolution (ticks per model time unit) */
+        double _time_resolution;
+
+        /** The task-set (in port order) */
+        std::vector<_TaskState> _tasks;
+
+        /** The clusters of cores */
+        std::vector<_Cluster> _clusters;
+
+        /** Task running on each core (-1 if idle) */
+        std::vector<int> _cores;
+
+        /** The event queue */
+        EventQueueNative *_queue;
+
+        /** Current time (ticks) */
+        long long _now;
+
+        /** Posting and activation counters */
+        uint64_t _evt_seq;
+        uint64_t _act_seq;
+
+        /** Whether a scheduling decision is pending at the current time */
+        bool _dispatch_pending;
+
+        /** The clusters with a pending scheduling decision */
+        std::vector<int> _dirty;
+
+        /** Time of the next event (cached until the queue changes) */
+        int _next_time;
+        bool _next_time_valid;
+
+        /** Hyperperiod replay state */
+        ReplayMode _replay;
+        long long _hyperperiod;
+        long long _next_boundary;
+
+        /** The state at the start of the hyperperiod being recorded (or replayed) */
+        _Snapshot _snapshot;
+
+        /** The hyperperiod being recorded (or replayed) */
+        _Record _record;
+
+        /** Counters increment over the replayed hyperperiod, and
+         * counters at the start of the current one */
+        Stats _record_stats;
+        Stats _period_stats;
+
+        /** Replay position: start of the hyperperiod, and next event,
+         * input and core change */
+        long long _replay_base;
+        std::size_t _replay_event;
+        std::size_t _replay_input;
+        std::size_t _replay_core;
+
+        /** The event at the head of the queue, as seen by the co-simulation */
+        EventNative _next_event;
+
+        Stats _stats;
+
+    private:
+
+        /**
+         * \brief Prevent default construction
+         */
+        KernelNative();
+
+        /**
+         * \brief Construct from a (validated) configuration
+         */
+        KernelNative(const KernelConfig&);
+
+    };
+
+    /** @} */
+}
+
+#endif // TRES_KERNELNATIVE_HDR
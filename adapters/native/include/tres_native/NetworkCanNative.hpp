@@ -0,0 +1,368 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file NetworkCanNative.hpp
+ */
+
+#ifndef TRES_NETWORKCANNATIVE_HDR
+#define TRES_NETWORKCANNATIVE_HDR
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <tres/BinaryIO.hpp>
+#include <tres/CanFrame.hpp>
+#include <tres/Network.hpp>
+#include <tres/ParseUtils.hpp>
+#include "../../src/EventHeap.hpp"
+#include "../../src/CanEventNative.hpp"
+#include "../../src/SimMessageNative.hpp"
+
+namespace tres
+{
+    class RandomGen;
+
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Exception raised for malformed CAN network descriptions
+     */
+    DECL_EXC(NetworkCanNativeExc, "NetworkCanNative");
+
+    /**
+     * \brief Native (OMNeT++-free) implementation of tres::Network for a CAN bus
+     *
+     * A discrete-event model of a CAN bus at the frame level: messages are
+     * queued periodically in the transmit queue of their controller, the
+     * controllers contend for the bus when it becomes idle and the frame
+     * with the lowest identifier wins the arbitration, the bus is then busy
+     * for the duration of the frame (including the inter-frame space). A
+     * message block is triggered when a frame is queued (send) and when it
+     * is received (receive).
+     *
+     * The message-set description is the one of the OMNeT++ adapter, with
+     * further (optional) parameters of the messages:
+     *  - "type;uid;[period;[dlc;[node;[offset;[jitter;]]]]]"
+     *
+     * where uid is the identifier in hexadecimal (frames with identifiers
+     * above 0x7ff, or written with more than 3 digits, have extended 29-bit
+     * identifiers), dlc is the number of data bytes (8 by default), node is
+     * the controller (by default, each message has its own), and period,
+     * offset and jitter (the largest delay of the queuing after its
+     * period) are in the time unit of the model. The rows of an OMNeT++
+     * message-set ("type;uid;") have no period, the traffic being defined
+     * by the OMNeT++ model: their parameters are then given by a "message"
+     * item of the network description, and a message with no period at all
+     * is never queued.
+     *
+     * Items of the network description (the others, e.g. the files of
+     * OMNeT++, are ignored):
+     *  - "bitrate;<bit/s>;" (500000 by default)
+     *  - "stuffing;worst|exact|none;": the frames have the largest number of
+     *    stuff bits (default), the stuff bits of their actual bit stream (the
+     *    data is not known to the network: frames carry pseudo-random data)
+     *    or none at all
+     *  - "txqueue;priority|fifo;": a controller offers the frame with the
+     *    lowest identifier in its queue (default), or the oldest one
+     *  - "errors;none|random:<p>|sporadic:<interval>;": no errors (default),
+     *    or each transmission is hit by an error with probability p, or an
+     *    error hits the bus every interval (time unit of the model). An
+     *    error is signalled at the end of the frame: the error frame (31
+     *    bits) follows, and the frame is arbitrated again
+     *  - "seed;<n>;": seed of the pseudo-random jitter, data and errors
+     *  - "message;uid;period;[dlc;[node;[offset;[jitter;]]]]": the
+     *    parameters of a message whose row has none
+     */
+    class NetworkCanNative : public tres::Network
+    {
+
+    public:
+
+        /** Counters of a message */
+        struct MessageStats
+        {
+            /** Frames queued */
+            uint64_t queued;
+
+            /** Frames received */
+            uint64_t delivered;
+
+            /** Transmissions hit by an error */
+            uint64_t errors;
+
+            /** Largest and total response time (ticks, from the start of
+             * the period of the frame to its reception) */
+            long long max_response;
+            long long total_response;
+        };
+
+        /** Engine counters */
+        struct Stats
+        {
+            /** Processed events */
+            uint64_t events;
+
+            /** Transmissions (including the ones hit by an error) */
+            uint64_t transmissions;
+
+            /** Errors */
+            uint64_t errors;
+
+            /** Time the bus has been busy (ticks) */
+            long long busy;
+        };
+
+        /** Length of an error frame, with the inter-frame space (bits) */
+        static const int ERROR_FRAME_BITS = 31;
+
+        /**
+         * \brief Creator function used for object construction
+         * according to the Factory Method pattern
+         */
+        static Network* createInstance(std::vector<std::string>&);
+
+        /**
+         * \brief Construct from the message-set and the network descriptions
+         */
+        NetworkCanNative(const std::vector<std::string>&, const std::vector<std::string>&, double time_resolution);
+
+        virtual ~NetworkCanNative();
+
+        virtual void processNextEvent();
+
+        virtual NetworkEvent* getNextEvent();
+
+        virtual int getTimeOfNextEvent();
+
+        virtual int getNextWakeUpTime();
+
+        /**
+         * \brief Return the current time (ticks)
+         */
+        long long getTime() const { return _now; }
+
+        /**
+         * \brief Return the engine counters
+         */
+        const Stats& getStats() const { return _stats; }
+
+        /**
+         * \brief Number of messages, and their counters
+         */
+        std::size_t getNumberOfMessages() const { return _msgs.size(); }
+        const MessageStats& getMessageStats(std::size_t msg) const { return _msgs[msg].stats; }
+
+        /**
+         * \brief Duration of a frame of a message, with the largest number
+         * of stuff bits (ticks)
+         */
+        long long getFrameDuration(std::size_t msg) const;
+
+        /**
+         * \brief Number of bits of a frame, with the largest number of stuff
+         * bits
+         */
+        static int getFrameBits(bool extended, int dlc);
+
+        /**
+         * \brief Number of bits of a frame with the given content
+         */
+        static int getFrameBits(uint32_t id, bool extended, const uint8_t *data, int dlc);
+
+        /**
+         * \brief Save the state of the network
+         *
+         * The snapshot holds the pending events, the transmit queues, the
+         * pseudo-random generator and the counters; it can be restored by
+         * loadState() into a network built from the same descriptions.
+         */
+        void saveState(BinaryWriter &w) const;
+
+        /**
+         * \brief Restore a state saved by saveState()
+         *
+         * \throw BinaryIOExc if the snapshot is malformed or does not match
+         * the descriptions of the network
+         */
+        void loadState(BinaryReader &r);
+
+    protected:
+
+        /** Error modes */
+        enum Errors { ERR_NONE, ERR_RANDOM, ERR_SPORADIC };
+
+        /** A frame waiting for the bus */
+        struct _Frame
+        {
+            /** Arbitration key (see canArbitrationKey()) */
+            uint64_t key;
+
+            /** Queuing order */
+            uint64_t seq;
+
+            /** Time of queuing (ticks) */
+            long long queued;
+
+            /** Start of the period of the frame, i.e., its queuing without
+             * jitter (ticks) */
+            long long release;
+
+            /** The message */
+            uint32_t msg;
+        };
+
+        /** Order of the frames in a transmit queue, or among the
+         * controllers (by arbitration key or by queuing order) */
+        struct _FrameOrder
+        {
+            explicit _FrameOrder(bool by_key = true) : by_key(by_key) {}
+
+            bool operator()(const _Frame &a, const _Frame &b) const
+            {
+                if (by_key && a.key != b.key)
+                    return a.key < b.key;
+                return a.seq < b.seq;
+            }
+
+            bool by_key;
+        };
+
+        /** A message of the message-set */
+        struct _Message
+        {
+            SimMessageNative sim;
+
+            uint32_t id;
+            bool extended;
+            int dlc;
+            uint64_t key;
+
+            /** Index of the controller */
+            uint32_t node;
+
+            /** Timing (ticks; no period if the message is never queued) */
+            long long period;
+            long long offset;
+            long long jitter;
+
+            /** Start of the current period (ticks) */
+            long long next_period;
+
+            /** Duration of a frame with the largest number of stuff bits */
+            long long duration;
+
+            MessageStats stats;
+        };
+
+        /** A CAN controller */
+        struct _Node
+        {
+            /** The transmit queue */
+            std::set<_Frame, _FrameOrder> queue;
+        };
+
+        /** Duration (ticks) of a number of bits */
+        long long bitsToTicks(long long bits) const;
+
+        /** Post an event */
+        void post(long long time, unsigned int kind, uint32_t msg);
+
+        /** Queue a frame into the transmit queue of its controller */
+        void enqueue(const _Frame &);
+
+        /** Start the transmission of the frame winning the arbitration */
+        void arbitrate();
+
+        /** Duration (ticks) of the next transmission of a frame */
+        long long transmissionTime(const _Message &);
+
+        /** Pseudo-random number in [0, 1) */
+        double uniform();
+
+        /** Time resolution (ticks per time unit of the model) */
+        double _time_resolution;
+
+        /** Bit rate (bit/s) */
+        double _bitrate;
+
+        CanStuffing _stuffing;
+        bool _fifo;
+
+        Errors _errors;
+        double _error_prob;
+        long long _error_interval;
+
+        /** Time of the next sporadic error (ticks) */
+        long long _next_error;
+
+        std::vector<_Message> _msgs;
+        std::vector<_Node> _nodes;
+
+        /** The frames offered by the controllers (the head of their
+         * transmit queues), by arbitration key */
+        std::set<_Frame, _FrameOrder> _offered;
+
+        /** The frame on the bus (if _busy) */
+        _Frame _tx;
+        bool _busy;
+
+        /** Whether an arbitration is pending */
+        bool _arbitration;
+
+        /** The pending events */
+        EventHeap _queue;
+
+        /** The event at the head of the queue, as seen by the co-simulation */
+        CanEventNative _event;
+
+        long long _now;
+        uint64_t _evt_seq;
+        uint64_t _frame_seq;
+
+        /** Generator of the jitter, data and errors */
+        std::unique_ptr<RandomGen> _rng;
+
+        Stats _stats;
+
+    };
+
+    /** @} */
+}
+
+#endif // TRES_NETWORKCANNATIVE_HDR
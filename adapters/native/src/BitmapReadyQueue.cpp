@@ -0,0 +1,137 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file BitmapReadyQueue.cpp
+ */
+
+#include "BitmapReadyQueue.hpp"
+
+namespace tres
+{
+    const uint32_t BitmapReadyQueue::NIL;
+
+    BitmapReadyQueue::BitmapReadyQueue() :
+        _bits(1, std::vector<uint64_t>(1, 0))
+    {
+    }
+
+    BitmapReadyQueue::BitmapReadyQueue(std::size_t levels, std::size_t tasks) :
+        _head(levels, NIL), _tail(levels, NIL), _next(tasks, NIL), _prev(tasks, NIL), _level(tasks, 0)
+    {
+        std::size_t n = (levels > 0) ? levels : 1;
+        do
+        {
+            n = (n + 63) / 64;
+            _bits.push_back(std::vector<uint64_t>(n, 0));
+        }
+        while (n > 1);
+    }
+
+    std::size_t BitmapReadyQueue::firstLevel() const
+    {
+        std::size_t idx = 0;
+        for (std::size_t l = _bits.size(); l-- > 0; )
+            idx = idx * 64 + __builtin_ctzll(_bits[l][idx]);
+        return idx;
+    }
+
+    void BitmapReadyQueue::mark(std::size_t level)
+    {
+        for (std::size_t l = 0; l < _bits.size(); ++l, level /= 64)
+        {
+            uint64_t &w = _bits[l][level / 64];
+            bool was_empty = (w == 0);
+            w |= uint64_t(1) << (level % 64);
+            if (!was_empty)
+                break;
+        }
+    }
+
+    void BitmapReadyQueue::unmark(std::size_t level)
+    {
+        for (std::size_t l = 0; l < _bits.size(); ++l, level /= 64)
+        {
+            uint64_t &w = _bits[l][level / 64];
+            w &= ~(uint64_t(1) << (level % 64));
+            if (w != 0)
+                break;
+        }
+    }
+
+    void BitmapReadyQueue::pushBack(uint32_t task, std::size_t level)
+    {
+        _level[task] = level;
+        _next[task] = NIL;
+        _prev[task] = _tail[level];
+        if (_tail[level] == NIL)
+        {
+            _head[level] = task;
+            mark(level);
+        }
+        else
+            _next[_tail[level]] = task;
+        _tail[level] = task;
+    }
+
+    void BitmapReadyQueue::pushFront(uint32_t task, std::size_t level)
+    {
+        _level[task] = level;
+        _prev[task] = NIL;
+        _next[task] = _head[level];
+        if (_head[level] == NIL)
+        {
+            _tail[level] = task;
+            mark(level);
+        }
+        else
+            _prev[_head[level]] = task;
+        _head[level] = task;
+    }
+
+    void BitmapReadyQueue::remove(uint32_t task)
+    {
+        std::size_t level = _level[task];
+        if (_prev[task] == NIL)
+            _head[level] = _next[task];
+        else
+            _next[_prev[task]] = _next[task];
+        if (_next[task] == NIL)
+            _tail[level] = _prev[task];
+        else
+            _prev[_next[task]] = _prev[task];
+        if (_head[level] == NIL)
+            unmark(level);
+    }
+}
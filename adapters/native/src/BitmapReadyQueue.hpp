@@ -0,0 +1,121 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file BitmapReadyQueue.hpp
+ */
+
+#ifndef TRES_BITMAPREADYQUEUE_HDR
+#define TRES_BITMAPREADYQUEUE_HDR
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Fixed-priority ready queue with constant-time operations
+     *
+     * A FIFO list of tasks per priority level (0 is the highest), plus a
+     * hierarchy of bitmaps of the non-empty levels (one bit per level,
+     * then one bit per non-zero word, and so on up to a single word):
+     * the highest non-empty level is found with one find-first-set per
+     * bitmap level, as in real-time operating systems. Tasks are
+     * identified by index, and are in the queue at most once.
+     */
+    class BitmapReadyQueue
+    {
+
+    public:
+
+        /**
+         * \brief Build an empty queue with no levels
+         */
+        BitmapReadyQueue();
+
+        /**
+         * \brief Build an empty queue
+         *
+         * \param levels number of priority levels
+         * \param tasks number of tasks (task indexes are less than that)
+         */
+        BitmapReadyQueue(std::size_t levels, std::size_t tasks);
+
+        bool empty() const { return _bits.back()[0] == 0; }
+
+        /** The first task of the highest non-empty level (the queue must not be empty) */
+        uint32_t first() const { return _head[firstLevel()]; }
+
+        /** Append a task to the list of its level */
+        void pushBack(uint32_t task, std::size_t level);
+
+        /** Prepend a task to the list of its level */
+        void pushFront(uint32_t task, std::size_t level);
+
+        /** Remove a task (which must be in the queue) */
+        void remove(uint32_t task);
+
+    private:
+
+        static const uint32_t NIL = 0xffffffffu;
+
+        /** The highest non-empty level */
+        std::size_t firstLevel() const;
+
+        /** Set or clear the bit of a level (propagating up the hierarchy) */
+        void mark(std::size_t level);
+        void unmark(std::size_t level);
+
+        /** Bitmaps, from the one of the levels (front) to a single word (back) */
+        std::vector<std::vector<uint64_t> > _bits;
+
+        /** First and last task of each level */
+        std::vector<uint32_t> _head;
+        std::vector<uint32_t> _tail;
+
+        /** Links and level of each task */
+        std::vector<uint32_t> _next;
+        std::vector<uint32_t> _prev;
+        std::vector<uint32_t> _level;
+    };
+
+    /** @} */
+}
+
+#endif // TRES_BITMAPREADYQUEUE_HDR
@@ -0,0 +1,185 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CalendarQueue.cpp
+ */
+
+#include <algorithm>
+#include "CalendarQueue.hpp"
+
+namespace tres
+{
+    namespace
+    {
+        /** Order of the events in the buckets (latest first) */
+        struct _Later
+        {
+            bool operator()(const NativeEvent &a, const NativeEvent &b) const { return b < a; }
+        };
+    }
+
+    const std::size_t CalendarQueue::MIN_BUCKETS;
+    const std::size_t CalendarQueue::WIDTH_SAMPLES;
+
+    CalendarQueue::CalendarQueue() :
+        _buckets(MIN_BUCKETS), _mask(MIN_BUCKETS - 1), _width(1), _cur_day(0), _top(-1), _size(0)
+    {
+    }
+
+    void CalendarQueue::insert(const NativeEvent &e)
+    {
+        std::vector<NativeEvent> &b = _buckets[static_cast<std::size_t>(day(e.time)) & _mask];
+        b.insert(std::lower_bound(b.begin(), b.end(), e, _Later()), e);
+    }
+
+    void CalendarQueue::push(const NativeEvent &e)
+    {
+        if (_size == 0 || day(e.time) < _cur_day)
+            _cur_day = day(e.time);
+        insert(e);
+        ++_size;
+
+        // The cached earliest event may have changed
+        if (_top >= 0 && e < _buckets[_top].back())
+            _top = static_cast<long>(static_cast<std::size_t>(day(e.time)) & _mask);
+
+        if (_size > 2 * _buckets.size())
+            resize(2 * _buckets.size());
+    }
+
+    const NativeEvent& CalendarQueue::top()
+    {
+        if (_top < 0)
+            locate();
+        return _buckets[_top].back();
+    }
+
+    void CalendarQueue::pop()
+    {
+        if (_top < 0)
+            locate();
+        _buckets[_top].pop_back();
+        --_size;
+        _top = -1;
+
+        if (_buckets.size() > MIN_BUCKETS && _size < _buckets.size() / 2)
+            resize(_buckets.size() / 2);
+    }
+
+    void CalendarQueue::clear()
+    {
+        _buckets.assign(MIN_BUCKETS, std::vector<NativeEvent>());
+        _mask = MIN_BUCKETS - 1;
+        _width = 1;
+        _cur_day = 0;
+        _top = -1;
+        _size = 0;
+    }
+
+    void CalendarQueue::dump(std::vector<NativeEvent> &v) const
+    {
+        for (std::vector<std::vector<NativeEvent> >::const_iterator b = _buckets.begin(); b != _buckets.end(); ++b)
+            v.insert(v.end(), b->begin(), b->end());
+    }
+
+    void CalendarQueue::locate()
+    {
+        // Scan one year from the current day: the first bucket whose
+        // earliest event falls in the day being scanned holds the
+        // earliest event overall
+        for (std::size_t i = 0; i <= _mask; ++i, ++_cur_day)
+        {
+            std::size_t b = static_cast<std::size_t>(_cur_day) & _mask;
+            if (!_buckets[b].empty() && day(_buckets[b].back().time) == _cur_day)
+            {
+                _top = static_cast<long>(b);
+                return;
+            }
+        }
+
+        // Sparse calendar: direct search among the buckets
+        long best = -1;
+        for (std::size_t b = 0; b <= _mask; ++b)
+            if (!_buckets[b].empty() && (best < 0 || _buckets[b].back() < _buckets[best].back()))
+                best = static_cast<long>(b);
+        _top = best;
+        _cur_day = day(_buckets[best].back().time);
+    }
+
+    void CalendarQueue::resize(std::size_t nbuckets)
+    {
+        std::vector<NativeEvent> all;
+        all.reserve(_size);
+        for (std::vector<std::vector<NativeEvent> >::const_iterator b = _buckets.begin(); b != _buckets.end(); ++b)
+            all.insert(all.end(), b->begin(), b->end());
+
+        // Estimate the width from the separation of the earliest events,
+        // ignoring simultaneous ones and outliers (Brown's heuristic)
+        std::size_t n = std::min(all.size(), WIDTH_SAMPLES);
+        std::partial_sort(all.begin(), all.begin() + n, all.end());
+        long long sum = 0, cnt = 0;
+        for (std::size_t i = 1; i < n; ++i)
+        {
+            long long d = all[i].time - all[i - 1].time;
+            if (d > 0)
+            {
+                sum += d;
+                ++cnt;
+            }
+        }
+        if (cnt > 0)
+        {
+            long long avg = sum / cnt, fsum = 0, fcnt = 0;
+            for (std::size_t i = 1; i < n; ++i)
+            {
+                long long d = all[i].time - all[i - 1].time;
+                if (d > 0 && d <= 2 * avg)
+                {
+                    fsum += d;
+                    ++fcnt;
+                }
+            }
+            _width = std::max(1LL, fcnt > 0 ? 3 * fsum / fcnt : 3 * avg);
+        }
+
+        _buckets.assign(nbuckets, std::vector<NativeEvent>());
+        _mask = nbuckets - 1;
+        _top = -1;
+        for (std::vector<NativeEvent>::const_iterator e = all.begin(); e != all.end(); ++e)
+            insert(*e);
+        if (!all.empty())
+            _cur_day = day(all.front().time);
+    }
+}
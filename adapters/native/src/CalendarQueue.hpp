@@ -0,0 +1,124 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CalendarQueue.hpp
+ */
+
+#ifndef TRES_CALENDARQUEUE_HDR
+#define TRES_CALENDARQUEUE_HDR
+#include <vector>
+#include "EventQueueNative.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Calendar queue of NativeEvent (R. Brown, CACM 31(10), 1988)
+     *
+     * Events are hashed by time into an array of buckets ("days") of
+     * fixed width, each one sorted; the earliest event is found by
+     * scanning the buckets from the current day. The number of buckets
+     * follows the number of events, and the width is re-estimated
+     * from the event separations on each resize, so that push and pop
+     * take O(1) time on average for hold-model workloads (every pop
+     * followed by a push in the near future), such as periodic task-sets.
+     */
+    class CalendarQueue : public EventQueueNative
+    {
+
+    public:
+
+        CalendarQueue();
+
+        virtual bool empty() const { return _size == 0; }
+
+        virtual std::size_t size() const { return _size; }
+
+        virtual const NativeEvent& top();
+
+        virtual void push(const NativeEvent &e);
+
+        virtual void pop();
+
+        virtual void clear();
+
+        virtual void dump(std::vector<NativeEvent> &v) const;
+
+    private:
+
+        /** Minimum number of buckets */
+        static const std::size_t MIN_BUCKETS = 16;
+
+        /** Number of events sampled to estimate the bucket width */
+        static const std::size_t WIDTH_SAMPLES = 32;
+
+        /** Find the earliest event (and move the current day there) */
+        void locate();
+
+        /** Rebuild the calendar with the given number of buckets */
+        void resize(std::size_t nbuckets);
+
+        /** Insert an event in its (sorted) bucket */
+        void insert(const NativeEvent &e);
+
+        /** Day of a time (bucket = day modulo the number of buckets) */
+        long long day(long long time) const { return time / _width; }
+
+        /** The buckets, each sorted latest first (earliest at back) */
+        std::vector<std::vector<NativeEvent> > _buckets;
+
+        /** Number of buckets minus one (a power of two minus one) */
+        std::size_t _mask;
+
+        /** Width of a day (ticks) */
+        long long _width;
+
+        /** The current day (no event is earlier) */
+        long long _cur_day;
+
+        /** Bucket holding the earliest event (-1 if unknown) */
+        long _top;
+
+        std::size_t _size;
+    };
+
+    /** @} */
+}
+
+#endif // TRES_CALENDARQUEUE_HDR
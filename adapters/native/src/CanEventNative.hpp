@@ -0,0 +1,112 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CanEventNative.hpp
+ */
+
+#ifndef TRES_CANEVENTNATIVE_HDR
+#define TRES_CANEVENTNATIVE_HDR
+#include <string>
+#include <tres/NetworkEvent.hpp>
+#include "SimMessageNative.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Kinds of events of the native CAN engine
+     *
+     * The order is the rank among simultaneous events: the bus is released
+     * (end of a frame or of an error frame) before the frames queued at the
+     * same time enter the arbitration, which comes last
+     */
+    enum CanEventKind
+    {
+        CEVT_DELIVER = 0,
+        CEVT_ERROR,
+        CEVT_QUEUE,
+        CEVT_ARBITRATE,
+        CEVT_NONE
+    };
+
+    /**
+     * \brief Events of the native CAN engine, as seen by the co-simulation
+     *
+     * The instance describes the event at the head of the queue of a
+     * tres::NetworkCanNative. Only the events of application-level traffic
+     * are reported to the message blocks: a frame queued for transmission
+     * (send) and a frame received (receive)
+     */
+    class CanEventNative : public tres::NetworkEvent
+    {
+
+        friend class NetworkCanNative;
+
+    public:
+
+        /**
+         * \brief Default constructor
+         */
+        CanEventNative();
+
+        virtual std::string getName() const;
+
+        virtual long int getTime() const;
+
+        virtual bool isGeneratedByAppLevelTraffic();
+
+        virtual SimMessage* getGeneratorMessage();
+
+    protected:
+
+        /** Time of occurrence (ticks) */
+        long long _time;
+
+        /** Kind of event (see CanEventKind) */
+        unsigned int _kind;
+
+        /** The message which has generated this event (if any) */
+        SimMessageNative *_msg;
+
+    };
+
+    /** @} */
+}
+
+#endif // TRES_CANEVENTNATIVE_HDR
@@ -0,0 +1,97 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file EventHeap.hpp
+ */
+
+#ifndef TRES_EVENTHEAP_HDR
+#define TRES_EVENTHEAP_HDR
+#include <algorithm>
+#include <vector>
+#include "EventQueueNative.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Binary min-heap of NativeEvent
+     *
+     * O(log n) per operation; the default backend
+     */
+    class EventHeap : public EventQueueNative
+    {
+
+    public:
+
+        virtual bool empty() const { return _heap.empty(); }
+
+        virtual std::size_t size() const { return _heap.size(); }
+
+        virtual const NativeEvent& top() { return _heap.front(); }
+
+        virtual void push(const NativeEvent &e)
+        {
+            _heap.push_back(e);
+            std::push_heap(_heap.begin(), _heap.end(), _Later());
+        }
+
+        virtual void pop()
+        {
+            std::pop_heap(_heap.begin(), _heap.end(), _Later());
+            _heap.pop_back();
+        }
+
+        virtual void clear() { _heap.clear(); }
+
+        virtual void dump(std::vector<NativeEvent> &v) const { v.insert(v.end(), _heap.begin(), _heap.end()); }
+
+    private:
+
+        struct _Later
+        {
+            bool operator()(const NativeEvent &a, const NativeEvent &b) const { return b < a; }
+        };
+
+        std::vector<NativeEvent> _heap;
+    };
+
+    /** @} */
+}
+
+#endif // TRES_EVENTHEAP_HDR
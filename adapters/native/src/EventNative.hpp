@@ -0,0 +1,95 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file EventNative.hpp
+ */
+
+#ifndef TRES_EVENTNATIVE_HDR
+#define TRES_EVENTNATIVE_HDR
+#include <string>
+#include <tres/RTOSEvent.hpp>
+#include "SimTaskNative.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Events of the native scheduling engine, as seen by the co-simulation
+     *
+     * The instance describes the event at the head of the queue of a
+     * tres::KernelNative (the event is processed by
+     * KernelNative::processNextEvent())
+     */
+    class EventNative : public tres::RTOSEvent
+    {
+
+        friend class KernelNative;
+
+    public:
+
+        /**
+         * \brief Default constructor
+         */
+        EventNative();
+
+        virtual std::string getName() const;
+
+        virtual long int getTime() const;
+
+        virtual tres::RTOSEventType getType() const;
+
+        virtual SimTask* getGeneratorTask();
+
+    protected:
+
+        /** Time of occurrence (ticks) */
+        long long _time;
+
+        /** Kind of event (see KernelNative) */
+        unsigned int _kind;
+
+        /** The task which has generated this event (if any) */
+        SimTaskNative *_task;
+
+    };
+
+    /** @} */
+}
+
+#endif // TRES_EVENTNATIVE_HDR
@@ -0,0 +1,137 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file EventQueueNative.hpp
+ */
+
+#ifndef TRES_EVENTQUEUENATIVE_HDR
+#define TRES_EVENTQUEUENATIVE_HDR
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Kinds of events of the native scheduling engine
+     *
+     * The order is the rank among simultaneous events: instruction and job
+     * completions come first, then activations, then scheduling decisions
+     * (one per tick, once the state at that tick is known)
+     */
+    enum NativeEventKind
+    {
+        NEVT_END_INSTR = 0,
+        NEVT_END_TASK,
+        NEVT_ARRIVAL,
+        NEVT_QUANTUM,
+        NEVT_DISPATCH,
+        NEVT_NONE
+    };
+
+    /**
+     * \brief An event of the native scheduling engine
+     *
+     * Events at the same time are ordered by kind (see KernelNative) and
+     * then by posting order. Events are never removed from the queue: they
+     * carry the generation of the task state they refer to, and are
+     * ignored when it no longer matches.
+     */
+    struct NativeEvent
+    {
+        /** Time of occurrence (ticks) */
+        long long time;
+
+        /** Kind of event (also the rank among simultaneous events) */
+        uint32_t kind;
+
+        /** Index of the task (if any) */
+        uint32_t task;
+
+        /** Generation of the task state the event refers to */
+        uint32_t gen;
+
+        /** Posting order */
+        uint64_t seq;
+
+        bool operator<(const NativeEvent &o) const
+        {
+            if (time != o.time) return time < o.time;
+            if (kind != o.kind) return kind < o.kind;
+            return seq < o.seq;
+        }
+    };
+
+    /**
+     * \brief Priority queue of NativeEvent (earliest first)
+     *
+     * Abstract interface of the event-queue backends of the native
+     * engine, selected per kernel (see KernelNative)
+     */
+    class EventQueueNative
+    {
+
+    public:
+
+        virtual ~EventQueueNative() {}
+
+        virtual bool empty() const = 0;
+
+        virtual std::size_t size() const = 0;
+
+        /** The earliest event (the queue must not be empty) */
+        virtual const NativeEvent& top() = 0;
+
+        virtual void push(const NativeEvent &e) = 0;
+
+        /** Remove the earliest event (the queue must not be empty) */
+        virtual void pop() = 0;
+
+        virtual void clear() = 0;
+
+        /** Append all the events (in no particular order) to a vector */
+        virtual void dump(std::vector<NativeEvent> &v) const = 0;
+
+    };
+
+    /** @} */
+}
+
+#endif // TRES_EVENTQUEUENATIVE_HDR
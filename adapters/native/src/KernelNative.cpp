@@ -0,0 +1,1195 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file KernelNative.cpp
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <tres_native/KernelNative.hpp>
+#include "CalendarQueue.hpp"
+#include "EventHeap.hpp"
+
+namespace tres
+{
+    /** Convert a time (in the model time unit) to ticks */
+    static long long toTicks(double t, double time_resolution)
+    {
+        return std::llround(t * time_resolution);
+    }
+
+    /** Order of the tasks by decreasing utilization */
+    struct _ByUtil
+    {
+        explicit _ByUtil(const std::vector<double> &u) : util(u) {}
+
+        bool operator()(uint32_t a, uint32_t b) const { return util[a] > util[b]; }
+
+        const std::vector<double> &util;
+    };
+
+    /** Scheduling position of an active job in a snapshot */
+    struct _JobPos
+    {
+        int cluster;
+        bool running;
+        long long key;
+        uint64_t seq;
+        uint32_t task;
+
+        bool operator<(const _JobPos &o) const
+        {
+            if (cluster != o.cluster) return cluster < o.cluster;
+            if (running != o.running) return running < o.running;
+            if (key != o.key) return key < o.key;
+            return seq < o.seq;
+        }
+    };
+
+    KernelNative::KernelNative(const KernelConfig& conf) :
+        _preemptive(true), _bitmap(false), _packing(PACK_NONE), _quantum(0), _time_resolution(conf.time_resolution),
+        _queue(NULL), _now(0), _evt_seq(0), _act_seq(0), _dispatch_pending(false),
+        _next_time(0), _next_time_valid(false), _replay(REPLAY_OFF), _hyperperiod(0), _next_boundary(0), _replay_base(0),
+        _replay_event(0), _replay_input(0), _replay_core(0)
+    {
+        _kernel_name = conf.name;
+
+        // Random variables built from now on draw from
+        // the generator of the configuration (if any)
+        conf.selectGenerator();
+
+        // The scheduling policy
+        const std::string& policy = conf.scheduler.policy;
+        if (policy == "FIXED_PRIORITY")
+            _policy = FP;
+        else if (policy == "DEADLINE_MONOTONIC")
+            _policy = DM;
+        else if (policy == "RATE_MONOTONIC")
+            _policy = RM;
+        else if (policy == "EDF")
+            _policy = EDF;
+        else if (policy == "RR")
+            _policy = RR;
+        else if (policy == "FIFO")
+            _policy = FIFO;
+        else
+            throw KernelConfigExc("Scheduling policy not supported by the native kernel: " + policy);
+        _preemptive = (_policy != RR && _policy != FIFO);
+
+        // Its parameters: the multicore mode, the event-queue backend,
+        // hyperperiod replay and the quantum (RR)
+        int cluster_size = conf.num_cores;
+        bool calendar = false;
+        bool replay = false;
+        for (std::vector<std::string>::const_iterator p = conf.scheduler.params.begin();
+                p != conf.scheduler.params.end();
+                    ++p)
+        {
+            if (*p == "partitioned")
+                cluster_size = 1;
+            else if (*p == "global")
+                cluster_size = conf.num_cores;
+            else if (p->compare(0, 10, "clustered:") == 0)
+            {
+                char *end;
+                cluster_size = static_cast<int>(std::strtol(p->c_str() + 10, &end, 10));
+                if (*end != '\0' || cluster_size < 1 || cluster_size > conf.num_cores)
+                    throw KernelConfigExc("Invalid cluster size: " + *p);
+            }
+            else if (*p == "ffd")
+                _packing = PACK_FFD;
+            else if (*p == "wfd")
+                _packing = PACK_WFD;
+            else if (*p == "calendar")
+                calendar = true;
+            else if (*p == "heap")
+                calendar = false;
+            else if (*p == "replay")
+                replay = true;
+            else
+            {
+                char *end;
+                double q = std::strtod(p->c_str(), &end);
+                if (*end != '\0' || p->empty())
+                    throw KernelConfigExc("Unknown scheduling parameter: " + *p);
+                _quantum = std::llround(q);
+            }
+        }
+        if (_policy == RR && _quantum <= 0)
+            throw KernelConfigExc("Round-robin scheduling needs a positive quantum");
+
+        if (calendar)
+            _queue = new CalendarQueue();
+        else
+            _queue = new EventHeap();
+
+        // The platform: clusters of consecutive cores (the last one
+        // may be smaller), all of them idle
+        _cores.assign(conf.num_cores, -1);
+        _clusters.resize((conf.num_cores + cluster_size - 1) / cluster_size);
+        for (int c = 0; c < conf.num_cores; ++c)
+        {
+            _clusters[c / cluster_size].cores.push_back(c);
+            _clusters[c / cluster_size].idle.push(c);
+        }
+
+        // The task-set
+        int aper_req_idx = 0;
+        _tasks.resize(conf.tasks.size());
+        for (std::vector<TaskConfig>::size_type i = 0; i < conf.tasks.size(); ++i)
+        {
+            const TaskConfig& tc = conf.tasks[i];
+            _TaskState& t = _tasks[i];
+
+            t.sim._name = tc.name;
+            t.sim._kernel = this;
+            t.sim._index = i;
+            t.iat = toTicks(tc.iat, _time_resolution);
+            t.rdl = toTicks(tc.rdl, _time_resolution);
+            t.ph = toTicks(tc.ph, _time_resolution);
+
+            // Aperiodic tasks are activated upon request (see
+            // activateAperiodicTasks()); as in RTSim, a non-null
+            // IAT also re-arms their activations
+            t.periodic = (t.iat > 0);
+
+            // Further parameters: the priority (default: the order of
+            // the task-set) and the CPU core
+            double prio, core;
+            t.prio = tc.getNumericParam(0, prio) ? static_cast<long long>(prio) : static_cast<long long>(i);
+            if (!tc.getNumericParam(1, core))
+                core = -1;
+            else if (core < 0 || core >= conf.num_cores)
+                throw KernelConfigExc("Invalid CPU core for task " + tc.name);
+
+            // Tasks with no core are assigned round-robin (or packed, see
+            // initializeSimulation())
+            t.pinned = (core >= 0);
+            if (t.pinned)
+                t.cluster = static_cast<int>(core) / cluster_size;
+            else
+                t.cluster = static_cast<int>(i % _clusters.size());
+
+            t.active = false;
+            t.core = -1;
+            t.last_core = -1;
+            t.remaining = 0;
+            t.run_start = 0;
+            t.deadline = 0;
+            t.instr_gen = 0;
+            t.slice_gen = 0;
+
+            // Register the task/port correspondency
+            _task_port_map[tc.name] = i;
+
+            // Register the correspondency between aperiodic-activation
+            // request index and task (if any)
+            if (tc.isAperiodic())
+                _aper_req_task_map[aper_req_idx++] = i;
+
+            // Initialize the flags of Job's status (default 0)
+            _jobs_status[tc.name] = 0;
+        }
+
+        _bitmap = (_policy == FP || _policy == DM || _policy == RM);
+        setupReadyQueues();
+
+        _stats.events = 0;
+        _stats.jobs = 0;
+        _stats.preemptions = 0;
+        _stats.migrations = 0;
+        _stats.deadline_misses = 0;
+        _stats.lost_activations = 0;
+        _stats.replayed_periods = 0;
+
+        // Hyperperiod replay: boundaries every hyperperiod from the
+        // largest phase (only for periodic task-sets with a hyperperiod
+        // small enough to be recorded)
+        if (replay && _aper_req_task_map.empty() && !_tasks.empty())
+        {
+            long long h = 1, ph = 0;
+            for (std::vector<_TaskState>::const_iterator t = _tasks.begin(); t != _tasks.end() && h > 0; ++t)
+            {
+                // A task with no period has no hyperperiod
+                if (t->iat <= 0)
+                {
+                    h = 0;
+                    break;
+                }
+                long long a = h, b = t->iat;
+                while (b != 0)
+                {
+                    long long r = a % b;
+                    a = b;
+                    b = r;
+                }
+                h = (h / a > LLONG_MAX / t->iat) ? 0 : h / a * t->iat;
+                ph = std::max(ph, t->ph);
+            }
+            if (h > 0 && h <= INT_MAX)
+            {
+                _replay = REPLAY_DETECT;
+                _hyperperiod = h;
+                _next_boundary = ph;
+            }
+        }
+    }
+
+    KernelNative::~KernelNative() noexcept(true)
+    {
+        delete _queue;
+    }
+
+    tres::Kernel* KernelNative::createInstance(std::vector<std::string>& par)
+    {
+        return new KernelNative(KernelConfig::fromStrings(par));
+    }
+
+    tres::Kernel* KernelNative::createInstance(const KernelConfig& conf)
+    {
+        conf.validate();
+        return new KernelNative(conf);
+    }
+
+    void KernelNative::setupReadyQueues()
+    {
+        for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+            c->members.clear();
+        if (!_bitmap)
+            return;
+
+        // Static priorities: bitmap ready queues, with one level per
+        // distinct key and tasks numbered within their cluster
+        std::vector<long long> keys;
+        for (std::vector<_TaskState>::const_iterator t = _tasks.begin(); t != _tasks.end(); ++t)
+            keys.push_back(readyKey(*t));
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        for (std::vector<_TaskState>::size_type i = 0; i < _tasks.size(); ++i)
+        {
+            _TaskState &t = _tasks[i];
+            t.level = std::lower_bound(keys.begin(), keys.end(), readyKey(t)) - keys.begin();
+            t.local = _clusters[t.cluster].members.size();
+            _clusters[t.cluster].members.push_back(i);
+        }
+        for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+            c->bitmap = BitmapReadyQueue(keys.size(), c->members.size());
+    }
+
+    void KernelNative::pack(const double time_resolution, const double * const *c_time)
+    {
+        // Utilization of the tasks, from their first instruction
+        std::vector<double> util(_tasks.size(), 0.0);
+        std::vector<uint32_t> order;
+        std::vector<double> load(_clusters.size(), 0.0);
+        for (std::vector<_TaskState>::size_type i = 0; i < _tasks.size(); ++i)
+        {
+            const _TaskState &t = _tasks[i];
+            long long period = (t.iat > 0) ? t.iat : t.rdl;
+            if (period > 0)
+                util[i] = toTicks(*c_time[i], time_resolution) / static_cast<double>(period);
+            if (t.pinned)
+                load[t.cluster] += util[i];
+            else
+                order.push_back(i);
+        }
+
+        // Decreasing utilization (ties by declaration)
+        std::stable_sort(order.begin(), order.end(), _ByUtil(util));
+
+        for (std::vector<uint32_t>::const_iterator i = order.begin(); i != order.end(); ++i)
+        {
+            // First fit: the first cluster with enough spare capacity;
+            // worst fit (and first fit, if none): the one with most of it
+            int best = -1;
+            if (_packing == PACK_FFD)
+            {
+                for (std::vector<_Cluster>::size_type c = 0; c < _clusters.size(); ++c)
+                {
+                    if (load[c] + util[*i] <= _clusters[c].cores.size())
+                    {
+                        best = c;
+                        break;
+                    }
+                }
+            }
+            if (best < 0)
+            {
+                for (std::vector<_Cluster>::size_type c = 0; c < _clusters.size(); ++c)
+                    if (best < 0 || _clusters[c].cores.size() - load[c] > _clusters[best].cores.size() - load[best])
+                        best = c;
+            }
+            _tasks[*i].cluster = best;
+            load[best] += util[*i];
+        }
+    }
+
+    void KernelNative::initializeSimulation(const double time_resolution, const double * const *c_time)
+    {
+        if (_packing != PACK_NONE && _clusters.size() > 1)
+        {
+            pack(time_resolution, c_time);
+            setupReadyQueues();
+        }
+
+        // The first instruction of each task, and the first activation
+        // of periodic tasks
+        for (std::vector<_TaskState>::size_type i = 0; i < _tasks.size(); ++i)
+        {
+            _tasks[i].sim._instrs.assign(1, toTicks(*c_time[i], time_resolution));
+            _tasks[i].sim._pc = 0;
+            if (_tasks[i].periodic)
+                post(_tasks[i].ph, NEVT_ARRIVAL, i, 1);
+        }
+    }
+
+    //
+    // Event queue management
+    //
+    void KernelNative::post(long long time, NativeEventKind kind, uint32_t task, uint32_t gen)
+    {
+        NativeEvent e;
+        e.time = time;
+        e.kind = kind;
+        e.task = task;
+        e.gen = gen;
+        e.seq = _evt_seq++;
+        _queue->push(e);
+        _next_time_valid = false;
+    }
+
+    bool KernelNative::isValid(const NativeEvent &e) const
+    {
+        switch (e.kind)
+        {
+            case NEVT_END_INSTR:
+            case NEVT_END_TASK:
+                return _tasks[e.task].core >= 0 && e.gen == _tasks[e.task].instr_gen;
+            case NEVT_QUANTUM:
+                return _tasks[e.task].core >= 0 && e.gen == _tasks[e.task].slice_gen;
+            default:
+                return true;
+        }
+    }
+
+    void KernelNative::purge()
+    {
+        while (!_queue->empty() && !isValid(_queue->top()))
+            _queue->pop();
+    }
+
+    void KernelNative::processNextEvent()
+    {
+        _next_time_valid = false;
+        if (_replay == REPLAY_ON)
+        {
+            replayNextEvent();
+            return;
+        }
+
+        purge();
+        if (_queue->empty())
+            return;
+
+        if (_replay == REPLAY_DETECT && _queue->top().time >= _next_boundary)
+        {
+            onBoundary();
+            if (_replay == REPLAY_ON)
+            {
+                replayNextEvent();
+                return;
+            }
+        }
+        simulateNextEvent();
+    }
+
+    void KernelNative::simulateNextEvent()
+    {
+        NativeEvent e = _queue->top();
+        _queue->pop();
+        _now = e.time;
+        ++_stats.events;
+
+        // Record it, if a hyperperiod is being recorded
+        if (_snapshot.valid)
+        {
+            _record.events.push_back(e);
+            _record.events.back().time -= _snapshot.boundary;
+            if (_record.events.size() > MAX_REPLAY_EVENTS)
+            {
+                // Too long to be worth it
+                _replay = REPLAY_OFF;
+                _snapshot = _Snapshot();
+                _record.clear();
+            }
+        }
+
+        switch (e.kind)
+        {
+            case NEVT_END_INSTR:    onEndInstr(e.task); break;
+            case NEVT_END_TASK:     onEndTask(e.task); break;
+            case NEVT_ARRIVAL:
+                // Periodic activations (gen 1) re-arm themselves
+                if (e.gen == 1)
+                    post(_now + _tasks[e.task].iat, NEVT_ARRIVAL, e.task, 1);
+                onArrival(e.task);
+                break;
+            case NEVT_QUANTUM:      onQuantum(e.task); break;
+            case NEVT_DISPATCH:     dispatch(); break;
+        }
+    }
+
+    tres::RTOSEvent* KernelNative::getNextEvent()
+    {
+        if (_replay == REPLAY_ON)
+        {
+            // The next recorded event (of the next hyperperiod, at the end)
+            bool wrap = (_replay_event == _record.events.size());
+            const NativeEvent &e = _record.events[wrap ? 0 : _replay_event];
+            _next_event._time = _replay_base + (wrap ? _hyperperiod : 0) + e.time;
+            _next_event._kind = e.kind;
+            _next_event._task = (e.kind == NEVT_DISPATCH) ? NULL : &_tasks[e.task].sim;
+            return &_next_event;
+        }
+
+        purge();
+        if (_queue->empty())
+        {
+            _next_event._time = _now;
+            _next_event._kind = NEVT_NONE;
+            _next_event._task = NULL;
+        }
+        else
+        {
+            const NativeEvent &e = _queue->top();
+            _next_event._time = e.time;
+            _next_event._kind = e.kind;
+            _next_event._task = (e.kind == NEVT_DISPATCH) ? NULL : &_tasks[e.task].sim;
+        }
+        return &_next_event;
+    }
+
+    int KernelNative::getTimeOfNextEvent()
+    {
+        // The co-simulation asks for it several times per step: it is only
+        // computed after a change of the event queue
+        if (_next_time_valid)
+            return _next_time;
+
+        long long t;
+        if (_replay == REPLAY_ON)
+        {
+            if (_replay_event == _record.events.size())
+                t = _replay_base + _hyperperiod + _record.events[0].time;
+            else
+                t = _replay_base + _record.events[_replay_event].time;
+        }
+        else
+        {
+            purge();
+            t = _queue->empty() ? INT_MAX : std::min<long long>(_queue->top().time, INT_MAX);
+        }
+        _next_time = static_cast<int>(t);
+        _next_time_valid = true;
+        return _next_time;
+    }
+
+    int KernelNative::getNextWakeUpTime()
+    {
+        // All the events in the queue belong to this kernel
+        return getTimeOfNextEvent();
+    }
+
+    void KernelNative::getRunningTasks()
+    {
+        _running_tasks.clear();
+        for (std::vector<int>::const_iterator c = _cores.begin(); c != _cores.end(); ++c)
+            if (*c >= 0)
+                _running_tasks.push_back(_tasks[*c].sim._name);
+    }
+
+    void KernelNative::activateAperiodicTasks(std::vector<int>& aper_activ_idx, int sim_time)
+    {
+        for (std::vector<int>::const_iterator r = aper_activ_idx.begin(); r != aper_activ_idx.end(); ++r)
+        {
+            std::map<int, int>::const_iterator t = _aper_req_task_map.find(*r);
+            if (t != _aper_req_task_map.end())
+                post(sim_time, NEVT_ARRIVAL, t->second, 0);
+        }
+    }
+
+    //
+    // Hyperperiod replay
+    //
+    void KernelNative::setCore(int core, int task)
+    {
+        _cores[core] = task;
+        if (_snapshot.valid && _replay == REPLAY_DETECT)
+        {
+            _CoreChange c;
+            c.event = _record.events.size() - 1;
+            c.core = core;
+            c.task = task;
+            _record.cores.push_back(c);
+        }
+    }
+
+    void KernelNative::onBoundary()
+    {
+        long long boundary = _next_boundary;
+        _next_boundary += _hyperperiod;
+        if (_queue->top().time >= _next_boundary)
+        {
+            // A hyperperiod with no events: start over at the next boundary
+            while (_queue->top().time >= _next_boundary)
+                _next_boundary += _hyperperiod;
+            _snapshot.valid = false;
+            _record.clear();
+            return;
+        }
+
+        _Snapshot cur;
+        takeSnapshot(cur, boundary);
+        if (_snapshot.valid && !_record.events.empty() && sameState(_snapshot, cur))
+        {
+            // Steady state: replay the recorded hyperperiod from here
+            _record_stats.events = _stats.events - _snapshot.stats.events;
+            _record_stats.jobs = _stats.jobs - _snapshot.stats.jobs;
+            _record_stats.preemptions = _stats.preemptions - _snapshot.stats.preemptions;
+            _record_stats.migrations = _stats.migrations - _snapshot.stats.migrations;
+            _record_stats.deadline_misses = _stats.deadline_misses - _snapshot.stats.deadline_misses;
+            _record_stats.lost_activations = _stats.lost_activations - _snapshot.stats.lost_activations;
+            _period_stats = _stats;
+            _replay = REPLAY_ON;
+            _replay_base = boundary;
+            _replay_event = 0;
+            _replay_input = 0;
+            _replay_core = 0;
+        }
+        else
+            _record.clear();
+        std::swap(_snapshot, cur);
+    }
+
+    void KernelNative::replayNextEvent()
+    {
+        if (_replay_event == _record.events.size())
+        {
+            if (_replay_input != _record.inputs.size())
+            {
+                // Some input of the hyperperiod is missing
+                fallBack();
+                processNextEvent();
+                return;
+            }
+
+            // Next hyperperiod
+            _stats.events += _record_stats.events;
+            _stats.jobs += _record_stats.jobs;
+            _stats.preemptions += _record_stats.preemptions;
+            _stats.migrations += _record_stats.migrations;
+            _stats.deadline_misses += _record_stats.deadline_misses;
+            _stats.lost_activations += _record_stats.lost_activations;
+            ++_stats.replayed_periods;
+            _period_stats = _stats;
+            _replay_base += _hyperperiod;
+            _next_boundary += _hyperperiod;
+            _replay_event = 0;
+            _replay_input = 0;
+            _replay_core = 0;
+        }
+
+        if (_replay_input < _record.inputs.size() && _record.inputs[_replay_input].event <= _replay_event)
+        {
+            // An input expected before this event is missing
+            fallBack();
+            processNextEvent();
+            return;
+        }
+
+        _now = _replay_base + _record.events[_replay_event].time;
+        for ( ; _replay_core < _record.cores.size() && _record.cores[_replay_core].event == _replay_event; ++_replay_core)
+            _cores[_record.cores[_replay_core].core] = _record.cores[_replay_core].task;
+        ++_replay_event;
+    }
+
+    void KernelNative::onTaskInput(uint32_t task, bool discard, int duration)
+    {
+        if (_replay == REPLAY_OFF)
+            return;
+
+        _Input in;
+        in.event = (_replay == REPLAY_ON) ? _replay_event : _record.events.size();
+        in.task = task;
+        in.discard = discard;
+        in.duration = discard ? 0 : duration;
+
+        if (_replay == REPLAY_DETECT)
+        {
+            if (_snapshot.valid)
+                _record.inputs.push_back(in);
+        }
+        else if (_replay_input < _record.inputs.size() && _record.inputs[_replay_input] == in)
+            ++_replay_input;
+        else
+            // A different input: back to simulation (the task applies the
+            // input afterwards)
+            fallBack();
+    }
+
+    void KernelNative::applyInput(const _Input &in)
+    {
+        SimTaskNative &sim = _tasks[in.task].sim;
+        if (in.discard)
+        {
+            sim._instrs.clear();
+            sim._pc = 0;
+        }
+        else
+            sim._instrs.push_back(in.duration);
+    }
+
+    void KernelNative::fallBack()
+    {
+        // Back to the state at the start of the hyperperiod, then simulate
+        // the events replayed so far, with the inputs received so far
+        _Record rec;
+        std::swap(rec, _record);
+        std::size_t events = _replay_event;
+        std::size_t inputs = _replay_input;
+
+        restoreSnapshot(_snapshot, _replay_base - _snapshot.boundary);
+        _stats = _period_stats;
+        _snapshot.valid = false;
+        _replay = REPLAY_DETECT;
+        _next_boundary = _replay_base + _hyperperiod;
+
+        std::size_t in = 0;
+        for (std::size_t ev = 0; ev < events; ++ev)
+        {
+            for ( ; in < inputs && rec.inputs[in].event == ev; ++in)
+                applyInput(rec.inputs[in]);
+            purge();
+            simulateNextEvent();
+        }
+        for ( ; in < inputs; ++in)
+            applyInput(rec.inputs[in]);
+    }
+
+    void KernelNative::takeSnapshot(_Snapshot &s, long long boundary)
+    {
+        s.valid = true;
+        s.boundary = boundary;
+        s.now = _now;
+        s.tasks = _tasks;
+        s.clusters = _clusters;
+        s.cores = _cores;
+        s.events.clear();
+        _queue->dump(s.events);
+        std::vector<NativeEvent>::iterator e = s.events.begin();
+        for (std::vector<NativeEvent>::const_iterator i = s.events.begin(); i != s.events.end(); ++i)
+            if (isValid(*i))
+                *e++ = *i;
+        s.events.erase(e, s.events.end());
+        std::sort(s.events.begin(), s.events.end());
+        s.evt_seq = _evt_seq;
+        s.act_seq = _act_seq;
+        s.dispatch_pending = _dispatch_pending;
+        s.dirty = _dirty;
+        std::sort(s.dirty.begin(), s.dirty.end());
+        s.stats = _stats;
+    }
+
+    void KernelNative::restoreSnapshot(const _Snapshot &s, long long shift)
+    {
+        _tasks = s.tasks;
+        _clusters = s.clusters;
+        _cores = s.cores;
+        for (std::vector<_TaskState>::iterator t = _tasks.begin(); t != _tasks.end(); ++t)
+        {
+            t->run_start += shift;
+            t->deadline += shift;
+            for (std::deque<long long>::iterator b = t->buffered.begin(); b != t->buffered.end(); ++b)
+                *b += shift;
+            t->entry.key = (_policy == EDF) ? t->entry.key + shift : t->entry.key;
+        }
+
+        // Absolute deadlines are the keys of the EDF queues
+        if (_policy == EDF)
+        {
+            for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+            {
+                c->ready.clear();
+                c->running.clear();
+            }
+            for (std::vector<_TaskState>::const_iterator t = _tasks.begin(); t != _tasks.end(); ++t)
+                if (t->active)
+                    (t->core >= 0 ? _clusters[t->cluster].running : _clusters[t->cluster].ready).insert(t->entry);
+        }
+
+        _queue->clear();
+        _next_time_valid = false;
+        for (std::vector<NativeEvent>::const_iterator e = s.events.begin(); e != s.events.end(); ++e)
+        {
+            NativeEvent ev = *e;
+            ev.time += shift;
+            _queue->push(ev);
+        }
+        _now = s.now + shift;
+        _evt_seq = s.evt_seq;
+        _act_seq = s.act_seq;
+        _dispatch_pending = s.dispatch_pending;
+        _dirty = s.dirty;
+    }
+
+    void KernelNative::saveEngineState(BinaryWriter &w)
+    {
+        // The state of the engine is not updated while replaying
+        if (_replay == REPLAY_ON)
+            fallBack();
+
+        w.put<uint32_t>(_policy);
+        w.put<uint64_t>(_tasks.size());
+        w.put<uint64_t>(_clusters.size());
+        w.put<uint64_t>(_cores.size());
+
+        for (std::vector<_TaskState>::const_iterator t = _tasks.begin(); t != _tasks.end(); ++t)
+        {
+            w.put<int32_t>(t->cluster);
+            w.put<uint8_t>(t->active);
+            w.put<int32_t>(t->core);
+            w.put<int32_t>(t->last_core);
+            w.put(t->remaining);
+            w.put(t->run_start);
+            w.put(t->deadline);
+            w.put(t->entry.key);
+            w.put(t->entry.seq);
+            w.put(t->instr_gen);
+            w.put(t->slice_gen);
+            w.putVector(std::vector<long long>(t->buffered.begin(), t->buffered.end()));
+            w.putVector(t->sim._instrs);
+            w.put<uint64_t>(t->sim._pc);
+        }
+        w.putVector(_cores);
+
+        // The valid pending events, in order
+        std::vector<NativeEvent> events;
+        _queue->dump(events);
+        std::vector<NativeEvent>::iterator e = events.begin();
+        for (std::vector<NativeEvent>::const_iterator i = events.begin(); i != events.end(); ++i)
+            if (isValid(*i))
+                *e++ = *i;
+        events.erase(e, events.end());
+        std::sort(events.begin(), events.end());
+        w.putVector(events);
+
+        w.put(_now);
+        w.put(_evt_seq);
+        w.put(_act_seq);
+        w.put<uint8_t>(_dispatch_pending);
+        w.putVector(_dirty);
+        w.put(_stats);
+        w.put<uint8_t>(_replay != REPLAY_OFF);
+        w.put(_next_boundary);
+    }
+
+    void KernelNative::loadEngineState(BinaryReader &r)
+    {
+        if (r.get<uint32_t>() != static_cast<uint32_t>(_policy) || r.get<uint64_t>() != _tasks.size()
+                || r.get<uint64_t>() != _clusters.size() || r.get<uint64_t>() != _cores.size())
+            throw BinaryIOExc("The snapshot belongs to a kernel with a different configuration");
+
+        std::vector<long long> buffered;
+        for (std::vector<_TaskState>::iterator t = _tasks.begin(); t != _tasks.end(); ++t)
+        {
+            t->cluster = r.get<int32_t>();
+            t->active = r.get<uint8_t>() != 0;
+            t->core = r.get<int32_t>();
+            t->last_core = r.get<int32_t>();
+            t->remaining = r.get<long long>();
+            t->run_start = r.get<long long>();
+            t->deadline = r.get<long long>();
+            t->entry.key = r.get<long long>();
+            t->entry.seq = r.get<uint64_t>();
+            t->entry.task = t - _tasks.begin();
+            t->instr_gen = r.get<uint32_t>();
+            t->slice_gen = r.get<uint32_t>();
+            r.getVector(buffered);
+            t->buffered.assign(buffered.begin(), buffered.end());
+            r.getVector(t->sim._instrs);
+            t->sim._pc = static_cast<std::size_t>(r.get<uint64_t>());
+            if (t->cluster < 0 || t->cluster >= static_cast<int>(_clusters.size())
+                    || t->core >= static_cast<int>(_cores.size()))
+                throw BinaryIOExc("Malformed kernel snapshot");
+        }
+        const std::size_t n_cores = _cores.size();
+        r.getVector(_cores);
+        if (_cores.size() != n_cores)
+            throw BinaryIOExc("Malformed kernel snapshot");
+
+        // Ready and running queues, and idle cores (the jobs of a ready
+        // queue are in priority order, then in activation order)
+        setupReadyQueues();
+        std::vector<_ReadyEntry> ready;
+        for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+        {
+            c->ready.clear();
+            c->running.clear();
+            c->idle = std::priority_queue<int, std::vector<int>, std::greater<int> >();
+            c->dirty = false;
+            for (std::vector<int>::const_iterator k = c->cores.begin(); k != c->cores.end(); ++k)
+                if (_cores[*k] < 0)
+                    c->idle.push(*k);
+        }
+        for (std::vector<_TaskState>::const_iterator t = _tasks.begin(); t != _tasks.end(); ++t)
+        {
+            if (t->active && t->core >= 0)
+                _clusters[t->cluster].running.insert(t->entry);
+            else if (t->active)
+                ready.push_back(t->entry);
+        }
+        std::sort(ready.begin(), ready.end());
+        for (std::vector<_ReadyEntry>::const_iterator i = ready.begin(); i != ready.end(); ++i)
+            readyInsert(i->task, false);
+
+        std::vector<NativeEvent> events;
+        r.getVector(events);
+        _queue->clear();
+        for (std::vector<NativeEvent>::const_iterator e = events.begin(); e != events.end(); ++e)
+            _queue->push(*e);
+        _next_time_valid = false;
+
+        _now = r.get<long long>();
+        _evt_seq = r.get<uint64_t>();
+        _act_seq = r.get<uint64_t>();
+        _dispatch_pending = r.get<uint8_t>() != 0;
+        r.getVector(_dirty);
+        for (std::vector<int>::const_iterator d = _dirty.begin(); d != _dirty.end(); ++d)
+        {
+            if (*d < 0 || *d >= static_cast<int>(_clusters.size()))
+                throw BinaryIOExc("Malformed kernel snapshot");
+            _clusters[*d].dirty = true;
+        }
+        _stats = r.get<Stats>();
+
+        // Look for a steady state from scratch
+        const bool replay = r.get<uint8_t>() != 0;
+        _next_boundary = r.get<long long>();
+        _replay = (replay && _hyperperiod > 0) ? REPLAY_DETECT : REPLAY_OFF;
+        _snapshot = _Snapshot();
+        _record.clear();
+    }
+
+    bool KernelNative::sameState(const _Snapshot &a, const _Snapshot &b) const
+    {
+        long long d = b.boundary - a.boundary;
+        if (a.cores != b.cores || a.dispatch_pending != b.dispatch_pending || a.dirty != b.dirty
+                || a.events.size() != b.events.size() || a.now + d != b.now)
+            return false;
+
+        // Jobs: progress, timing and instructions
+        std::vector<_JobPos> pa, pb;
+        for (std::vector<_TaskState>::size_type i = 0; i < a.tasks.size(); ++i)
+        {
+            const _TaskState &ta = a.tasks[i], &tb = b.tasks[i];
+            if (ta.active != tb.active || ta.core != tb.core || ta.last_core != tb.last_core
+                    || ta.cluster != tb.cluster || ta.remaining != tb.remaining
+                    || ta.sim._pc != tb.sim._pc || ta.sim._instrs != tb.sim._instrs
+                    || ta.buffered.size() != tb.buffered.size())
+                return false;
+            for (std::deque<long long>::size_type k = 0; k < ta.buffered.size(); ++k)
+                if (ta.buffered[k] + d != tb.buffered[k])
+                    return false;
+            if (!ta.active)
+                continue;
+            if (ta.deadline + d != tb.deadline || (ta.core >= 0 && ta.run_start + d != tb.run_start))
+                return false;
+
+            _JobPos p = { ta.cluster, ta.core >= 0, ta.entry.key, ta.entry.seq, static_cast<uint32_t>(i) };
+            pa.push_back(p);
+            p.key = tb.entry.key;
+            p.seq = tb.entry.seq;
+            pb.push_back(p);
+        }
+
+        // The same order of the jobs in the ready and running queues
+        std::sort(pa.begin(), pa.end());
+        std::sort(pb.begin(), pb.end());
+        for (std::vector<_JobPos>::size_type k = 0; k < pa.size(); ++k)
+            if (pa[k].task != pb[k].task || pa[k].cluster != pb[k].cluster || pa[k].running != pb[k].running)
+                return false;
+
+        // The same pending events, in the same order
+        for (std::vector<NativeEvent>::size_type k = 0; k < a.events.size(); ++k)
+        {
+            const NativeEvent &ea = a.events[k], &eb = b.events[k];
+            if (ea.time + d != eb.time || ea.kind != eb.kind || ea.task != eb.task)
+                return false;
+        }
+        return true;
+    }
+
+    //
+    // Scheduling
+    //
+    long long KernelNative::readyKey(const _TaskState &t) const
+    {
+        switch (_policy)
+        {
+            case FP:    return t.prio;
+            case DM:    return t.rdl;
+            case RM:    return t.periodic ? t.iat : LLONG_MAX;
+            case EDF:   return t.deadline;
+            default:    return 0;   // RR, FIFO: activation order
+        }
+    }
+
+    bool KernelNative::readyEmpty(const _Cluster &c) const
+    {
+        return _bitmap ? c.bitmap.empty() : c.ready.empty();
+    }
+
+    const KernelNative::_ReadyEntry& KernelNative::readyFirst(const _Cluster &c) const
+    {
+        if (_bitmap)
+            return _tasks[c.members[c.bitmap.first()]].entry;
+        return *c.ready.begin();
+    }
+
+    void KernelNative::readyInsert(uint32_t i, bool resumed)
+    {
+        _TaskState &t = _tasks[i];
+        _Cluster &c = _clusters[t.cluster];
+        if (!_bitmap)
+            c.ready.insert(t.entry);
+        else if (resumed)
+            // A preempted job precedes the jobs of its level activated
+            // after it (that is, all the ready ones)
+            c.bitmap.pushFront(t.local, t.level);
+        else
+            c.bitmap.pushBack(t.local, t.level);
+    }
+
+    void KernelNative::readyRemove(uint32_t i)
+    {
+        _TaskState &t = _tasks[i];
+        _Cluster &c = _clusters[t.cluster];
+        if (_bitmap)
+            c.bitmap.remove(t.local);
+        else
+            c.ready.erase(t.entry);
+    }
+
+    void KernelNative::requestDispatch(int cluster)
+    {
+        if (!_clusters[cluster].dirty)
+        {
+            _clusters[cluster].dirty = true;
+            _dirty.push_back(cluster);
+        }
+        if (!_dispatch_pending)
+        {
+            _dispatch_pending = true;
+            post(_now, NEVT_DISPATCH);
+        }
+    }
+
+    void KernelNative::activate(uint32_t i, long long arrival)
+    {
+        _TaskState &t = _tasks[i];
+        t.active = true;
+        t.sim._pc = 0;
+        t.remaining = t.sim._instrs.empty() ? 0 : std::max(0LL, t.sim._instrs[0]);
+        t.deadline = arrival + t.rdl;
+        t.entry.key = readyKey(t);
+        t.entry.seq = _act_seq++;
+        t.entry.task = i;
+        readyInsert(i, false);
+        ++_stats.jobs;
+        requestDispatch(t.cluster);
+    }
+
+    void KernelNative::start(uint32_t i, int core)
+    {
+        _TaskState &t = _tasks[i];
+        t.core = core;
+        setCore(core, i);
+        _clusters[t.cluster].running.insert(t.entry);
+        if (t.last_core >= 0 && t.last_core != core)
+            ++_stats.migrations;
+        t.run_start = _now;
+
+        // The current instruction ends after its remaining time (or the
+        // job ends right away, if there is nothing left to execute)
+        ++t.instr_gen;
+        if (t.sim._pc < t.sim._instrs.size())
+            post(_now + t.remaining, NEVT_END_INSTR, i, t.instr_gen);
+        else
+            post(_now, NEVT_END_TASK, i, t.instr_gen);
+
+        if (_policy == RR)
+            post(_now + _quantum, NEVT_QUANTUM, i, ++t.slice_gen);
+    }
+
+    int KernelNative::preempt(uint32_t i)
+    {
+        _TaskState &t = _tasks[i];
+        int core = t.core;
+        t.remaining = std::max(0LL, t.remaining - (_now - t.run_start));
+        _clusters[t.cluster].running.erase(t.entry);
+        setCore(t.core, -1);
+        t.last_core = t.core;
+        t.core = -1;
+        ++t.instr_gen;
+        ++t.slice_gen;
+        ++_stats.preemptions;
+
+        // Round-robin: back to the tail of the queue
+        if (_policy == RR)
+            t.entry.seq = _act_seq++;
+        readyInsert(i, _policy != RR);
+        return core;
+    }
+
+    void KernelNative::dispatch()
+    {
+        _dispatch_pending = false;
+
+        // Clusters in index order, so that simultaneous events are
+        // posted in a deterministic order
+        std::sort(_dirty.begin(), _dirty.end());
+        for (std::vector<int>::const_iterator d = _dirty.begin(); d != _dirty.end(); ++d)
+        {
+            _Cluster &c = _clusters[*d];
+            c.dirty = false;
+            while (!readyEmpty(c))
+            {
+                _ReadyEntry best = readyFirst(c);
+
+                // The idle core with the lowest index, or the core of the
+                // lowest-priority running job (if the best ready one has a
+                // higher priority)
+                int core;
+                if (!c.idle.empty())
+                {
+                    core = c.idle.top();
+                    c.idle.pop();
+                    readyRemove(best.task);
+                }
+                else
+                {
+                    if (!_preemptive || !(best < *c.running.rbegin()))
+                        break;
+                    uint32_t worst = c.running.rbegin()->task;
+                    readyRemove(best.task);
+                    core = preempt(worst);
+                }
+
+                start(best.task, core);
+            }
+        }
+        _dirty.clear();
+    }
+
+    void KernelNative::onEndInstr(uint32_t i)
+    {
+        _TaskState &t = _tasks[i];
+
+        // Move to the next instruction (the co-simulation may
+        // have just added it), or end the job
+        ++t.sim._pc;
+        ++t.instr_gen;
+        t.run_start = _now;
+        if (t.sim._pc < t.sim._instrs.size())
+        {
+            t.remaining = std::max(0LL, t.sim._instrs[t.sim._pc]);
+            post(_now + t.remaining, NEVT_END_INSTR, i, t.instr_gen);
+        }
+        else
+            post(_now, NEVT_END_TASK, i, t.instr_gen);
+    }
+
+    void KernelNative::onEndTask(uint32_t i)
+    {
+        _TaskState &t = _tasks[i];
+        if (_now > t.deadline)
+            ++_stats.deadline_misses;
+
+        t.active = false;
+        _clusters[t.cluster].running.erase(t.entry);
+        _clusters[t.cluster].idle.push(t.core);
+        setCore(t.core, -1);
+        t.last_core = t.core;
+        t.core = -1;
+        ++t.instr_gen;
+        ++t.slice_gen;
+
+        // Serve the activations received meanwhile
+        if (!t.buffered.empty())
+        {
+            long long arrival = t.buffered.front();
+            t.buffered.pop_front();
+            activate(i, arrival);
+        }
+        requestDispatch(t.cluster);
+    }
+
+    void KernelNative::onArrival(uint32_t i)
+    {
+        _TaskState &t = _tasks[i];
+        if (!t.active)
+            activate(i, _now);
+        else if (t.buffered.size() < MAX_BUFFERED_ACTIVATIONS)
+            t.buffered.push_back(_now);
+        else
+            ++_stats.lost_activations;
+    }
+
+    void KernelNative::onQuantum(uint32_t i)
+    {
+        _TaskState &t = _tasks[i];
+        if (readyEmpty(_clusters[t.cluster]))
+        {
+            // Nobody is waiting: go on with a new quantum
+            post(_now + _quantum, NEVT_QUANTUM, i, ++t.slice_gen);
+            return;
+        }
+        _clusters[t.cluster].idle.push(preempt(i));
+        requestDispatch(t.cluster);
+    }
+}
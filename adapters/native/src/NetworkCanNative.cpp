@@ -0,0 +1,616 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file NetworkCanNative.cpp
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <tres_native/NetworkCanNative.hpp>
+#include "RandomGen.hpp"
+
+namespace tres
+{
+    static long long toTicks(double t, double time_resolution)
+    {
+        return std::llround(t * time_resolution);
+    }
+
+    /** Parse a number (the whole string) */
+    static double parseNumber(const std::string &s, const std::string &what)
+    {
+        char *end;
+        double v = std::strtod(s.c_str(), &end);
+        if (s.empty() || *end != '\0')
+            throw NetworkCanNativeExc("Invalid " + what + ": " + s);
+        return v;
+    }
+
+    Network* NetworkCanNative::createInstance(std::vector<std::string>& par)
+    {
+        // The input information for this function is _guaranteed_ to have the following form
+        // (see the OMNeT++ adapter):
+        //  - the number of messages in the message-set (#msgs)     - std::string (1)
+        //  - the message-set description                           - std::string (#msgs)
+        //  - the number of items describing the network (#ndescr)  - std::string (1)
+        //  - the network description                               - std::string (#ndescr)
+        //  - path to additional libraries (not needed here)        - std::string (1)
+        //  - the time resolution                                   - std::string (1)
+        std::vector<std::string>::size_type pos = 0;
+        if (par.empty())
+            throw NetworkCanNativeExc("Empty network configuration");
+        int num_msgs = atoi(par[pos++].c_str());
+        if (num_msgs < 0 || par.size() < pos + num_msgs + 1)
+            throw NetworkCanNativeExc("Truncated message-set description");
+        std::vector<std::string> msgs(par.begin() + pos, par.begin() + pos + num_msgs);
+        pos += num_msgs;
+
+        int num_ndescr = atoi(par[pos++].c_str());
+        if (num_ndescr < 0 || par.size() < pos + num_ndescr + 2)
+            throw NetworkCanNativeExc("Truncated network description");
+        std::vector<std::string> ndescr(par.begin() + pos, par.begin() + pos + num_ndescr);
+        pos += num_ndescr + 1;
+
+        return new NetworkCanNative(msgs, ndescr, atof(par[pos].c_str()));
+    }
+
+    NetworkCanNative::NetworkCanNative(const std::vector<std::string> &msgs, const std::vector<std::string> &ndescr, double time_resolution) :
+        _time_resolution(time_resolution), _bitrate(500000), _stuffing(CAN_STUFF_WORST), _fifo(false),
+        _errors(ERR_NONE), _error_prob(0), _error_interval(0), _next_error(0),
+        _offered(_FrameOrder(true)), _busy(false), _arbitration(false), _now(0), _evt_seq(0), _frame_seq(0), _rng(new MinStdGen(1))
+    {
+        using namespace tres_parse_utils;
+
+        if (!(time_resolution > 0))
+            throw NetworkCanNativeExc("Invalid time resolution");
+
+        // The network (and the parameters of the messages given there)
+        std::map<std::string, std::vector<std::string> > params;
+        for (std::vector<std::string>::const_iterator d = ndescr.begin(); d != ndescr.end(); ++d)
+        {
+            std::vector<std::string> tokens = split_instr(*d);
+            if (tokens.empty())
+                continue;
+            const std::string &item = tokens[0];
+            std::string value = (tokens.size() > 1) ? tokens[1] : std::string();
+            if (item == "bitrate")
+            {
+                _bitrate = parseNumber(value, "bit rate");
+                if (!(_bitrate > 0))
+                    throw NetworkCanNativeExc("Invalid bit rate: " + value);
+            }
+            else if (item == "stuffing")
+            {
+                if (!parseCanStuffing(value, _stuffing))
+                    throw NetworkCanNativeExc("Unknown stuffing mode: " + value);
+            }
+            else if (item == "txqueue")
+            {
+                if (value == "priority")
+                    _fifo = false;
+                else if (value == "fifo")
+                    _fifo = true;
+                else
+                    throw NetworkCanNativeExc("Unknown transmit queue: " + value);
+            }
+            else if (item == "errors")
+            {
+                if (value == "none")
+                    _errors = ERR_NONE;
+                else if (value.compare(0, 7, "random:") == 0)
+                {
+                    _errors = ERR_RANDOM;
+                    _error_prob = parseNumber(value.substr(7), "error probability");
+                    if (_error_prob < 0 || _error_prob >= 1)
+                        throw NetworkCanNativeExc("Invalid error probability: " + value);
+                }
+                else if (value.compare(0, 9, "sporadic:") == 0)
+                {
+                    _errors = ERR_SPORADIC;
+                    _error_interval = toTicks(parseNumber(value.substr(9), "error interval"), time_resolution);
+                    if (_error_interval <= 0)
+                        throw NetworkCanNativeExc("Invalid error interval: " + value);
+                    _next_error = _error_interval;
+                }
+                else
+                    throw NetworkCanNativeExc("Unknown error mode: " + value);
+            }
+            else if (item == "seed")
+            {
+                double seed = parseNumber(value, "seed");
+                if (seed < 1 || seed >= _rng->getModule())
+                    throw NetworkCanNativeExc("Invalid seed: " + value);
+                _rng->init(static_cast<RandNum>(seed));
+            }
+            else if (item == "message")
+            {
+                if (value.empty() || !params.insert(std::make_pair(value, tokens)).second)
+                    throw NetworkCanNativeExc("Invalid or duplicate message item: " + *d);
+            }
+        }
+
+        // The message-set
+        std::map<std::string, uint32_t> nodes;
+        std::set<uint64_t> keys;
+        _msgs.resize(msgs.size());
+        for (std::vector<std::string>::size_type i = 0; i < msgs.size(); ++i)
+        {
+            std::vector<std::string> tokens = split_instr(msgs[i]);
+            if (tokens.size() < 2)
+                throw NetworkCanNativeExc("The CAN message needs an identifier: " + msgs[i]);
+            _Message &m = _msgs[i];
+
+            // The identifier (hexadecimal)
+            const std::string &uid = tokens[1];
+            if (!parseCanIdentifier(uid, m.id, m.extended))
+                throw NetworkCanNativeExc("Invalid CAN identifier: " + uid);
+            m.key = canArbitrationKey(m.id, m.extended);
+            if (!keys.insert(m.key).second)
+                throw NetworkCanNativeExc("Duplicate CAN identifier: " + uid);
+
+            // A row without parameters takes those of the network description
+            if (tokens.size() < 3 || tokens[2].empty())
+            {
+                std::map<std::string, std::vector<std::string> >::const_iterator p = params.find(uid);
+                if (p != params.end())
+                {
+                    tokens.resize(2);
+                    tokens.insert(tokens.end(), p->second.begin() + 2, p->second.end());
+                }
+                tokens.resize(std::max<std::size_t>(tokens.size(), 3));
+            }
+
+            m.period = tokens[2].empty() ? 0 : toTicks(parseNumber(tokens[2], "period"), time_resolution);
+            if (m.period < 0 || (m.period == 0 && !tokens[2].empty()))
+                throw NetworkCanNativeExc("Invalid period of message " + uid);
+            m.dlc = (tokens.size() > 3 && !tokens[3].empty()) ? static_cast<int>(parseNumber(tokens[3], "DLC")) : 8;
+            if (m.dlc < 0 || m.dlc > 8)
+                throw NetworkCanNativeExc("Invalid DLC of message " + uid);
+            std::string node = (tokens.size() > 4 && !tokens[4].empty()) ? tokens[4] : "#" + uid;
+            m.offset = (tokens.size() > 5 && !tokens[5].empty()) ? toTicks(parseNumber(tokens[5], "offset"), time_resolution) : 0;
+            m.jitter = (tokens.size() > 6 && !tokens[6].empty()) ? toTicks(parseNumber(tokens[6], "jitter"), time_resolution) : 0;
+            if (m.offset < 0 || m.jitter < 0 || (m.period > 0 && m.jitter > m.period))
+                throw NetworkCanNativeExc("Invalid offset or jitter of message " + uid);
+
+            // Its controller
+            std::map<std::string, uint32_t>::iterator n = nodes.find(node);
+            if (n == nodes.end())
+            {
+                n = nodes.insert(std::make_pair(node, static_cast<uint32_t>(_nodes.size()))).first;
+                _nodes.push_back(_Node());
+                _nodes.back().queue = std::set<_Frame, _FrameOrder>(_FrameOrder(!_fifo));
+            }
+            m.node = n->second;
+
+            m.duration = bitsToTicks(getFrameBits(m.extended, m.dlc));
+            m.next_period = m.offset;
+            m.stats.queued = 0;
+            m.stats.delivered = 0;
+            m.stats.errors = 0;
+            m.stats.max_response = 0;
+            m.stats.total_response = 0;
+
+            // Register the message/port correspondency
+            m.sim._uid = uid;
+            _msg_port_map[uid] = i;
+        }
+
+        _stats.events = 0;
+        _stats.transmissions = 0;
+        _stats.errors = 0;
+        _stats.busy = 0;
+
+        // The first queuing of each (periodic) message
+        for (std::vector<_Message>::size_type i = 0; i < _msgs.size(); ++i)
+        {
+            if (_msgs[i].period == 0)
+                continue;
+            long long j = (_msgs[i].jitter > 0) ? static_cast<long long>(uniform() * (_msgs[i].jitter + 1)) : 0;
+            post(_msgs[i].next_period + j, CEVT_QUEUE, i);
+        }
+    }
+
+    NetworkCanNative::~NetworkCanNative()
+    {
+    }
+
+    int NetworkCanNative::getFrameBits(bool extended, int dlc)
+    {
+        return canFrameBits(extended, dlc);
+    }
+
+    int NetworkCanNative::getFrameBits(uint32_t id, bool extended, const uint8_t *data, int dlc)
+    {
+        // The bit stream subject to stuffing (data frames)
+        uint8_t bits[160];
+        int n = 0;
+        bits[n++] = 0;                                  // SOF
+        if (extended)
+        {
+            for (int b = 28; b >= 18; --b)
+                bits[n++] = (id >> b) & 1;
+            bits[n++] = 1;                              // SRR
+            bits[n++] = 1;                              // IDE
+            for (int b = 17; b >= 0; --b)
+                bits[n++] = (id >> b) & 1;
+            bits[n++] = 0;                              // RTR
+            bits[n++] = 0;                              // r1
+            bits[n++] = 0;                              // r0
+        }
+        else
+        {
+            for (int b = 10; b >= 0; --b)
+                bits[n++] = (id >> b) & 1;
+            bits[n++] = 0;                              // RTR
+            bits[n++] = 0;                              // IDE
+            bits[n++] = 0;                              // r0
+        }
+        for (int b = 3; b >= 0; --b)
+            bits[n++] = (dlc >> b) & 1;
+        for (int k = 0; k < dlc; ++k)
+            for (int b = 7; b >= 0; --b)
+                bits[n++] = (data[k] >> b) & 1;
+
+        // CRC-15
+        unsigned crc = 0;
+        for (int k = 0; k < n; ++k)
+        {
+            unsigned next = bits[k] ^ ((crc >> 14) & 1);
+            crc = (crc << 1) & 0x7fff;
+            if (next)
+                crc ^= 0x4599;
+        }
+        for (int b = 14; b >= 0; --b)
+            bits[n++] = (crc >> b) & 1;
+
+        // A stuff bit of opposite value after 5 consecutive equal bits
+        // (stuff bits included)
+        int stuff = 0, run = 0, last = -1;
+        for (int k = 0; k < n; ++k)
+        {
+            if (bits[k] == last)
+                ++run;
+            else
+            {
+                last = bits[k];
+                run = 1;
+            }
+            if (run == 5)
+            {
+                ++stuff;
+                last = !last;
+                run = 1;
+            }
+        }
+        return n + stuff + 13;
+    }
+
+    long long NetworkCanNative::bitsToTicks(long long bits) const
+    {
+        return static_cast<long long>(std::ceil(bits * _time_resolution / _bitrate - 1e-9));
+    }
+
+    long long NetworkCanNative::getFrameDuration(std::size_t msg) const
+    {
+        return _msgs[msg].duration;
+    }
+
+    long long NetworkCanNative::transmissionTime(const _Message &m)
+    {
+        switch (_stuffing)
+        {
+            case CAN_STUFF_NONE:
+                return bitsToTicks(canFrameBits(m.extended, m.dlc, false));
+            case CAN_STUFF_EXACT:
+            {
+                uint8_t data[8];
+                for (int k = 0; k < m.dlc; ++k)
+                    data[k] = static_cast<uint8_t>(uniform() * 256);
+                return bitsToTicks(getFrameBits(m.id, m.extended, data, m.dlc));
+            }
+            default:
+                return m.duration;
+        }
+    }
+
+    double NetworkCanNative::uniform()
+    {
+        // The samples are in [1, module - 1]
+        return (_rng->sample() - 1) / static_cast<double>(_rng->getModule() - 1);
+    }
+
+    void NetworkCanNative::post(long long time, unsigned int kind, uint32_t msg)
+    {
+        NativeEvent e;
+        e.time = time;
+        e.kind = kind;
+        e.task = msg;
+        e.gen = 0;
+        e.seq = _evt_seq++;
+        _queue.push(e);
+    }
+
+    void NetworkCanNative::enqueue(const _Frame &f)
+    {
+        // The controller offers the head of its queue
+        std::set<_Frame, _FrameOrder> &q = _nodes[_msgs[f.msg].node].queue;
+        if (!q.empty() && q.key_comp()(f, *q.begin()))
+            _offered.erase(*q.begin());
+        q.insert(f);
+        if (q.begin()->seq == f.seq)
+            _offered.insert(f);
+
+        // Arbitration once all the frames of this time are queued
+        if (!_busy && !_arbitration)
+        {
+            post(_now, CEVT_ARBITRATE, 0);
+            _arbitration = true;
+        }
+    }
+
+    void NetworkCanNative::arbitrate()
+    {
+        _arbitration = false;
+        if (_busy || _offered.empty())
+            return;
+
+        // The lowest identifier wins; its controller offers the next frame
+        _tx = *_offered.begin();
+        _offered.erase(_offered.begin());
+        std::set<_Frame, _FrameOrder> &q = _nodes[_msgs[_tx.msg].node].queue;
+        q.erase(q.begin());
+        if (!q.empty())
+            _offered.insert(*q.begin());
+        _busy = true;
+
+        _Message &m = _msgs[_tx.msg];
+        long long duration = transmissionTime(m);
+        bool error = false;
+        if (_errors == ERR_RANDOM)
+            error = (uniform() < _error_prob);
+        else if (_errors == ERR_SPORADIC)
+        {
+            // Errors on the idle bus go unnoticed
+            while (_next_error < _now)
+                _next_error += _error_interval;
+            if (_next_error < _now + duration)
+            {
+                error = true;
+                _next_error += _error_interval;
+            }
+        }
+
+        ++_stats.transmissions;
+        if (error)
+        {
+            duration += bitsToTicks(ERROR_FRAME_BITS);
+            ++_stats.errors;
+            ++m.stats.errors;
+            post(_now + duration, CEVT_ERROR, _tx.msg);
+        }
+        else
+            post(_now + duration, CEVT_DELIVER, _tx.msg);
+        _stats.busy += duration;
+    }
+
+    void NetworkCanNative::processNextEvent()
+    {
+        if (_queue.empty())
+            return;
+        NativeEvent e = _queue.top();
+        _queue.pop();
+        _now = e.time;
+        ++_stats.events;
+
+        switch (e.kind)
+        {
+            case CEVT_DELIVER:
+            {
+                MessageStats &s = _msgs[e.task].stats;
+                long long response = _now - _tx.release;
+                ++s.delivered;
+                s.total_response += response;
+                if (response > s.max_response)
+                    s.max_response = response;
+                _busy = false;
+                if (!_offered.empty() && !_arbitration)
+                {
+                    post(_now, CEVT_ARBITRATE, 0);
+                    _arbitration = true;
+                }
+                break;
+            }
+
+            case CEVT_ERROR:
+                // The frame is arbitrated again (in its place in the queue)
+                _busy = false;
+                enqueue(_tx);
+                break;
+
+            case CEVT_QUEUE:
+            {
+                _Message &m = _msgs[e.task];
+                _Frame f;
+                f.key = m.key;
+                f.seq = _frame_seq++;
+                f.queued = _now;
+                f.release = m.next_period;
+                f.msg = e.task;
+                ++m.stats.queued;
+                enqueue(f);
+
+                // The next period
+                m.next_period += m.period;
+                long long j = (m.jitter > 0) ? static_cast<long long>(uniform() * (m.jitter + 1)) : 0;
+                post(m.next_period + j, CEVT_QUEUE, e.task);
+                break;
+            }
+
+            case CEVT_ARBITRATE:
+                arbitrate();
+                break;
+        }
+    }
+
+    NetworkEvent* NetworkCanNative::getNextEvent()
+    {
+        if (_queue.empty())
+        {
+            _event._time = _now;
+            _event._kind = CEVT_NONE;
+            _event._msg = NULL;
+        }
+        else
+        {
+            const NativeEvent &e = _queue.top();
+            _event._time = e.time;
+            _event._kind = e.kind;
+            _event._msg = (e.kind == CEVT_ARBITRATE) ? NULL : &_msgs[e.task].sim;
+        }
+        return &_event;
+    }
+
+    int NetworkCanNative::getTimeOfNextEvent()
+    {
+        if (_queue.empty())
+            return INT_MAX;
+        return static_cast<int>(_queue.top().time);
+    }
+
+    int NetworkCanNative::getNextWakeUpTime()
+    {
+        return getTimeOfNextEvent();
+    }
+
+    void NetworkCanNative::saveState(BinaryWriter &w) const
+    {
+        w.put<uint64_t>(_msgs.size());
+        w.put<uint64_t>(_nodes.size());
+
+        // The messages to trigger, in a deterministic order
+        std::vector<std::string> trigger(_msg_to_trigger.begin(), _msg_to_trigger.end());
+        std::sort(trigger.begin(), trigger.end());
+        w.put<uint64_t>(trigger.size());
+        for (std::vector<std::string>::const_iterator t = trigger.begin(); t != trigger.end(); ++t)
+            w.putString(*t);
+
+        for (std::vector<_Message>::const_iterator m = _msgs.begin(); m != _msgs.end(); ++m)
+        {
+            w.put(m->next_period);
+            w.put(m->stats);
+        }
+        for (std::vector<_Node>::const_iterator n = _nodes.begin(); n != _nodes.end(); ++n)
+            w.putVector(std::vector<_Frame>(n->queue.begin(), n->queue.end()));
+
+        // The pending events, in order
+        std::vector<NativeEvent> events;
+        _queue.dump(events);
+        std::sort(events.begin(), events.end());
+        w.putVector(events);
+
+        w.put(_tx);
+        w.put<uint8_t>(_busy);
+        w.put<uint8_t>(_arbitration);
+        w.put(_next_error);
+        w.put(_now);
+        w.put(_evt_seq);
+        w.put(_frame_seq);
+        w.put(_stats);
+        _rng->saveState(w);
+    }
+
+    void NetworkCanNative::loadState(BinaryReader &r)
+    {
+        if (r.get<uint64_t>() != _msgs.size() || r.get<uint64_t>() != _nodes.size())
+            throw BinaryIOExc("The snapshot belongs to a network with a different configuration");
+
+        _msg_to_trigger.clear();
+        for (uint64_t n = r.get<uint64_t>(); n > 0; --n)
+        {
+            std::string uid = r.getString();
+            if (_msg_port_map.find(uid) == _msg_port_map.end())
+                throw BinaryIOExc("Malformed network snapshot");
+            _msg_to_trigger.insert(uid);
+        }
+
+        for (std::vector<_Message>::iterator m = _msgs.begin(); m != _msgs.end(); ++m)
+        {
+            m->next_period = r.get<long long>();
+            m->stats = r.get<MessageStats>();
+        }
+
+        // The transmit queues; the controllers offer their heads
+        std::vector<_Frame> frames;
+        _offered.clear();
+        for (std::vector<_Node>::iterator n = _nodes.begin(); n != _nodes.end(); ++n)
+        {
+            r.getVector(frames);
+            n->queue.clear();
+            for (std::vector<_Frame>::const_iterator f = frames.begin(); f != frames.end(); ++f)
+            {
+                if (f->msg >= _msgs.size() || &_nodes[_msgs[f->msg].node] != &*n)
+                    throw BinaryIOExc("Malformed network snapshot");
+                n->queue.insert(*f);
+            }
+            if (!n->queue.empty())
+                _offered.insert(*n->queue.begin());
+        }
+
+        std::vector<NativeEvent> events;
+        r.getVector(events);
+        _queue.clear();
+        for (std::vector<NativeEvent>::const_iterator e = events.begin(); e != events.end(); ++e)
+        {
+            if (e->kind >= CEVT_NONE || e->task >= _msgs.size())
+                throw BinaryIOExc("Malformed network snapshot");
+            _queue.push(*e);
+        }
+
+        _tx = r.get<_Frame>();
+        _busy = r.get<uint8_t>() != 0;
+        _arbitration = r.get<uint8_t>() != 0;
+        _next_error = r.get<long long>();
+        _now = r.get<long long>();
+        _evt_seq = r.get<uint64_t>();
+        _frame_seq = r.get<uint64_t>();
+        _stats = r.get<Stats>();
+        _rng->loadState(r);
+        if (_busy && _tx.msg >= _msgs.size())
+            throw BinaryIOExc("Malformed network snapshot");
+    }
+}
@@ -0,0 +1,105 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file SimTaskNative.hpp
+ */
+
+#ifndef TRES_SIMTASKNATIVE_HDR
+#define TRES_SIMTASKNATIVE_HDR
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tres/SimTask.hpp>
+
+namespace tres
+{
+    class KernelNative;
+
+    /**
+     * \addtogroup tres_native
+     * @{
+     */
+
+    /**
+     * \brief Task of the native scheduling engine, as seen by the co-simulation
+     *
+     * A job executes the instructions of the task in order; each instruction
+     * is a fixed amount of computation time, given by the co-simulation
+     * (see addInstruction()). The scheduling state of the task is kept by
+     * tres::KernelNative
+     */
+    class SimTaskNative : public tres::SimTask
+    {
+
+        friend class KernelNative;
+
+    public:
+
+        /**
+         * \brief Default constructor
+         */
+        SimTaskNative();
+
+        virtual std::string getUID() const;
+
+        virtual bool isEmpty();
+
+        virtual void discardInstructions();
+
+        virtual void addInstruction(int);
+
+    protected:
+
+        /** Name (univoque identifier) of the task */
+        std::string _name;
+
+        /** Durations (ticks) of the instructions of the task */
+        std::vector<long long> _instrs;
+
+        /** Index of the instruction being executed by the current job */
+        std::size_t _pc;
+
+        /** The kernel of the task (notified of the inputs, for replay) */
+        KernelNative *_kernel;
+
+        /** Index of the task in its kernel */
+        uint32_t _index;
+
+    };
+
+    /** @} */
+}
+
+#endif // TRES_SIMTASKNATIVE_HDR
@@ -83,6 +83,14 @@ namespace tres
 
     private:
 
+        /**
+         * \brief Return the process-wide handle to the NetworkOpp library
+         *
+         * The library is opened on first use and stays loaded until the
+         * process exits (parked instances of NetworkOpp live in it)
+         */
+        static void* libraryHandle();
+
         /**
          * \brief Prevent default construction
          */
@@ -144,12 +144,43 @@ namespace tres
         return _next_event;
     }
 
+    void NetworkOpp::_OppEventHandler::reset()
+    {
+        _next_event = NULL;
+    }
+
     //
     // NetworkOpp class
     // =================
     //
+    std::deque<NetworkOpp *> NetworkOpp::_warm_pool;
+
     Network* NetworkOpp::createInstance(std::vector<std::string>& par)
     {
+        // Reuse a parked instance built from the same parameters (if any)
+        std::string config_key;
+        for (std::vector<std::string>::const_iterator p = par.begin(); p != par.end(); ++p)
+            config_key.append(*p).push_back('\n');
+        for (std::deque<NetworkOpp *>::iterator w = _warm_pool.begin(); w != _warm_pool.end(); ++w)
+        {
+            if ((*w)->_config_key != config_key)
+                continue;
+            NetworkOpp *warm = *w;
+            _warm_pool.erase(w);
+            try
+            {
+                warm->restart();
+                return warm;
+            }
+            catch (std::exception& e)
+            {
+                // Fall back to a cold start
+                ::fprintf(stderr, "\n<!> Could not restart the network: %s.\n", e.what());
+                delete warm;
+            }
+            break;
+        }
+
         // The input information for this function is _guaranteed_ to have the following form:
         //  - the number of messages in the message-set (#msgs)     - std::string (1)      <-- vector.begin()
         //  - the message-set description                           - std::string (#msgs)
@@ -157,6 +188,8 @@ namespace tres
         //  - the number of items describing the network (#ndescr)  - std::string (1)
         //  - the network description                               - std::string (#ndescr)
         //      - "description_type;description_file_paths"
+        //      - "envmode;embedded|full" (optional, default full)
+        //      - "recording;on|off" (optional, default on)
         //  - the time resolution                                   - std::string (1)
         //                                                                             <-- vector.end()
         std::vector<std::string>::iterator it = par.begin();  // Convenience iterator
@@ -189,6 +222,8 @@ namespace tres
         // Extract all the description types
         // For each description get the file path
         std::vector<std::string> opp_params = {"tres_run"};
+        bool embedded = false;
+        bool recording = true;
         for (int i = 0; i < num_ndescr; i++)
         {
             // Tokenize the message description
@@ -197,6 +232,16 @@ namespace tres
             std::vector<std::string>::iterator jt = tokens.begin();
 
             // Get the description information
+            if (*jt == "envmode")
+            {
+                embedded = (*(++jt) == "embedded");
+                continue;
+            }
+            if (*jt == "recording")
+            {
+                recording = (*(++jt) != "off");
+                continue;
+            }
             if (*jt == "nedpath")
                 opp_params.push_back("-n");
             else if (*jt == "inifile")
@@ -206,6 +251,14 @@ namespace tres
             opp_params.push_back(*(++jt));
         }
 
+        // In embedded mode, results are discarded unless requested
+        // (command-line options override the ini files)
+        if (embedded && !recording)
+        {
+            opp_params.push_back("--outputvectormanager-class=TresNullOutputVectorManager");
+            opp_params.push_back("--outputscalarmanager-class=TresNullOutputScalarManager");
+        }
+
         // Additional libraries
         opp_params.push_back("-l");
         opp_params.push_back(*(it++));
@@ -214,10 +267,12 @@ namespace tres
         double time_resolution = atof((*(it++)).c_str());
         int time_resolution_exponent = log10 (time_resolution);
 
-        return new NetworkOpp(opp_params, msg_types, msg_uids, time_resolution_exponent);
+        NetworkOpp *ns = new NetworkOpp(opp_params, msg_types, msg_uids, time_resolution_exponent, embedded);
+        ns->_config_key = config_key;
+        return ns;
     }
 
-    NetworkOpp::NetworkOpp(const std::vector<std::string> &params, const std::vector<std::string> &msg_types, const std::vector<std::string> &msg_uids, const int time_resolution_exponent)
+    NetworkOpp::NetworkOpp(const std::vector<std::string> &params, const std::vector<std::string> &msg_types, const std::vector<std::string> &msg_uids, const int time_resolution_exponent, const bool embedded)
     {
         // Initialize the time resolution
         time_unit_exponent = -time_resolution_exponent;
@@ -232,8 +287,12 @@ namespace tres
                     ++it)
             _msg_port_map[*it] = it - msg_uids.begin();
 
-        // initialize the gateway to NULL
+        // initialize the gateway and the Opp entities to NULL
         gateway = NULL;
+        simulationobject = NULL;
+        bootconfig = NULL;
+        configobject = NULL;
+        app = NULL;
 
         // Convert the arguments to be given to the Opp engine from std::string to char **
         std::vector<const char *> argv(params.size());
@@ -244,8 +303,14 @@ namespace tres
         int exitcode = 0;
         try
         {
-            // Construct global lists
-            CodeFragments::executeAll(CodeFragments::STARTUP);
+            // Construct global lists (once per process: they survive
+            // the instances, see dispose())
+            static bool startup_done = false;
+            if (!startup_done)
+            {
+                CodeFragments::executeAll(CodeFragments::STARTUP);
+                startup_done = true;
+            }
 
             // ArgList
             ArgList args;
@@ -291,50 +356,56 @@ namespace tres
                 configobject = bootconfig;
             }
             
-            // Validate the configuration, but make sure we don't report cmdenv-* keys
-            // as errors if Cmdenv is absent; same for Tkenv.
-            std::string ignorablekeys;
-            if (omnetapps.getInstance()->lookup("Cmdenv")==NULL)
-                ignorablekeys += " cmdenv-*";
-            if (omnetapps.getInstance()->lookup("Tkenv")==NULL)
-                ignorablekeys += " tkenv-*";
-            configobject->validate(ignorablekeys.c_str());
-            
-            // Choose and set up user interface (EnvirBase subclass). Everything else
-            // will be done by the user interface class.
-            
-            // Was it specified explicitly which one to use?
-            std::string appname = opp_nulltoempty(args.optionValue('u',0));  // 1st '-u name' option
-            if (appname.empty())
-                appname = configobject->getAsString(CFGID_USER_INTERFACE);
-            cOmnetAppRegistration *appreg = NULL;
-            if (!appname.empty())
+            // In embedded mode, the user interfaces are neither validated nor
+            // looked up: T-Res only steps the scheduler (see Tresenv)
+            if (!embedded)
             {
-                // Look up specified user interface
-                appreg = static_cast<cOmnetAppRegistration *>(omnetapps.getInstance()->lookup(appname.c_str()));
-                if (!appreg)
+                // Validate the configuration, but make sure we don't report cmdenv-* keys
+                // as errors if Cmdenv is absent; same for Tkenv.
+                std::string ignorablekeys;
+                if (omnetapps.getInstance()->lookup("Cmdenv")==NULL)
+                    ignorablekeys += " cmdenv-*";
+                if (omnetapps.getInstance()->lookup("Tkenv")==NULL)
+                    ignorablekeys += " tkenv-*";
+                configobject->validate(ignorablekeys.c_str());
+                
+                // Choose and set up user interface (EnvirBase subclass). Everything else
+                // will be done by the user interface class.
+                
+                // Was it specified explicitly which one to use?
+                std::string appname = opp_nulltoempty(args.optionValue('u',0));  // 1st '-u name' option
+                if (appname.empty())
+                    appname = configobject->getAsString(CFGID_USER_INTERFACE);
+                cOmnetAppRegistration *appreg = NULL;
+                if (!appname.empty())
                 {
-                    ::printf("\n"
-                             "User interface '%s' not found (not linked in or loaded dynamically).\n"
-                             "Available ones are:\n", appname.c_str());
-                    cRegistrationList *a = omnetapps.getInstance();
-                    for (int i=0; i<a->size(); i++)
-                        ::printf("  %s : %s\n", a->get(i)->getName(), a->get(i)->info().c_str());
-                    
-                    throw cRuntimeError("Could not start user interface '%s'", appname.c_str());
+                    // Look up specified user interface
+                    appreg = static_cast<cOmnetAppRegistration *>(omnetapps.getInstance()->lookup(appname.c_str()));
+                    if (!appreg)
+                    {
+                        ::printf("\n"
+                                 "User interface '%s' not found (not linked in or loaded dynamically).\n"
+                                 "Available ones are:\n", appname.c_str());
+                        cRegistrationList *a = omnetapps.getInstance();
+                        for (int i=0; i<a->size(); i++)
+                            ::printf("  %s : %s\n", a->get(i)->getName(), a->get(i)->info().c_str());
+                        
+                        throw cRuntimeError("Could not start user interface '%s'", appname.c_str());
+                    }
                 }
-            }
-            else
-            {
-                // User interface not explicitly selected: pick one from what we have
-                appreg = cOmnetAppRegistration::chooseBest();
-                if (!appreg)
-                    throw cRuntimeError("No user interface (Cmdenv, Tkenv, etc.) found");
+                else
+                {
+                    // User interface not explicitly selected: pick one from what we have
+                    appreg = cOmnetAppRegistration::chooseBest();
+                    if (!appreg)
+                        throw cRuntimeError("No user interface (Cmdenv, Tkenv, etc.) found");
+                }
+                ::printf("Setting up %s...\n", appreg->getName());
             }
             
             // Create interface object.
-            ::printf("Setting up %s...\n", appreg->getName());
             app = new Tresenv();
+            app->setEmbedded(embedded);
         }
         catch (std::exception& e)
         {
@@ -376,16 +447,65 @@ namespace tres
     NetworkOpp::~NetworkOpp() noexcept(true)
     {
         // shutdown
-        app->sim_stop();
-        cSimulation::setActiveSimulation(NULL);
-        delete simulationobject;  // will delete app as well
+        if (simulationobject)
+        {
+            cSimulation::setActiveSimulation(simulationobject);
+            app->sim_stop();
+            cSimulation::setActiveSimulation(NULL);
+            delete simulationobject;  // will delete app as well
+        }
         //CodeFragments::executeAll(CodeFragments::SHUTDOWN);
         delete gateway;
     }
 
+    void NetworkOpp::dispose()
+    {
+        // Instances which did not start cannot be reused
+        if (!simulationobject || _config_key.empty())
+        {
+            delete this;
+            return;
+        }
+
+        cSimulation *active = cSimulation::getActiveSimulation();
+        cSimulation::setActiveSimulation(simulationobject);
+        try
+        {
+            app->finishRun();
+        }
+        catch (std::exception& e)
+        {
+            ::fprintf(stderr, "\n<!> %s.\n", e.what());
+            delete this;
+            return;
+        }
+        cSimulation::setActiveSimulation(active == simulationobject ? NULL : active);
+
+        // Park the instance (evicting the oldest one, if needed)
+        if (_warm_pool.size() == WARM_POOL_SIZE)
+        {
+            delete _warm_pool.front();
+            _warm_pool.pop_front();
+        }
+        _warm_pool.push_back(this);
+    }
+
+    void NetworkOpp::restart()
+    {
+        cSimulation::setActiveSimulation(simulationobject);
+        app->restartRun();
+
+        // Nothing from the previous run is pending
+        _evt_handler.reset();
+        _msg_to_trigger.clear();
+    }
+
     void NetworkOpp::processNextEvent()
     {
-        app->sim_step();
+        if (app->isEmbedded())
+            app->sim_step_embedded();
+        else
+            app->sim_step();
     }
 
     int NetworkOpp::getTimeOfNextEvent()
@@ -413,7 +533,7 @@ namespace tres
 
         void destroy_object(Network* p)
         {
-            delete p;
+            p->dispose();
         }
     }   
 }
@@ -38,6 +38,7 @@
 
 #ifndef TRES_NETWORKOPP_HDR
 #define TRES_NETWORKOPP_HDR
+#include <deque>
 #include <vector>
 #include <string>
 #include <map>
@@ -110,6 +111,11 @@ namespace tres
              */
             EventOpp* getEventOppInstancePtr();
 
+            /**
+             * \brief Forget the current event (e.g., when a run is restarted)
+             */
+            void reset();
+
         private:
             /** A space where the events for the current simulation are
              * (pre-)allocated at time of initialization */
@@ -137,6 +143,15 @@ namespace tres
          */
         virtual ~NetworkOpp() noexcept(true);
 
+        /**
+         * \brief Close the current run and keep the instance for reuse
+         *
+         * The instance (with its configuration, loaded libraries and OMNeT++
+         * environment) is parked in a process-wide pool; createInstance()
+         * restarts it when the same configuration is requested again
+         */
+        virtual void dispose();
+
         virtual void processNextEvent();
 
         /**
@@ -192,7 +207,24 @@ namespace tres
         /**
          * \brief Construct from external parameters
          */
-        NetworkOpp(const std::vector<std::string>&, const std::vector<std::string>&, const std::vector<std::string>&, const int);
+        NetworkOpp(const std::vector<std::string>&, const std::vector<std::string>&, const std::vector<std::string>&, const int, const bool);
+
+        /**
+         * \brief Start a new run on a parked instance
+         *
+         * Only the per-run state (RNG seeds, event queue, statistics) is
+         * re-initialized
+         */
+        void restart();
+
+        /** The parameters the instance was built from (see createInstance()) */
+        std::string _config_key;
+
+        /** Maximum number of parked instances */
+        static const std::size_t WARM_POOL_SIZE = 4;
+
+        /** Parked instances, oldest first (see dispose()) */
+        static std::deque<NetworkOpp *> _warm_pool;
 
     };
     /** @} */
@@ -41,26 +41,47 @@
 
 #include <dlfcn.h>
 #include <cstdlib>
+#include <mutex>
+#include <stdexcept>
 
 namespace tres
 {
+    void* NetworkOppGateway::libraryHandle()
+    {
+        static std::mutex lib_mutex;
+        static void* lib_handle = NULL;
+
+        std::lock_guard<std::mutex> lock(lib_mutex);
+        if (lib_handle == NULL)
+        {
+            const char *lib_dir = std::getenv("TRES_OMNETPP_LIB");
+            if (lib_dir == NULL)
+                throw std::runtime_error("TRES_OMNETPP_LIB is not set");
+            std::string lib_net_adapter_name = std::string(lib_dir) + "/libtres_omnetpp.so";
+            lib_handle = dlopen(lib_net_adapter_name.c_str(), RTLD_LAZY);
+            if (lib_handle == NULL)
+                throw std::runtime_error(dlerror());
+        }
+        return lib_handle;
+    }
+
     Network* NetworkOppGateway::createInstance(std::vector<std::string>& par)
     {
-        std::string lib_net_adapter_name = std::string( std::getenv("TRES_OMNETPP_LIB") )
-                                                + "/libtres_omnetpp.so";
-        void* handle = dlopen(lib_net_adapter_name.c_str(), RTLD_LAZY);
+        void* handle = libraryHandle();
 
-        // Declaration of Creator/Destructor functions
+        // Declaration of the Creator function
         Network* (*create)(std::vector<std::string>&);
-        void (*destroy)(Network*);
 
         // Initialization
         create = (Network* (*)(std::vector<std::string>&))dlsym(handle, "create_object");
-        destroy = (void (*)(Network*))dlsym(handle, "destroy_object");
+        if (create == NULL)
+            throw std::runtime_error(dlerror());
 
-        // Construct the object
+        // Construct the object (or restart a parked one, which
+        // already has its gateway)
         Network* ns = (Network*)create(par);
-        ((NetworkOpp *) ns)->gateway = new NetworkOppGateway(handle);
+        if (((NetworkOpp *) ns)->gateway == NULL)
+            ((NetworkOpp *) ns)->gateway = new NetworkOppGateway(handle);
         return ns;
     }
 
@@ -70,6 +91,6 @@ namespace tres
 
     NetworkOppGateway::~NetworkOppGateway()
     {
-        dlclose(handle);
+        // The library is shared by all the instances (see libraryHandle())
     }
 }
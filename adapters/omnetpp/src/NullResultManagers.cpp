@@ -0,0 +1,24 @@
+/*-----------------------------------------------------------------------------------
+ *  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+ *
+ *  This file is part of tres_omnetpp.
+ *
+ *  You can redistribute it and/or modify tres_omnetpp under the terms
+ *  of the Academic Public License as published at
+ *  http://www.omnetpp.org/intro/license.
+ *
+ *  tres_omnetpp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY. See the file `AP_License' for details on this
+ *  and other legal matters.
+ *--------------------------------------------------------------------------------- */
+
+/**
+ * \file NullResultManagers.cpp
+ */
+
+#include <onstartup.h>
+#include <globals.h>
+#include "NullResultManagers.hpp"
+
+Register_Class(TresNullOutputVectorManager);
+Register_Class(TresNullOutputScalarManager);
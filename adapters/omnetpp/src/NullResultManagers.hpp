@@ -0,0 +1,63 @@
+/*-----------------------------------------------------------------------------------
+ *  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+ *
+ *  This file is part of tres_omnetpp.
+ *
+ *  You can redistribute it and/or modify tres_omnetpp under the terms
+ *  of the Academic Public License as published at
+ *  http://www.omnetpp.org/intro/license.
+ *
+ *  tres_omnetpp is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY. See the file `AP_License' for details on this
+ *  and other legal matters.
+ *--------------------------------------------------------------------------------- */
+
+/**
+ * \file NullResultManagers.hpp
+ */
+
+#ifndef TRES_NULLRESULTMANAGERS_HDR
+#define TRES_NULLRESULTMANAGERS_HDR
+#include <envirext.h>    // cOutputVectorManager, cOutputScalarManager
+
+/**
+ * \addtogroup tres_omnetpp
+ * @{
+ */
+/**
+ * \brief Output vector manager which records nothing
+ *
+ * Used by the embedded environment (see NetworkOpp) when result
+ * recording is not requested
+ */
+class TresNullOutputVectorManager : public cOutputVectorManager
+{
+public:
+    virtual void startRun() {}
+    virtual void endRun() {}
+    virtual void *registerVector(const char *modulename, const char *vectorname) { return NULL; }
+    virtual void deregisterVector(void *vechandle) {}
+    virtual void setVectorAttribute(void *vechandle, const char *name, const char *value) {}
+    virtual bool record(void *vechandle, simtime_t t, double value) { return false; }
+    virtual const char *getFileName() const { return NULL; }
+    virtual void flush() {}
+};
+
+/**
+ * \brief Output scalar manager which records nothing
+ *
+ * Used by the embedded environment (see NetworkOpp) when result
+ * recording is not requested
+ */
+class TresNullOutputScalarManager : public cOutputScalarManager
+{
+public:
+    virtual void startRun() {}
+    virtual void endRun() {}
+    virtual void recordScalar(cComponent *component, const char *name, double value, opp_string_map *attributes=NULL) {}
+    virtual void recordStatistic(cComponent *component, const char *name, cStatistic *statistic, opp_string_map *attributes=NULL) {}
+    virtual const char *getFileName() const { return NULL; }
+    virtual void flush() {}
+};
+/** @} */
+#endif // TRES_NULLRESULTMANAGERS_HDR
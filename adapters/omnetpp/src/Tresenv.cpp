@@ -107,6 +107,12 @@ Tresenv::Tresenv()
     
     // init config variables that are used even before readOptions()
     opt_autoflush = true;
+
+    setupnetwork_done = false;
+    startrun_done = false;
+    finish_done = false;
+    network_type = NULL;
+    embedded = false;
 }
 
 Tresenv::~Tresenv()
@@ -238,6 +244,7 @@ void Tresenv::run()
     
     setupnetwork_done = false;
     startrun_done = false;
+    finish_done = false;
     
     ::fflush(fout);
     
@@ -253,6 +260,7 @@ void Tresenv::run()
     // find network
     cModuleType *network = resolveNetwork(opt_network_name.c_str());
     ASSERT(network);
+    network_type = network;
     
     // set up network
     ::fprintf(fout, "Setting up network `%s'...\n", opt_network_name.c_str());
@@ -265,7 +273,7 @@ void Tresenv::run()
     ::fprintf(fout, "Initializing...\n");
     ::fflush(fout);
     
-    disable_tracing = opt_expressmode;
+    disable_tracing = opt_expressmode || embedded;
     startRun();
     startrun_done = true;
     
@@ -319,15 +327,19 @@ void Tresenv::sim_step()
     deinstallSignalHandler();
 }
 
-void Tresenv::sim_stop()
+void Tresenv::finishRun()
 {
     disable_tracing = false;
     
     ::fflush(fout);
-    simulation.callFinish();
-    flushLastLine();
-    
-    checkFingerprint();
+    if (!finish_done)
+    {
+        simulation.callFinish();
+        flushLastLine();
+        
+        checkFingerprint();
+        finish_done = true;
+    }
     
     // call endRun()
     if (startrun_done)
@@ -340,8 +352,59 @@ void Tresenv::sim_stop()
         {
             displayException(e);
         }
+        startrun_done = false;
+    }
+}
+
+void Tresenv::restartRun(int runnumber)
+{
+    // close the current run and drop its module graph (OMNeT++ offers no
+    // way to re-initialize the modules of a network which already run)
+    finishRun();
+    if (setupnetwork_done)
+    {
+        simulation.deleteNetwork();
+        setupnetwork_done = false;
     }
     
+    // per-run state only: configuration variables, RNG seeds and
+    // result managers; ini files and libraries are already loaded, and
+    // the network type (with its NED declarations) is already resolved
+    cfg->activateConfig(opt_configname.c_str(), runnumber);
+    readPerRunOptions();
+    
+    setupNetwork(network_type);
+    setupnetwork_done = true;
+    
+    disable_tracing = opt_expressmode || embedded;
+    finish_done = false;
+    startRun();
+    startrun_done = true;
+}
+
+void Tresenv::sim_step_embedded()
+{
+    // The co-simulation drives time and termination: no clock,
+    // time limits, banners or signal handlers (tracing is already
+    // disabled for the whole run)
+    try
+    {
+        cSimpleModule *mod = simulation.selectNextModule();
+        if (!mod)
+            throw cTerminationException("scheduler interrupted while waiting");
+        simulation.doOneEvent(mod);
+    }
+    catch (std::exception& e)
+    {
+        stoppedWithException(e);
+        displayException(e);
+    }
+}
+
+void Tresenv::sim_stop()
+{
+    finishRun();
+    
     // delete network
     if (setupnetwork_done)
     {
@@ -353,6 +416,7 @@ void Tresenv::sim_stop()
         {
             displayException(e);
         }
+        setupnetwork_done = false;
     }
     shutdown();
 }
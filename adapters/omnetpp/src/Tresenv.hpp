@@ -52,6 +52,13 @@ protected:
     bool opt_perfdisplay; // if express mode
     bool setupnetwork_done;
     bool startrun_done;
+    bool finish_done;
+
+    // the network set up by run(), kept to set up the next runs
+    cModuleType *network_type;
+
+    // embedded mode: only step the scheduler (see sim_step_embedded())
+    bool embedded;
     
     // set to true on SIGINT/SIGTERM signals
     static bool sigint_received;
@@ -84,6 +91,17 @@ public:
     
     void sim_step();
     void sim_stop();
+
+    // embedded mode, for co-simulation: events are executed with no
+    // banners, status updates, time limit checks or signal handling
+    void setEmbedded(bool e) {embedded = e;}
+    bool isEmbedded() const {return embedded;}
+    void sim_step_embedded();
+
+    // warm reuse: close the current run, keeping configuration and
+    // loaded libraries, then set up and start a new one
+    void finishRun();
+    void restartRun(int runnumber = 0);
     
 protected:
     virtual void run();
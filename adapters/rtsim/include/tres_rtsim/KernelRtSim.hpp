@@ -24,10 +24,13 @@
 
 #ifndef TRES_KERNELRTSIM_HDR
 #define TRES_KERNELRTSIM_HDR
+#include <memory>
 #include <scheduler.hpp> // RTSim::Scheduler
 #include <texttrace.hpp> // RTSim::TextTrace
 #include <jtrace.hpp>    // RTSim::JavaTrace
+#include <tres/Arena.hpp>
 #include <tres/Kernel.hpp>
+#include <tres/KernelConfig.hpp>
 #include "../../src/EventRtSim.hpp"
 
 namespace tres
@@ -50,6 +53,11 @@ namespace tres
          */
         static tres::Kernel* createInstance(std::vector<std::string>&);
 
+        /**
+         * \brief Creator function (typed configuration)
+         */
+        static tres::Kernel* createInstance(const KernelConfig&);
+
         /**
          * \brief The destructor
          */
@@ -68,7 +76,11 @@ namespace tres
         virtual tres::RTOSEvent* getNextEvent();
 
         /**
-         * \brief Return the time of the next event in the RTSim event queue
+         * \brief Return the time of the next event of this kernel in the
+         * RTSim event queue
+         *
+         * \note The time is computed once per version of the shared event
+         * queue (see ActiveSimulationManagerRtSim::getQueueVersion())
          */
         virtual int getTimeOfNextEvent();
 
@@ -77,12 +89,26 @@ namespace tres
          */
         virtual int getNextWakeUpTime();
 
+        /**
+         * \brief Return the next wake-up time (cached, see \ref getTimeOfNextEvent())
+         */
+        virtual int getQuiescentHorizon() { return getTimeOfNextEvent(); }
+
         virtual void getRunningTasks();   
 
         virtual void activateAperiodicTasks(std::vector<int>&, int);
 
+        /**
+         * \brief Return the allocation counters of the arena holding the
+         * RTSim object graph of this kernel
+         */
+        const Arena::Stats& getArenaStats() const { return _arena.getStats(); }
+
     protected:
 
+        /** Arena holding the RTSim kernel, tasks and tracers */
+        Arena _arena;
+
         /** The base kernel representation in RTSim (Adaptee) */
         RTSim::RTKernel *_rts_kern;
 
@@ -100,6 +126,9 @@ namespace tres
         RTSim::ResManager *_rts_resMng;
         /** The (RTSim) task objects making the task set */
         std::vector<RTSim::Task*> _rts_tasks;
+        /** The tasks of the types built by the RTSim Task factory
+         * (the other ones live in the arena) */
+        std::vector<std::unique_ptr<RTSim::Task> > _factory_tasks;
         /**
          * @}
          */
@@ -111,6 +140,11 @@ namespace tres
          * \ref ActiveSimulationManagerRtSim singleton) */
         int _priority_level;
 
+        /** Cached next wake-up time, and the version of the event queue
+         * it was computed on (see \ref getTimeOfNextEvent()) */
+        int _nwut;
+        unsigned long long _nwut_version;
+
         /**
          * \name RTSim tracers (for debugging purposes)
          * @{
@@ -134,9 +168,9 @@ namespace tres
         KernelRtSim();
 
         /**
-         * \brief Construct from external parameters
+         * \brief Construct from a (validated) configuration
          */
-        KernelRtSim(const std::string&, const std::string&, const int, const std::vector<std::string>&);
+        KernelRtSim(const KernelConfig&);
 
         /** Helper function to initialize the priority level of the KernelRtSim
          * instance and the owned events and tasks */
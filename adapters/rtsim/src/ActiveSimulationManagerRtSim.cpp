@@ -28,6 +28,8 @@ namespace tres
 {
     ActiveSimulationManagerRtSim* ActiveSimulationManagerRtSim::_instance = NULL;
 
+    unsigned long long ActiveSimulationManagerRtSim::_queue_version = 1;
+
     ActiveSimulationManagerRtSim::ActiveSimulationManagerRtSim() : _priority_bias(50),
                                                         _max_priority_level(0),
                                                         _sim_ready(false)
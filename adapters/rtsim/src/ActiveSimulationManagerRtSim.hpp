@@ -107,6 +107,21 @@ namespace tres
          */
         bool kernelsReady();
 
+        /**
+         * \brief Get the version of the shared event queue
+         *
+         * \note The version changes whenever events may have been posted,
+         * dropped or processed, so kernels can cache what they read from
+         * the queue (see \ref touchQueue()). It is not reset by
+         * \ref reset(), so a cached value never matches a later queue
+         */
+        static unsigned long long getQueueVersion() { return _queue_version; }
+
+        /**
+         * \brief Signal that the shared event queue may have changed
+         */
+        static void touchQueue() { ++_queue_version; }
+
     private:
 
         /**
@@ -127,6 +142,9 @@ namespace tres
         /** The instance of active simulation manager */
         static ActiveSimulationManagerRtSim* _instance;
 
+        /** Version of the shared event queue (0 is never current) */
+        static unsigned long long _queue_version;
+
         /** Bias between priority levels (hardcoded for now) */
         int _priority_bias;
 
@@ -22,14 +22,16 @@
  * \file KernelRtSim.cpp
  */
 
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
 #include <exeinstr.hpp>  // TODO: RTSim must manage instructions priorities 
+#include <rttask.hpp>    // RTSim::Task, RTSim::PeriodicTask
+#include <randomvar.hpp> // MetaSim::DeltaVar
 #include <rmsched.hpp>   // RTSim::RMScheduler (does not have a creator fct)
 #include <mrtkernel.hpp> // RTSim::MRTKernel
 #include <tres/Factory.hpp>
-#include <tres/ParseUtils.hpp>
 #include <tres_rtsim/KernelRtSim.hpp>
 #include "ActiveSimulationManagerRtSim.hpp"
 
@@ -67,87 +69,111 @@ namespace tres
         _next_event._gen_task._priority_level = _priority_level;
     }
 
-    KernelRtSim::KernelRtSim(const std::string& kuid, const std::string& sp_descr, const int num_cores, const std::vector<std::string>& ts_descr)
+    /** Convert a time (in the model time unit) to a number of RTSim ticks */
+    static long long toTicks(double t, double time_resolution)
+    {
+        return std::llround(t * time_resolution);
+    }
+
+    KernelRtSim::KernelRtSim(const KernelConfig& conf)
     {
         // Give the instance the UID provided by the caller and
         // Initialize the priority level to identify the related events
         // (of tasks, scheduling, instructions, ...) in the MetaSim queue
-        _kernel_name = kuid;
+        _kernel_name = conf.name;
         initializePriorityLevel();
 
-        using namespace tres_parse_utils;
-
-        // Get the sched. policy description parameters
-        std::vector<std::string> sp_parms = split_instr(sp_descr);
+        // No next wake-up time cached yet
+        _nwut = 0;
+        _nwut_version = 0;
 
-        // Build a suitable parameter vector for use with the factory
-        std::vector<std::string> sp_fact(sp_parms.begin()+1, sp_parms.end());
+        // Random variables built from now on draw from
+        // the generator of the configuration (if any)
+        conf.selectGenerator();
 
         // **Build instance** (the RTSim::Scheduler)
+        //
+        // Convert the "abstract" policy into the RTSim equivalent
+        const SchedulerConfig& sp = conf.scheduler;
+        std::vector<std::string> sp_fact(sp.params);
         std::unique_ptr<RTSim::Scheduler> rts_sched;
-        if (sp_parms[0] == "DEADLINE_MONOTONIC")
+        if (sp.policy == "DEADLINE_MONOTONIC")
             // A deadline monotonic scheduler is built
             // without using the factory, since the class that
             // represents it does not have a creator function
             rts_sched = std::unique_ptr<RTSim::Scheduler>(new RTSim::RMScheduler());
+        else if (sp.policy == "EDF")
+            rts_sched = Factory<RTSim::Scheduler>::instance().create("EDFSched", sp_fact);
+        else if (sp.policy == "FIXED_PRIORITY")
+            rts_sched = Factory<RTSim::Scheduler>::instance().create("FPSched", sp_fact);
         else
-            rts_sched = Factory<RTSim::Scheduler>::instance().create(sp_parms[0], sp_fact);
-        if (rts_sched.get() == NULL) throw std::runtime_error(sp_parms[0]);
+            // Keep the sched. policy type as is.
+            rts_sched = Factory<RTSim::Scheduler>::instance().create(sp.policy, sp_fact);
+        if (rts_sched.get() == NULL) throw std::runtime_error(sp.policy);
         _rts_sched = rts_sched.release();
 
         // **Build instance** (the RTSim Kernel, single-/multi-core)
-        if (num_cores > 1)
-            _rts_kern = new RTSim::MRTKernel(_rts_sched, num_cores);
+        if (conf.num_cores > 1)
+            _rts_kern = _arena.create<RTSim::MRTKernel>(_rts_sched, conf.num_cores);
         else
-            _rts_kern = new RTSim::RTKernel(_rts_sched);
+            _rts_kern = _arena.create<RTSim::RTKernel>(_rts_sched);
         _rts_kern->setEvtPriorityLevel(_priority_level);
 
         // **Build instances** (the RTSim Tracers)
+        //
+        // Kernel, tracers and tasks live in the arena of the kernel
         std::stringstream ss;
         ss << "trace-" << _priority_level << ".txt";
-        ttrace = new RTSim::TextTrace(ss.str());
+        ttrace = _arena.create<RTSim::TextTrace>(ss.str());
         ss.str(std::string());  // Flush the ss
         ss << "trace-" << _priority_level << ".trc";
-        jtrace = new RTSim::JavaTrace(ss.str().c_str());
+        jtrace = _arena.create<RTSim::JavaTrace>(ss.str().c_str());
         ss.str(std::string());  // Flush the ss
 
-        // Manage tasks in the task-set
+        // Manage tasks in the task-set.
+        //
+        // The descriptors have already been parsed by tres::KernelConfig;
+        // RTSim tasks are built here, serially, since MetaSim entities
+        // register themselves in process-wide tables upon construction
+        _rts_tasks.reserve(conf.tasks.size());
         int aper_req_idx = 0;
-        for (std::vector<std::string>::size_type i = 0; i < ts_descr.size(); i++)
+        for (std::vector<TaskConfig>::size_type i = 0; i < conf.tasks.size(); i++)
         {
-            // Get the task-set description parameters
-            //
-            // It is _guaranteed_ that the parameters in the i-th
-            // entry of the ts_descr vector (which is provided by the caller)
-            // are in the following order
-            //   - type (e.g., 'PeriodicTask', etc.)
-            //   - name
-            //   - iat  (InterArrival Time)
-            //   - rdl  (Relative DeadLine)
-            //   - ph   (activation PHase)
-            //
-            // The order of name, iat, rdl and ph matches the one required by the
-            // RTSim Task creator function. Hence, the parameters can be given
-            // in that order to the creator function (see below).
-            //
-            std::vector<std::string> ts_parms = split_instr(ts_descr[i]);
-
-            // Get the task name
-            std::stringstream ss;
-            ss << ts_parms[1];
+            const TaskConfig& tc = conf.tasks[i];
 
-            // Build a suitable parameter vector for use with the factory
-            std::vector<std::string> ts_fact(ts_parms.begin()+2, ts_parms.begin()+5);
-
-            // Add the task name currently stored in the stringstream.
-            // (This is required by the RTSim Task creator function)
-            ts_fact.push_back(ss.str());
+            // Timing parameters (scaled by the time resolution)
+            MetaSim::Tick rdl(toTicks(tc.rdl, conf.time_resolution));
+            MetaSim::Tick ph(toTicks(tc.ph, conf.time_resolution));
 
             // **Build instance** (the RTSim Task)
-            std::unique_ptr<RTSim::Task> task = Factory<RTSim::Task>::instance()
-                                                    .create( ts_parms[0], ts_fact );
-            if (task.get() == NULL) throw std::runtime_error(ts_parms[0]);
-            RTSim::Task *tsk = task.release();
+            //
+            // Aperiodic tasks are RTSim::Task objects, activated
+            // by the kernel upon request (see activateAperiodicTasks());
+            // a non-null IAT models a sporadic task. The other types
+            // (e.g., registered by users) are built by the factory, from
+            // iat, rdl, ph (in ticks) and name
+            RTSim::Task *tsk;
+            if (tc.isAperiodic())
+            {
+                MetaSim::RandomVar *iat = NULL;
+                if (tc.iat != 0)
+                    iat = new MetaSim::DeltaVar(toTicks(tc.iat, conf.time_resolution));
+                tsk = _arena.create<RTSim::Task>(iat, rdl, ph, tc.name);
+            }
+            else if (tc.type == "PeriodicTask")
+                tsk = _arena.create<RTSim::PeriodicTask>(MetaSim::Tick(toTicks(tc.iat, conf.time_resolution)), rdl, ph, tc.name);
+            else
+            {
+                std::vector<std::string> ts_fact;
+                ts_fact.push_back(std::to_string(toTicks(tc.iat, conf.time_resolution)));
+                ts_fact.push_back(std::to_string(toTicks(tc.rdl, conf.time_resolution)));
+                ts_fact.push_back(std::to_string(toTicks(tc.ph, conf.time_resolution)));
+                ts_fact.push_back(tc.name);
+                std::unique_ptr<RTSim::Task> task = Factory<RTSim::Task>::instance().create(tc.type, ts_fact);
+                if (task.get() == NULL) throw std::runtime_error(tc.type);
+                tsk = task.get();
+                _factory_tasks.push_back(std::move(task));
+            }
 
             // TODO
             // The following lines shouldn't be here. Managing the priority of an
@@ -166,24 +192,24 @@ namespace tres
             tsk->setTrace(jtrace);
 
             // Register the task/port correspondency
-            _task_port_map[ss.str()] = i;
+            _task_port_map[tc.name] = i;
 
             // Register the correspondency between
             // aperiodic-activation request index
             // and task (if any)
-            if (ts_parms[0] == "Task")
-                // AperiodicTask
+            if (tc.isAperiodic())
                 _aper_req_task_map[aper_req_idx++] = i;
 
             // Initialize the flags of Job's status (default 0)
-            _jobs_status[ss.str()] = 0;
+            _jobs_status[tc.name] = 0;
 
             // Add the task to the RTSim scheduler/kernel, with priority (if any).
-            // The priority is only considered when a task is attached to
-            // a FPSched Scheduler; in all the other cases it's ignored
+            // The priority (the first further parameter, given to RTSim as is)
+            // is only considered when a task is attached to a FPSched
+            // Scheduler; in all the other cases it's ignored
             std::string tsk_prio("");
-            if (ts_parms.size() > 5)
-                tsk_prio = ts_parms[5];
+            if (!tc.params.empty())
+                tsk_prio = tc.params[0];
             _rts_kern->addTask(*tsk, tsk_prio);
 
             // Add the task to the list of handled tasks
@@ -193,12 +219,12 @@ namespace tres
 
     KernelRtSim::~KernelRtSim() noexcept(true)
     {
-        for (unsigned int i = 0; i < _rts_tasks.size(); i++)
-            delete _rts_tasks[i];
+        // The tasks built by the factory go first; then tasks, tracers
+        // and kernel are destroyed in reverse order of construction.
+        // The scheduler (built by the factory) is only used by the kernel
+        _factory_tasks.clear();
+        _arena.release();
         delete _rts_sched;
-        delete _rts_kern;
-        delete ttrace;
-        delete jtrace;
         ActiveSimulationManagerRtSim::getInstance().registerKernel(getName());
         if ( ActiveSimulationManagerRtSim::getInstance().kernelsReady() )
         {
@@ -209,129 +235,36 @@ namespace tres
 
     tres::Kernel* KernelRtSim::createInstance(std::vector<std::string>& par)
     {
-        // The input information for this function is _guaranteed to have the following form:
-        //  - the number of tasks in the task-set (#tasks) - std::string (1)      <-- vector.begin()
-        //  - the task-set description                     - std::string (#tasks)
-        //  - the scheduling policy description            - std::string (1)
-        //  - the number of CPU cores                      - std::string (1)
-        //  - the time resolution                          - std::string (1)
-        //  - the name (UID) of the kernel instance        - std::string (1)
-        //                                                                        <-- vector.end()
-        using namespace tres_parse_utils;
-        std::vector<std::string>::iterator it;  // Convenience iterator
-
-        // Get the number of tasks
-        int num_tasks = atoi(par[0].c_str());
-
-        // Get the instance UID
-        std::string kuid = *(par.end() - 1);
-
-        // Get the time resolution
-        it = par.end() - 2;
-        double time_resolution = atof((*it).c_str());
-
-        // Modify the task-set description
-        // (according to the time resolution and tasks' type)
-        std::vector<std::string> mod_ts_descr;
-        for (int i = 0; i < num_tasks; i++)
-        {
-            std::stringstream ss;
-
-            // Get the task-set description parameters
-            std::vector<std::string> ts_parms = split_instr(par[1+i]);
-
-            // Check (and eventually convert) the task type
-            if (ts_parms[0] == "AperiodicTask")
-                // Convert the task type so that it's compatible with RTSim
-                ss << "Task;";
-            else
-                // Keep the task type as is
-                ss << ts_parms[0] << ';';
-
-            // ts_parms[1] is the NAME -- DON'T MODIFY (Keep the task name as is)
-            ss << ts_parms[1] << ';';
-
-            // Modify IAT
-            ss << time_resolution*atof(ts_parms[2].c_str()) << ';';
-
-            // Modify RDL
-            ss << time_resolution*atof(ts_parms[3].c_str()) << ';';
-
-            // Modify OFFSET
-            ss << time_resolution*atof(ts_parms[4].c_str()) << ';';
-
-            // Keep the rest as is
-            for (std::vector<std::string>::size_type j = 5; j < ts_parms.size(); j++)
-                ss << ts_parms[j] << ';';
-
-            mod_ts_descr.push_back(ss.str());
-        }
-
-        // Now point to the sched policy description given by the caller
-        it = par.begin() + 1 + num_tasks;
-
-        // Get the sched. policy description parameters
-        std::vector<std::string> sp_parms = split_instr(*it);
-
-        // Convert the "abstract" policy into the RTSim equivalent
-        std::stringstream ss;   // Convenience stringstream
-        if (sp_parms[0] == "EDF")
-            ss << "EDFSched;";
-        else if (sp_parms[0] == "FIXED_PRIORITY")
-            ss << "FPSched;";
-        else
-            // Keep the sched. policy type as is.
-            // This also holds for "DEADLINE_MONOTONIC",
-            // which does not have a creator function
-            ss << sp_parms[0] << ';';
-
-        // Keep the rest (if any) as is
-        for (std::vector<std::string>::size_type j = 1; j < sp_parms.size(); j++)
-            ss << sp_parms[j] << ';';
-
-        // Create a scheduling policy description that is
-        // suitable for use with RTSim
-        std::string sp_descr = ss.str();
-        ss.str(std::string());  // Flush the ss
-
-        // Get the number of CPU cores
-        int num_cores = atoi( (*(++it)).c_str() );
+        // The string form of the configuration is just an input adapter
+        // (tres::KernelConfig::fromStrings() also validates it)
+        return new KernelRtSim(KernelConfig::fromStrings(par));
+    }
 
-        // Finally, construct the object
-        return new KernelRtSim(kuid, sp_descr, num_cores, mod_ts_descr);
+    tres::Kernel* KernelRtSim::createInstance(const KernelConfig& conf)
+    {
+        conf.validate();
+        return new KernelRtSim(conf);
     }
 
     void KernelRtSim::initializeSimulation(const double time_resolution, const double * const *c_time)
     {
-        for (auto task = _rts_tasks.begin();
-                    task != _rts_tasks.end();
-                        ++task)
+        // Tasks are stored in port order (see the constructor)
+        for (std::vector<RTSim::Task*>::size_type i = 0; i < _rts_tasks.size(); i++)
         {
-            std::stringstream ss;
-            ss << "fixed(" << time_resolution*( **(c_time + _task_port_map[(*task)->getName()]) ) << ");";
-
-            // Add the pseudoinstruction to the task's instruction_q
-            (*task)->insertCode(ss.str());
+            // Add the pseudoinstruction to the task's instruction_q.
+            // The instruction is built directly (rather than formatting
+            // "fixed(...);" and having insertCode() parse it back), which
+            // also keeps the full precision of the execution time
+            RTSim::Task *tsk = _rts_tasks[i];
+            RTSim::FixedInstr *rts_fi = new RTSim::FixedInstr(tsk, MetaSim::Tick(toTicks(*c_time[i], time_resolution)));
+            tsk->addInstr(rts_fi);
 
             // TODO
             // The following lines shouldn't be here. Managing the priority of an
-            // added instruction should be taken into account by RTSim (insertCode())
+            // added instruction should be taken into account by RTSim (addInstr())
             if (_priority_level > 0)
-            {
-                auto p = (*task)->getInstrQueue().end() - 1;
-                if ( dynamic_cast<RTSim::ExecInstr*>(*p) )
-                {
-                    RTSim::ExecInstr* rts_ei = dynamic_cast<RTSim::ExecInstr*>(*p);
-                    rts_ei->_endEvt.setPriority(_priority_level + rts_ei->_endEvt.getPriority());
-                }
-                // XXX
-                // Is RTSim::ExecInstr the only kind of instruction with events
-                // to be managed with priorities?
-            }
+                rts_fi->_endEvt.setPriority(_priority_level + rts_fi->_endEvt.getPriority());
             ////////////////////////////////////////////////////////////////////
-
-            // Flush the stream...
-            ss.str(std::string());
         }
 
         ActiveSimulationManagerRtSim::getInstance().registerKernel(getName());
@@ -342,11 +275,13 @@ namespace tres
             MetaSim::Simulation::getInstance().initRuns();
             MetaSim::Simulation::getInstance().initSingleRun();
         }
+        ActiveSimulationManagerRtSim::touchQueue();
     }
 
     void KernelRtSim::processNextEvent()
     {
         MetaSim::Simulation::getInstance().sim_step();
+        ActiveSimulationManagerRtSim::touchQueue();
     }
 
     tres::RTOSEvent* KernelRtSim::getNextEvent()
@@ -357,15 +292,16 @@ namespace tres
 
     int KernelRtSim::getTimeOfNextEvent()
     {
-        // FIXME
-        // Searching for the NextWakeUpTime (NWUT) here is terribly inefficient!
-        // Design a mechanism to search for the NWUT one time and store it, so
-        // that subsequent requests can be accommodate immediately
-        MetaSim::Event* ms_evt = MetaSim::Event::getFirst();
-        if ( (ms_evt->getPriority() < _priority_level) ||
-                (ms_evt->getPriority() >= _priority_level+50) )
-            return getNextWakeUpTime();
-        return ms_evt->getTime();
+        // Search for the NextWakeUpTime (NWUT) only once per version of the
+        // shared queue: every kernel posts or processes events through
+        // calls that bump the version
+        unsigned long long version = ActiveSimulationManagerRtSim::getQueueVersion();
+        if (_nwut_version != version)
+        {
+            _nwut = getNextWakeUpTime();
+            _nwut_version = version;
+        }
+        return _nwut;
     }
 
     int KernelRtSim::getNextWakeUpTime()
@@ -444,5 +380,6 @@ namespace tres
                                               // It has already been done during task
                                               // allocation in the c'tor
         }
+        ActiveSimulationManagerRtSim::touchQueue();
     }
 }
@@ -22,7 +22,6 @@
  * \file SimTaskRtSim.cpp
  */
 
-#include <sstream>          // std::stringstream
 #include <vector>
 #include <instr.hpp>        // getActInstr()
 #include <exeinstr.hpp>     // TODO: RTSim must manage instructions priorities
@@ -49,57 +48,44 @@ namespace tres
     void SimTaskRtSim::discardInstructions()
     {
         _rts_task->discardInstrs();
+        ActiveSimulationManagerRtSim::touchQueue();
     }
 
     void SimTaskRtSim::addInstruction(int duration)
     {
         // Transform the given instruction duration in
         // *one* fixed computation-time RTSim pseudoinstruction
-        std::stringstream ss;
-        ss << "fixed(" << duration << ");";
+        // (built directly, rather than formatted and parsed by insertCode())
+        RTSim::FixedInstr *rts_fi = new RTSim::FixedInstr(_rts_task, MetaSim::Tick(duration));
 
         // Check if task is empty
         bool was_empty = isEmpty();
 
         // Add the pseudoinstruction to the task's instruction_q
-        _rts_task->insertCode(ss.str());
-        std::vector<RTSim::Instr*>::iterator it;
+        // (the task takes its ownership)
+        _rts_task->addInstr(rts_fi);
 
-        // If task was empty
+        // If task was empty, make actInstr to actually point that instruction
         if (was_empty)
-        {
-            // Make actInstr to actually point that instruction
             _rts_task->resetInstrQueue();
-            it = _rts_task->getActInstr();
-        }
-        else
-            it = (_rts_task->getActInstr())+1;
 
         // Initialize the pseudoinstruction. Needed!
         // (because flag is left uninitialized in the ExecInstr() constructor)
-        (*(it))->reset();
+        rts_fi->reset();
 
         // TODO
         // The following lines shouldn't be here. Managing the priority of an
-        // added instruction should be taken into account by RTSim (insertCode())
+        // added instruction should be taken into account by RTSim (addInstr())
         //
         // Take care to not reset priority levels in reset()!
-        if ( dynamic_cast<RTSim::ExecInstr*>(*it) )
-        {
-            RTSim::ExecInstr* rts_ei = dynamic_cast<RTSim::ExecInstr*>(*it);
-            int evt_priority = rts_ei->_endEvt.getPriority();
-            int priority_bias = ActiveSimulationManagerRtSim::getInstance().getPriorityBias();
-            if ( !((evt_priority >= _priority_level) &&
-                      (evt_priority < priority_bias+_priority_level)) )
-                rts_ei->_endEvt.setPriority(_priority_level + evt_priority);
-        }
-        // XXX
-        // Is RTSim::ExecInstr the only kind of instruction with events
-        // to be managed with priorities?
+        int evt_priority = rts_fi->_endEvt.getPriority();
+        int priority_bias = ActiveSimulationManagerRtSim::getInstance().getPriorityBias();
+        if ( !((evt_priority >= _priority_level) &&
+                  (evt_priority < priority_bias+_priority_level)) )
+            rts_fi->_endEvt.setPriority(_priority_level + evt_priority);
         ////////////////////////////////////////////////////////////////////////
 
-        // Clear the stringstream
-        ss.str(std::string());
+        ActiveSimulationManagerRtSim::touchQueue();
     }
 
     void SimTaskRtSim::setAdapteePtr(RTSim::Task* rts_task)
@@ -0,0 +1,279 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CanAnalysis.hpp
+ */
+
+#ifndef TRES_CANANALYSIS_HDR
+#define TRES_CANANALYSIS_HDR
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <tres/ParseUtils.hpp>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_analysis
+     * @{
+     */
+
+    /**
+     * \brief Exception raised for message-sets that cannot be analyzed
+     */
+    DECL_EXC(CanAnalysisExc, "CanAnalysis");
+
+    /**
+     * \brief Worst-case response times of the frames of a CAN bus
+     *
+     * The bus is described as for the networks of the co-simulation: the
+     * message-set description (one "type;uid;...;" row per message) and the
+     * network description. As in tres::NetworkCanNative, the uid is the
+     * identifier (in hexadecimal) and the further columns of a row give the
+     * timing of the message:
+     *  - "type;uid;[period;[dlc;[node;[offset;[jitter;]]]]]"
+     *
+     * and the network items "bitrate", "stuffing", "txqueue", "errors" and
+     * "message" are read (the others are ignored). The rows of the OMNeT++
+     * adapter have no period: unless given one by a "message" item, such
+     * messages are bounded (with the messages of lower priority) once given
+     * a period by setPeriod().
+     *
+     * The analysis is the one of Davis, Burns, Bril and Lukkien (2007), with
+     * queuing jitter: frames have the largest number of stuff bits (unless
+     * "stuffing;none;"), are blocked by the longest frame of lower priority,
+     * and the response time of a message is the largest one among the
+     * instances in its level-m busy period. The response time is measured
+     * from the start of the period (i.e., it includes the queuing jitter).
+     * Offsets are ignored (the worst-case phasing is assumed), the deadlines
+     * are the periods unless given by setDeadline(), and sporadic errors
+     * ("errors;sporadic:<interval>;") cost an error frame and the
+     * retransmission of the longest frame of higher or equal priority each
+     * (Tindell and Burns). Messages are not bounded for FIFO transmit queues
+     * and random errors.
+     *
+     * Times are converted to ticks as tres::NetworkCanNative does, so that
+     * the bounds hold for its simulations. The timing of a message can be
+     * changed, and messages added, one at a time: the next analysis only
+     * recomputes the messages the change can affect (the ones of lower
+     * priority, and the ones whose blocking changed), starting from the
+     * previous busy windows when the demand has grown.
+     */
+    class CanAnalysis
+    {
+
+    public:
+
+        /** Outcome of an analysis */
+        enum Verdict { SCHEDULABLE, UNSCHEDULABLE, UNKNOWN };
+
+        /** Response time of a message with an unbounded response time */
+        static const long long UNBOUNDED = LLONG_MAX;
+
+        /** Response time of a message which has not been bounded */
+        static const long long NOT_BOUNDED = -1;
+
+        /**
+         * \brief Construct from the message-set and the network descriptions
+         *
+         * \throw CanAnalysisExc if a description is invalid
+         */
+        CanAnalysis(const std::vector<std::string> &msgs, const std::vector<std::string> &ndescr, double time_resolution);
+
+        /**
+         * \brief Construct from the parameters of a network (as given to
+         * the Factory Method of the networks)
+         */
+        explicit CanAnalysis(const std::vector<std::string> &par);
+
+        /**
+         * \brief Analyze the message-set (the messages changed since the
+         * last analysis)
+         */
+        Verdict analyze();
+
+        /**
+         * \brief Verdict of the last analysis
+         *
+         * SCHEDULABLE if every message meets its deadline, UNSCHEDULABLE if
+         * the bus is overloaded, UNKNOWN otherwise.
+         */
+        Verdict getVerdict() const { return _verdict; }
+
+        /**
+         * \brief Worst-case response time of a message (ticks), from the
+         * last analysis
+         *
+         * It is measured from the start of the period, hence it also bounds
+         * the time from the queuing to the reception.
+         */
+        long long getResponseTime(std::size_t msg) const { return _msgs[msg].r; }
+
+        /**
+         * \brief Worst-case duration of a frame of a message (ticks)
+         */
+        long long getFrameTime(std::size_t msg) const { return _msgs[msg].c; }
+
+        /**
+         * \brief Utilization of the bus (of the messages with a period)
+         */
+        double getUtilization() const;
+
+        /**
+         * \brief Number of messages, and their identifiers (the uid of the
+         * message-set description)
+         */
+        std::size_t getNumberOfMessages() const { return _msgs.size(); }
+        const std::string& getUID(std::size_t msg) const { return _msgs[msg].uid; }
+
+        /**
+         * \brief Add a message (a row of the message-set description)
+         *
+         * \return the index of the message
+         */
+        std::size_t addMessage(const std::string &row);
+
+        /**
+         * \brief Change the period, the queuing jitter, the relative
+         * deadline and the number of data bytes of a message
+         */
+        void setPeriod(std::size_t msg, double period);
+        void setJitter(std::size_t msg, double jitter);
+        void setDeadline(std::size_t msg, double deadline);
+        void setDlc(std::size_t msg, int dlc);
+
+        /**
+         * \brief Write the bounds of the last analysis, and compare them
+         * with the largest response times observed in a simulation
+         *
+         * \param observed are the largest response times (ticks, from the
+         * start of the period to the reception, as counted by
+         * tres::NetworkCanNative) in the order of the messages; missing or negative for messages not
+         * simulated. Times are written in the time unit of the model.
+         *
+         * \return the number of messages observed beyond their bound
+         */
+        std::size_t report(std::ostream &os, const std::vector<long long> &observed = std::vector<long long>()) const;
+
+    private:
+
+        /** A message (times in ticks) */
+        struct _Message
+        {
+            std::string uid;
+            uint32_t id;
+            bool extended;
+            int dlc;
+
+            /** Arbitration key (lower value, higher priority) */
+            uint64_t key;
+
+            /** Frame duration, period (0 if not given), jitter and deadline */
+            long long c, t, j, d;
+            bool has_deadline;
+
+            /** Position in the priority order */
+            std::size_t pos;
+
+            /** Blocking, and cost of an error (from the last analysis) */
+            long long b, e;
+
+            /** Response-time bound, and the level-m busy period and busy
+             * window of the first instance it was computed with */
+            long long r, busy, w0;
+
+            /** Whether the response time must be computed again */
+            bool dirty;
+        };
+
+        /** Parse the network description */
+        void parseNetwork(const std::vector<std::string> &ndescr);
+
+        /** Parse a row of the message-set description */
+        _Message parseMessage(const std::string &row) const;
+
+        /** Convert a time to ticks */
+        long long toTicks(double t) const;
+
+        /** Duration (ticks) of a number of bits */
+        long long bitsToTicks(long long bits) const;
+
+        /** Worst-case duration of a frame (ticks) */
+        long long frameTime(bool extended, int dlc) const;
+
+        /** Mark the messages from a priority position for analysis */
+        void touch(std::size_t pos, bool grow);
+
+        /** Cost of the errors in an interval (ticks) */
+        long long errors(long long t, long long e) const;
+
+        /** Response time of the message at a priority position */
+        long long response(_Message &m, bool warm) const;
+
+        double _time_resolution;
+        double _bitrate;
+        bool _stuffing;
+        bool _fifo;
+        bool _random_errors;
+        long long _error_interval;
+
+        /** Duration of a bit and of an error frame (ticks) */
+        long long _bit;
+        long long _error_frame;
+
+        /** The parameters of the "message" items, by uid */
+        std::map<std::string, std::vector<std::string> > _params;
+
+        std::vector<_Message> _msgs;
+
+        /** The messages, by decreasing priority */
+        std::vector<uint32_t> _order;
+
+        /** The first priority position to analyze, and whether the
+         * changes since the last analysis only increased the demand */
+        std::size_t _from_pos;
+        bool _grow;
+
+        Verdict _verdict;
+    };
+
+    /** @} */
+}
+
+#endif // TRES_CANANALYSIS_HDR
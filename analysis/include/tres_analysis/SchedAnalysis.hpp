@@ -0,0 +1,333 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file SchedAnalysis.hpp
+ */
+
+#ifndef TRES_SCHEDANALYSIS_HDR
+#define TRES_SCHEDANALYSIS_HDR
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tres/KernelConfig.hpp>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_analysis
+     * @{
+     */
+
+    /**
+     * \brief Exception raised for task-sets that cannot be analyzed
+     */
+    DECL_EXC(SchedAnalysisExc, "SchedAnalysis");
+
+    /**
+     * \brief Timing of a task that is not part of the kernel configuration
+     * (in the time unit of the model)
+     */
+    struct TaskTiming
+    {
+        /** Worst-case execution time of a job */
+        double wcet;
+
+        /** Release jitter */
+        double jitter;
+
+        /** Worst-case blocking time (on shared resources) */
+        double blocking;
+
+        TaskTiming(double c = 0, double j = 0, double b = 0) : wcet(c), jitter(j), blocking(b) {}
+    };
+
+    /**
+     * \brief Analytical schedulability tests of a task-set
+     *
+     * The task-set is described by the same tres::KernelConfig given to the
+     * kernels, plus the timing of each task (WCET, jitter, blocking; see
+     * getWCET() to compute the WCET from the body of a task). Times are
+     * converted to ticks as the kernels do. The platform follows the
+     * conventions of tres::KernelNative: the scheduling parameters
+     * "partitioned", "global" and "clustered:<n>" split the cores into
+     * clusters, and tasks with no core are assigned round-robin or packed
+     * by utilization ("ffd", "wfd").
+     *
+     * Each cluster is analyzed on its own:
+     *  - one core, fixed priorities ("FIXED_PRIORITY", "DEADLINE_MONOTONIC",
+     *    "RATE_MONOTONIC"): response-time analysis with release jitter and
+     *    blocking, for arbitrary deadlines (Tindell et al.);
+     *  - one core, "EDF": processor-demand test with jitter and blocking,
+     *    by Quick Processor-demand Analysis (Zhang and Burns);
+     *  - several cores, fixed priorities: the sufficient response-time
+     *    analysis of Bertogna and Cirinei;
+     *  - several cores, "EDF": the sufficient density test of Goossens,
+     *    Funk and Baruah.
+     *
+     * A task-set is SCHEDULABLE if no deadline can be missed, and
+     * UNSCHEDULABLE if a deadline miss is certain when jobs take their WCET,
+     * with no jitter and no blocking (which are only bounds) and synchronous
+     * activations: the utilization of a cluster exceeds its cores, a WCET
+     * exceeds its deadline, or an exact test fails without jitter and
+     * blocking. Otherwise, e.g. when a sufficient test fails, when a miss
+     * depends on the jitter or on the blocking, for aperiodic tasks and for
+     * non-preemptive policies, it is UNKNOWN. A task-set which is not
+     * SCHEDULABLE is worth a simulation only if it is UNKNOWN.
+     *
+     * The parameters of the tasks can be changed one at a time: the next
+     * analysis only recomputes what the change can affect, i.e., the
+     * cluster of the task and, for fixed priorities on one core, the tasks
+     * with a priority not higher than the changed one (starting from the
+     * previous response times when the demand has grown). screen()
+     * evaluates many candidate WCET assignments at once.
+     */
+    class SchedAnalysis
+    {
+
+    public:
+
+        /** Outcome of an analysis */
+        enum Verdict { SCHEDULABLE, UNSCHEDULABLE, UNKNOWN };
+
+        /** Response time of a task with an unbounded response time */
+        static const long long UNBOUNDED = LLONG_MAX;
+
+        /** Response time of a task which has not been bounded */
+        static const long long NOT_BOUNDED = -1;
+
+        /**
+         * \brief Constructor
+         *
+         * \param conf is the (validated) kernel configuration
+         * \param timing is the timing of the tasks, in the order of conf.tasks
+         * \throw SchedAnalysisExc if the timing does not match the task-set
+         */
+        SchedAnalysis(const KernelConfig &conf, const std::vector<TaskTiming> &timing);
+
+        /**
+         * \brief Analyze the task-set (the clusters changed since the last analysis)
+         */
+        Verdict analyze();
+
+        /**
+         * \brief Verdict of the last analysis
+         */
+        Verdict getVerdict() const { return _verdict; }
+
+        /**
+         * \brief Verdict of the last analysis for a cluster
+         */
+        Verdict getClusterVerdict(std::size_t cluster) const { return _clusters[cluster].verdict; }
+
+        /**
+         * \brief Response-time bound of a task (ticks), from the last analysis
+         *
+         * Only the fixed-priority analyses bound response times; for tasks
+         * missing their deadline, the bound may just be some value larger
+         * than the deadline.
+         */
+        long long getResponseTime(std::size_t task) const { return _tasks[task].r; }
+
+        /**
+         * \brief Number of clusters, and the cluster of a task
+         */
+        std::size_t getNumberOfClusters() const { return _clusters.size(); }
+        int getCluster(std::size_t task) const { return _tasks[task].cluster; }
+
+        /**
+         * \brief Change the timing of a task
+         */
+        void setTiming(std::size_t task, const TaskTiming &timing);
+
+        /**
+         * \brief Change the inter-arrival time of a task
+         */
+        void setPeriod(std::size_t task, double iat);
+
+        /**
+         * \brief Change the relative deadline of a task
+         */
+        void setDeadline(std::size_t task, double rdl);
+
+        /**
+         * \brief Change the (fixed) priority of a task
+         */
+        void setPriority(std::size_t task, int priority);
+
+        /**
+         * \brief Evaluate candidate WCET assignments of the task-set
+         *
+         * The WCET of task i in candidate c is wcet[i * candidates + c] (the
+         * candidates of a task are contiguous). Utilization and density
+         * bounds are evaluated first for all the candidates at once, in
+         * branch-free loops over the candidates that the compiler can
+         * vectorize; only the candidates they leave undecided are analyzed,
+         * one after the other (incrementally). The jitter and blocking of the
+         * tasks are the current ones; the state of the analysis is unchanged.
+         */
+        void screen(const double *wcet, std::size_t candidates, Verdict *out) const;
+
+        /**
+         * \brief Pre-filter for simulation campaigns: the verdict of a
+         * configuration (UNKNOWN if the task-set cannot be analyzed)
+         */
+        static Verdict prescreen(const KernelConfig &conf, const std::vector<TaskTiming> &timing);
+
+        /**
+         * \brief Worst-case execution time of a task body (the pseudo
+         * instructions given to tres::Task)
+         *
+         * \throw RandomVar::MaxException if the duration of an instruction is
+         * not bounded
+         */
+        static double getWCET(const std::vector<std::string> &body);
+
+    private:
+
+        /** Scheduling policies */
+        enum Policy { FP, DM, RM, EDF, OTHER };
+
+        /** Bin-packing heuristics */
+        enum Packing { PACK_NONE, PACK_FFD, PACK_WFD };
+
+        /** A task (times in ticks) */
+        struct _Task
+        {
+            long long c, t, d, j, b, ph;
+
+            /** Configured priority, whether it was given, and the
+             * default one (the index of the task) */
+            int prio;
+            bool has_prio;
+            long long prio_index;
+
+            /** Whether the task is activated by requests only */
+            bool aperiodic;
+
+            /** Priority key (lower value, higher priority) */
+            long long key;
+
+            int cluster;
+            bool pinned;
+
+            /** Response-time bound, and busy window of the first job
+             * (fixed priorities on one core) */
+            long long r;
+            long long w0;
+        };
+
+        /** A cluster of cores */
+        struct _Cluster
+        {
+            int cores;
+
+            /** The tasks, by decreasing priority (then by index) */
+            std::vector<uint32_t> tasks;
+
+            /** Whether the cluster must be analyzed again, the lowest key
+             * affected by the changes (fixed priorities), and whether the
+             * changes only increased the demand */
+            bool dirty;
+            long long from_key;
+            bool grow;
+
+            /** Whether the response times of the tasks were computed by
+             * the last analysis */
+            bool valid;
+
+            Verdict verdict;
+        };
+
+        /** Convert a time to ticks */
+        long long toTicks(double t) const;
+
+        /** Priority key of a task */
+        long long keyOf(const _Task &) const;
+
+        /** Assign the tasks to the clusters, and sort them by priority */
+        void assign();
+        void sortCluster(std::size_t cluster);
+
+        /** Mark the cluster of a task for analysis, from a priority key */
+        void touch(std::size_t task, long long from_key, bool grow);
+
+        /** Update the priority key of a changed task */
+        void rekey(std::size_t task, bool grow);
+
+        /** Pack the tasks again after a change of utilization */
+        void repack();
+
+        /** Change the timing of a task (ticks) */
+        void retime(std::size_t task, long long c, long long j, long long b);
+
+        /** Analyses of a cluster */
+        Verdict analyzeCluster(_Cluster &);
+        Verdict fpUni(_Cluster &);
+        Verdict edfUni(const _Cluster &, bool aperiodic) const;
+        Verdict fpGlobal(_Cluster &, bool aperiodic);
+        Verdict edfGlobal(const _Cluster &, bool aperiodic) const;
+
+        /**
+         * Response time of a task, fixed priorities on one core, from a
+         * lower bound w0 of the busy window of its first job (updated);
+         * NOT_BOUNDED past the iteration limit. Blocking and jitter are
+         * accounted for only if requested
+         */
+        long long fpResponse(const _Cluster &, std::size_t pos, bool blocking, bool jitter,
+                             long long &w0) const;
+
+        /** Demand of the jobs with deadline up to t (and their blocking) */
+        long long demand(const _Cluster &, long long t, bool blocking, bool jitter) const;
+
+        /** The last deadline before t (-1 if none) */
+        long long lastDeadline(const _Cluster &, long long t, bool jitter) const;
+
+        /** Processor-demand test, by Quick Processor-demand Analysis */
+        Verdict qpa(const _Cluster &, bool blocking, bool jitter) const;
+
+        Policy _policy;
+        Packing _packing;
+        double _time_resolution;
+        std::vector<_Task> _tasks;
+        std::vector<_Cluster> _clusters;
+        Verdict _verdict;
+    };
+
+    /** @} */
+}
+
+#endif // TRES_SCHEDANALYSIS_HDR
@@ -0,0 +1,500 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CanAnalysis.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <tres/CanFrame.hpp>
+#include <tres_analysis/CanAnalysis.hpp>
+
+namespace tres
+{
+    /** Limit of the fixed-point iterations (busy periods and windows) */
+    static const long long MAX_ITERATIONS = 1 << 20;
+
+    /** Ceiling of a / b, for a >= 0 and b > 0 */
+    static inline long long ceilDiv(long long a, long long b)
+    {
+        return (a + b - 1) / b;
+    }
+
+    /** Parse a number (the whole string) */
+    static double parseNumber(const std::string &s, const std::string &what)
+    {
+        char *end;
+        double v = std::strtod(s.c_str(), &end);
+        if (s.empty() || *end != '\0')
+            throw CanAnalysisExc("Invalid " + what + ": " + s);
+        return v;
+    }
+
+    const long long CanAnalysis::UNBOUNDED;
+    const long long CanAnalysis::NOT_BOUNDED;
+
+    CanAnalysis::CanAnalysis(const std::vector<std::string> &msgs, const std::vector<std::string> &ndescr, double time_resolution) :
+        _time_resolution(time_resolution), _from_pos(0), _grow(false), _verdict(UNKNOWN)
+    {
+        if (!(time_resolution > 0))
+            throw CanAnalysisExc("Invalid time resolution");
+        parseNetwork(ndescr);
+        for (std::vector<std::string>::const_iterator m = msgs.begin(); m != msgs.end(); ++m)
+            addMessage(*m);
+    }
+
+    CanAnalysis::CanAnalysis(const std::vector<std::string> &par) :
+        _from_pos(0), _grow(false), _verdict(UNKNOWN)
+    {
+        // The parameters of a network (see the OMNeT++ adapter):
+        //  - the number of messages (#msgs), the message-set description,
+        //  - the number of items (#ndescr), the network description,
+        //  - path to additional libraries, the time resolution
+        std::vector<std::string>::size_type pos = 0;
+        if (par.empty())
+            throw CanAnalysisExc("Empty network configuration");
+        int num_msgs = atoi(par[pos++].c_str());
+        if (num_msgs < 0 || par.size() < pos + num_msgs + 1)
+            throw CanAnalysisExc("Truncated message-set description");
+        std::vector<std::string>::size_type msgs = pos;
+        pos += num_msgs;
+        int num_ndescr = atoi(par[pos++].c_str());
+        if (num_ndescr < 0 || par.size() < pos + num_ndescr + 2)
+            throw CanAnalysisExc("Truncated network description");
+
+        _time_resolution = atof(par[pos + num_ndescr + 1].c_str());
+        if (!(_time_resolution > 0))
+            throw CanAnalysisExc("Invalid time resolution");
+        parseNetwork(std::vector<std::string>(par.begin() + pos, par.begin() + pos + num_ndescr));
+        for (int i = 0; i < num_msgs; ++i)
+            addMessage(par[msgs + i]);
+    }
+
+    void CanAnalysis::parseNetwork(const std::vector<std::string> &ndescr)
+    {
+        using namespace tres_parse_utils;
+
+        // The defaults of tres::NetworkCanNative
+        _bitrate = 500000;
+        _stuffing = true;
+        _fifo = false;
+        _random_errors = false;
+        _error_interval = 0;
+        _params.clear();
+        for (std::vector<std::string>::const_iterator d = ndescr.begin(); d != ndescr.end(); ++d)
+        {
+            std::vector<std::string> tokens = split_instr(*d);
+            if (tokens.empty())
+                continue;
+            const std::string &item = tokens[0];
+            std::string value = (tokens.size() > 1) ? tokens[1] : std::string();
+            if (item == "bitrate")
+            {
+                _bitrate = parseNumber(value, "bit rate");
+                if (!(_bitrate > 0))
+                    throw CanAnalysisExc("Invalid bit rate: " + value);
+            }
+            else if (item == "stuffing")
+            {
+                // Exact stuffing is bounded by the worst case
+                CanStuffing mode;
+                if (!parseCanStuffing(value, mode))
+                    throw CanAnalysisExc("Unknown stuffing mode: " + value);
+                _stuffing = (mode != CAN_STUFF_NONE);
+            }
+            else if (item == "txqueue")
+            {
+                if (value != "priority" && value != "fifo")
+                    throw CanAnalysisExc("Unknown transmit queue: " + value);
+                _fifo = (value == "fifo");
+            }
+            else if (item == "errors")
+            {
+                _random_errors = (value.compare(0, 7, "random:") == 0);
+                if (value.compare(0, 9, "sporadic:") == 0)
+                {
+                    _error_interval = toTicks(parseNumber(value.substr(9), "error interval"));
+                    if (_error_interval <= 0)
+                        throw CanAnalysisExc("Invalid error interval: " + value);
+                }
+                else if (value != "none" && !_random_errors)
+                    throw CanAnalysisExc("Unknown error mode: " + value);
+            }
+            else if (item == "message")
+            {
+                if (value.empty() || !_params.insert(std::make_pair(value, tokens)).second)
+                    throw CanAnalysisExc("Invalid or duplicate message item: " + *d);
+            }
+        }
+        _bit = bitsToTicks(1);
+        _error_frame = bitsToTicks(31);
+    }
+
+    CanAnalysis::_Message CanAnalysis::parseMessage(const std::string &row) const
+    {
+        using namespace tres_parse_utils;
+
+        std::vector<std::string> tokens = split_instr(row);
+        if (tokens.size() < 2)
+            throw CanAnalysisExc("The CAN message needs an identifier: " + row);
+        _Message m;
+
+        // The identifier (hexadecimal)
+        m.uid = tokens[1];
+        if (!parseCanIdentifier(m.uid, m.id, m.extended))
+            throw CanAnalysisExc("Invalid CAN identifier: " + m.uid);
+        m.key = canArbitrationKey(m.id, m.extended);
+
+        // A row without parameters takes those of the network description
+        if (tokens.size() < 3 || tokens[2].empty())
+        {
+            std::map<std::string, std::vector<std::string> >::const_iterator p = _params.find(m.uid);
+            if (p != _params.end())
+            {
+                tokens.resize(2);
+                tokens.insert(tokens.end(), p->second.begin() + 2, p->second.end());
+            }
+        }
+
+        // The timing (the node and the offset do not matter here)
+        m.t = (tokens.size() > 2 && !tokens[2].empty()) ? toTicks(parseNumber(tokens[2], "period")) : 0;
+        if (tokens.size() > 2 && !tokens[2].empty() && m.t <= 0)
+            throw CanAnalysisExc("Invalid period of message " + m.uid);
+        m.dlc = (tokens.size() > 3 && !tokens[3].empty()) ? static_cast<int>(parseNumber(tokens[3], "DLC")) : 8;
+        if (m.dlc < 0 || m.dlc > 8)
+            throw CanAnalysisExc("Invalid DLC of message " + m.uid);
+        m.j = (tokens.size() > 6 && !tokens[6].empty()) ? toTicks(parseNumber(tokens[6], "jitter")) : 0;
+        if (m.j < 0)
+            throw CanAnalysisExc("Invalid jitter of message " + m.uid);
+
+        m.c = frameTime(m.extended, m.dlc);
+        m.d = 0;
+        m.has_deadline = false;
+        m.pos = 0;
+        m.b = 0;
+        m.e = 0;
+        m.r = NOT_BOUNDED;
+        m.busy = 0;
+        m.w0 = 0;
+        m.dirty = true;
+        return m;
+    }
+
+    long long CanAnalysis::toTicks(double t) const
+    {
+        return std::llround(t * _time_resolution);
+    }
+
+    long long CanAnalysis::bitsToTicks(long long bits) const
+    {
+        return static_cast<long long>(std::ceil(bits * _time_resolution / _bitrate - 1e-9));
+    }
+
+    long long CanAnalysis::frameTime(bool extended, int dlc) const
+    {
+        return bitsToTicks(canFrameBits(extended, dlc, _stuffing));
+    }
+
+    double CanAnalysis::getUtilization() const
+    {
+        double u = 0;
+        for (std::vector<_Message>::const_iterator m = _msgs.begin(); m != _msgs.end(); ++m)
+            if (m->t > 0)
+                u += static_cast<double>(m->c) / m->t;
+        return u;
+    }
+
+    void CanAnalysis::touch(std::size_t pos, bool grow)
+    {
+        _from_pos = std::min(_from_pos, pos);
+        _grow = _grow && grow;
+    }
+
+    std::size_t CanAnalysis::addMessage(const std::string &row)
+    {
+        _Message m = parseMessage(row);
+        for (std::vector<_Message>::const_iterator o = _msgs.begin(); o != _msgs.end(); ++o)
+            if (o->key == m.key)
+                throw CanAnalysisExc("Duplicate CAN identifier: " + m.uid);
+
+        // Insert it in the priority order
+        uint32_t index = static_cast<uint32_t>(_msgs.size());
+        _msgs.push_back(m);
+        std::size_t pos = 0;
+        while (pos < _order.size() && _msgs[_order[pos]].key < m.key)
+            ++pos;
+        _order.insert(_order.begin() + pos, index);
+        for (std::size_t p = pos; p < _order.size(); ++p)
+            _msgs[_order[p]].pos = p;
+        touch(pos, true);
+        return index;
+    }
+
+    void CanAnalysis::setPeriod(std::size_t msg, double period)
+    {
+        _Message &m = _msgs[msg];
+        long long t = toTicks(period);
+        if (t <= 0)
+            throw CanAnalysisExc("Invalid period of message " + m.uid);
+        touch(m.pos, m.t == 0 || t < m.t);
+        m.t = t;
+    }
+
+    void CanAnalysis::setJitter(std::size_t msg, double jitter)
+    {
+        _Message &m = _msgs[msg];
+        long long j = toTicks(jitter);
+        if (j < 0)
+            throw CanAnalysisExc("Invalid jitter of message " + m.uid);
+        touch(m.pos, j >= m.j);
+        m.j = j;
+    }
+
+    void CanAnalysis::setDeadline(std::size_t msg, double deadline)
+    {
+        // Only the verdict changes
+        _Message &m = _msgs[msg];
+        long long d = toTicks(deadline);
+        if (d <= 0)
+            throw CanAnalysisExc("Invalid deadline of message " + m.uid);
+        m.d = d;
+        m.has_deadline = true;
+    }
+
+    void CanAnalysis::setDlc(std::size_t msg, int dlc)
+    {
+        _Message &m = _msgs[msg];
+        if (dlc < 0 || dlc > 8)
+            throw CanAnalysisExc("Invalid DLC of message " + m.uid);
+        long long c = frameTime(m.extended, dlc);
+        touch(m.pos, c >= m.c);
+        m.dlc = dlc;
+        m.c = c;
+    }
+
+    long long CanAnalysis::errors(long long t, long long e) const
+    {
+        if (_error_interval <= 0)
+            return 0;
+        return (1 + ceilDiv(t, _error_interval)) * e;
+    }
+
+    CanAnalysis::Verdict CanAnalysis::analyze()
+    {
+        std::size_t n = _order.size();
+
+        // Blocking: the longest frame of lower priority
+        long long lp = 0;
+        for (std::size_t p = n; p-- > 0; )
+        {
+            _Message &m = _msgs[_order[p]];
+            if (m.b != lp)
+            {
+                m.b = lp;
+                m.dirty = true;
+            }
+            lp = std::max(lp, m.c);
+        }
+
+        // The response times, by decreasing priority
+        long long hp = 0;
+        double util = 0;
+        bool unknown = false;
+        _verdict = SCHEDULABLE;
+        for (std::size_t p = 0; p < n; ++p)
+        {
+            _Message &m = _msgs[_order[p]];
+
+            // An error costs an error frame and the retransmission of the
+            // longest frame of higher or equal priority
+            hp = std::max(hp, m.c);
+            long long e = (_error_interval > 0) ? _error_frame + hp : 0;
+            if (m.e != e)
+            {
+                m.e = e;
+                m.dirty = true;
+            }
+            if (m.t > 0)
+                util += static_cast<double>(m.c) / m.t;
+            else
+                unknown = true;
+
+            if (p >= _from_pos || m.dirty)
+            {
+                if (_fifo || _random_errors || unknown)
+                    m.r = NOT_BOUNDED;
+                else if (util + ((e > 0) ? static_cast<double>(e) / _error_interval : 0) >= 1)
+                    m.r = UNBOUNDED;
+                else
+                    m.r = response(m, _grow && m.r != NOT_BOUNDED && m.r != UNBOUNDED);
+                m.dirty = false;
+            }
+            long long d = m.has_deadline ? m.d : m.t;
+            if (m.r == NOT_BOUNDED || m.r > d)
+                _verdict = UNKNOWN;
+        }
+        if (getUtilization() > 1)
+            _verdict = UNSCHEDULABLE;
+
+        _from_pos = n;
+        _grow = true;
+        return _verdict;
+    }
+
+    long long CanAnalysis::response(_Message &m, bool warm) const
+    {
+        // Level-m busy period (the frames of higher or equal priority)
+        long long t = warm ? m.busy : m.b + m.c;
+        for (long long it = 0; ; ++it)
+        {
+            if (it == MAX_ITERATIONS)
+                return NOT_BOUNDED;
+            long long next = m.b + errors(t, m.e);
+            for (std::size_t p = 0; p <= m.pos; ++p)
+            {
+                const _Message &k = _msgs[_order[p]];
+                next += ceilDiv(t + k.j, k.t) * k.c;
+            }
+            if (next == t)
+                break;
+            t = next;
+        }
+        m.busy = t;
+
+        // The instances in the busy period: a frame of higher priority
+        // queued up to a bit time after the start of the transmission of
+        // the instance still wins the arbitration
+        long long instances = ceilDiv(t + m.j, m.t);
+        long long r = 0;
+        long long w = 0;
+        for (long long q = 0; q < instances; ++q)
+        {
+            if (q == 0)
+                w = warm ? m.w0 : m.b;
+            else
+                w = std::max(w + m.c, m.b + q * m.c);
+            for (long long it = 0; ; ++it)
+            {
+                if (it == MAX_ITERATIONS)
+                    return NOT_BOUNDED;
+                long long next = m.b + q * m.c + errors(w + m.c, m.e);
+                for (std::size_t p = 0; p < m.pos; ++p)
+                {
+                    const _Message &k = _msgs[_order[p]];
+                    next += ceilDiv(w + k.j + _bit, k.t) * k.c;
+                }
+                if (next == w)
+                    break;
+                w = next;
+            }
+            if (q == 0)
+                m.w0 = w;
+            r = std::max(r, m.j + w - q * m.t + m.c);
+        }
+        return r;
+    }
+
+    /** Write a time (ticks) in the time unit of the model */
+    static void writeTime(std::ostream &os, long long t, double time_resolution)
+    {
+        if (t == CanAnalysis::UNBOUNDED)
+            os << std::setw(12) << "inf";
+        else if (t < 0)
+            os << std::setw(12) << "-";
+        else
+            os << std::setw(12) << t / time_resolution;
+    }
+
+    std::size_t CanAnalysis::report(std::ostream &os, const std::vector<long long> &observed) const
+    {
+        static const char *verdicts[] = { "SCHEDULABLE", "UNSCHEDULABLE", "UNKNOWN" };
+
+        std::ios::fmtflags flags = os.flags();
+        std::streamsize precision = os.precision();
+        os << std::setprecision(6);
+        os << "CAN bus: " << _msgs.size() << " messages, " << _bitrate << " bit/s, utilization "
+           << getUtilization() << "\n";
+        os << std::left << std::setw(12) << "uid" << std::right
+           << std::setw(12) << "C" << std::setw(12) << "T" << std::setw(12) << "J" << std::setw(12) << "D"
+           << std::setw(12) << "R" << std::setw(12) << "observed" << "  status\n";
+
+        std::size_t exceeded = 0;
+        for (std::vector<uint32_t>::const_iterator i = _order.begin(); i != _order.end(); ++i)
+        {
+            const _Message &m = _msgs[*i];
+            long long d = m.has_deadline ? m.d : m.t;
+            long long obs = (*i < observed.size()) ? observed[*i] : -1;
+            os << std::left << std::setw(12) << m.uid << std::right;
+            writeTime(os, m.c, _time_resolution);
+            writeTime(os, (m.t > 0) ? m.t : -1, _time_resolution);
+            writeTime(os, m.j, _time_resolution);
+            writeTime(os, (d > 0) ? d : -1, _time_resolution);
+            writeTime(os, m.r, _time_resolution);
+            writeTime(os, obs, _time_resolution);
+
+            os << "  ";
+            if (m.r == NOT_BOUNDED)
+                os << "not bounded";
+            else if (m.r == UNBOUNDED)
+                os << "unbounded";
+            else
+            {
+                os << ((m.r > d) ? "deadline miss" : "ok");
+                if (obs > m.r)
+                {
+                    os << ", BOUND EXCEEDED";
+                    ++exceeded;
+                }
+                else if (obs > 0)
+                {
+                    os << ", observed " << std::fixed << std::setprecision(1) << (100.0 * obs / m.r)
+                       << "% of the bound" << std::setprecision(6);
+                    os.unsetf(std::ios::floatfield);
+                }
+            }
+            os << "\n";
+        }
+        os << "Verdict: " << verdicts[_verdict];
+        if (!observed.empty())
+            os << ", " << exceeded << " messages observed beyond their bound";
+        os << "\n";
+
+        os.flags(flags);
+        os.precision(precision);
+        return exceeded;
+    }
+}
@@ -0,0 +1,883 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file SchedAnalysis.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <tres/Task.hpp>
+#include <tres_analysis/SchedAnalysis.hpp>
+
+namespace tres
+{
+    /** Limit of the fixed-point iterations (response times, busy periods) */
+    static const long long MAX_ITERATIONS = 1 << 20;
+
+    /** Ceiling of a / b, for a >= 0 and b > 0 */
+    static inline long long ceilDiv(long long a, long long b)
+    {
+        return (a + b - 1) / b;
+    }
+
+    const long long SchedAnalysis::UNBOUNDED;
+    const long long SchedAnalysis::NOT_BOUNDED;
+
+    /** The verdict of a whole, from the verdicts of its parts */
+    static inline SchedAnalysis::Verdict combine(SchedAnalysis::Verdict a, SchedAnalysis::Verdict b)
+    {
+        if (a == SchedAnalysis::UNSCHEDULABLE || b == SchedAnalysis::UNSCHEDULABLE)
+            return SchedAnalysis::UNSCHEDULABLE;
+        if (a == SchedAnalysis::UNKNOWN || b == SchedAnalysis::UNKNOWN)
+            return SchedAnalysis::UNKNOWN;
+        return SchedAnalysis::SCHEDULABLE;
+    }
+
+    /** Order of the tasks by decreasing utilization */
+    struct _ByUtil
+    {
+        explicit _ByUtil(const std::vector<double> &u) : util(u) {}
+
+        bool operator()(uint32_t a, uint32_t b) const { return util[a] > util[b]; }
+
+        const std::vector<double> &util;
+    };
+
+    SchedAnalysis::SchedAnalysis(const KernelConfig &conf, const std::vector<TaskTiming> &timing) :
+        _packing(PACK_NONE), _time_resolution(conf.time_resolution), _verdict(UNKNOWN)
+    {
+        if (timing.size() != conf.tasks.size())
+            throw SchedAnalysisExc("The timing does not match the task-set of " + conf.name);
+
+        // The scheduling policy (as the native kernel)
+        const std::string& policy = conf.scheduler.policy;
+        if (policy == "FIXED_PRIORITY")
+            _policy = FP;
+        else if (policy == "DEADLINE_MONOTONIC")
+            _policy = DM;
+        else if (policy == "RATE_MONOTONIC")
+            _policy = RM;
+        else if (policy == "EDF")
+            _policy = EDF;
+        else
+            _policy = OTHER;
+
+        // The multicore mode (other parameters are not relevant here)
+        int cluster_size = conf.num_cores;
+        for (std::vector<std::string>::const_iterator p = conf.scheduler.params.begin();
+                p != conf.scheduler.params.end();
+                    ++p)
+        {
+            if (*p == "partitioned")
+                cluster_size = 1;
+            else if (*p == "global")
+                cluster_size = conf.num_cores;
+            else if (p->compare(0, 10, "clustered:") == 0)
+            {
+                char *end;
+                cluster_size = static_cast<int>(std::strtol(p->c_str() + 10, &end, 10));
+                if (*end != '\0' || cluster_size < 1 || cluster_size > conf.num_cores)
+                    throw SchedAnalysisExc("Invalid cluster size: " + *p);
+            }
+            else if (*p == "ffd")
+                _packing = PACK_FFD;
+            else if (*p == "wfd")
+                _packing = PACK_WFD;
+        }
+        if (conf.num_cores < 1)
+            throw SchedAnalysisExc("Invalid number of cores of " + conf.name);
+
+        // The platform: clusters of consecutive cores (the last one may
+        // be smaller)
+        _clusters.resize((conf.num_cores + cluster_size - 1) / cluster_size);
+        for (std::vector<_Cluster>::size_type c = 0; c < _clusters.size(); ++c)
+        {
+            _clusters[c].cores = std::min(cluster_size, conf.num_cores - static_cast<int>(c) * cluster_size);
+            _clusters[c].dirty = true;
+            _clusters[c].from_key = LLONG_MIN;
+            _clusters[c].grow = false;
+            _clusters[c].valid = false;
+            _clusters[c].verdict = UNKNOWN;
+        }
+
+        // The task-set
+        _tasks.resize(conf.tasks.size());
+        for (std::vector<TaskConfig>::size_type i = 0; i < conf.tasks.size(); ++i)
+        {
+            const TaskConfig& tc = conf.tasks[i];
+            _Task& t = _tasks[i];
+
+            t.c = toTicks(timing[i].wcet);
+            t.j = toTicks(timing[i].jitter);
+            t.b = toTicks(timing[i].blocking);
+            if (t.c < 0 || t.j < 0 || t.b < 0)
+                throw SchedAnalysisExc("Negative timing of task " + tc.name);
+            t.t = toTicks(tc.iat);
+            t.d = toTicks(tc.rdl);
+            t.ph = toTicks(tc.ph);
+            t.aperiodic = tc.isAperiodic() || t.t <= 0;
+
+            // Further parameters, as the native kernel: the priority
+            // (default: the order of the task-set) and the CPU core
+            double prio, core;
+            t.has_prio = tc.getNumericParam(0, prio);
+            t.prio = t.has_prio ? static_cast<int>(prio) : 0;
+            t.prio_index = static_cast<long long>(i);
+            t.key = keyOf(t);
+            if (!tc.getNumericParam(1, core))
+                core = -1;
+            else if (core < 0 || core >= conf.num_cores)
+                throw SchedAnalysisExc("Invalid CPU core for task " + tc.name);
+
+            // Tasks with no core are assigned round-robin (or packed,
+            // see assign())
+            t.pinned = (core >= 0);
+            if (t.pinned)
+                t.cluster = static_cast<int>(core) / cluster_size;
+            else
+                t.cluster = static_cast<int>(i % _clusters.size());
+
+            t.r = NOT_BOUNDED;
+            t.w0 = 0;
+        }
+        assign();
+    }
+
+    long long SchedAnalysis::toTicks(double t) const
+    {
+        return std::llround(t * _time_resolution);
+    }
+
+    long long SchedAnalysis::keyOf(const _Task &t) const
+    {
+        switch (_policy)
+        {
+            case FP:    return t.has_prio ? t.prio : t.prio_index;
+            case DM:    return t.d;
+            case RM:    return t.aperiodic ? LLONG_MAX : t.t;
+            default:    return 0;
+        }
+    }
+
+    void SchedAnalysis::assign()
+    {
+        // Packing: as the native kernel, but on the WCET of the tasks
+        if (_packing != PACK_NONE && _clusters.size() > 1)
+        {
+            std::vector<double> util(_tasks.size(), 0.0);
+            std::vector<uint32_t> order;
+            std::vector<double> load(_clusters.size(), 0.0);
+            for (std::vector<_Task>::size_type i = 0; i < _tasks.size(); ++i)
+            {
+                const _Task &t = _tasks[i];
+                long long period = t.aperiodic ? t.d : t.t;
+                if (period > 0)
+                    util[i] = t.c / static_cast<double>(period);
+                if (t.pinned)
+                    load[t.cluster] += util[i];
+                else
+                    order.push_back(i);
+            }
+            std::stable_sort(order.begin(), order.end(), _ByUtil(util));
+
+            for (std::vector<uint32_t>::const_iterator i = order.begin(); i != order.end(); ++i)
+            {
+                int best = -1;
+                if (_packing == PACK_FFD)
+                {
+                    for (std::vector<_Cluster>::size_type c = 0; c < _clusters.size(); ++c)
+                    {
+                        if (load[c] + util[*i] <= _clusters[c].cores)
+                        {
+                            best = c;
+                            break;
+                        }
+                    }
+                }
+                if (best < 0)
+                {
+                    for (std::vector<_Cluster>::size_type c = 0; c < _clusters.size(); ++c)
+                        if (best < 0 || _clusters[c].cores - load[c] > _clusters[best].cores - load[best])
+                            best = c;
+                }
+                _tasks[*i].cluster = best;
+                load[best] += util[*i];
+            }
+        }
+
+        for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+            c->tasks.clear();
+        for (std::vector<_Task>::size_type i = 0; i < _tasks.size(); ++i)
+            _clusters[_tasks[i].cluster].tasks.push_back(i);
+        for (std::vector<_Cluster>::size_type c = 0; c < _clusters.size(); ++c)
+            sortCluster(c);
+    }
+
+    void SchedAnalysis::sortCluster(std::size_t cluster)
+    {
+        // Insertion sort by (key, index): the clusters are re-sorted after
+        // the change of a single key
+        std::vector<uint32_t> &v = _clusters[cluster].tasks;
+        for (std::vector<uint32_t>::size_type k = 1; k < v.size(); ++k)
+        {
+            uint32_t x = v[k];
+            std::vector<uint32_t>::size_type p = k;
+            while (p > 0 && (_tasks[v[p - 1]].key > _tasks[x].key ||
+                        (_tasks[v[p - 1]].key == _tasks[x].key && v[p - 1] > x)))
+            {
+                v[p] = v[p - 1];
+                --p;
+            }
+            v[p] = x;
+        }
+    }
+
+    void SchedAnalysis::touch(std::size_t task, long long from_key, bool grow)
+    {
+        _Cluster &c = _clusters[_tasks[task].cluster];
+        if (!c.dirty)
+        {
+            c.dirty = true;
+            c.from_key = from_key;
+            c.grow = grow;
+        }
+        else
+        {
+            c.from_key = std::min(c.from_key, from_key);
+            c.grow = c.grow && grow;
+        }
+    }
+
+    void SchedAnalysis::rekey(std::size_t task, bool grow)
+    {
+        _Task &t = _tasks[task];
+        long long key = keyOf(t);
+        if (key == t.key)
+        {
+            touch(task, key, grow);
+            return;
+        }
+
+        // A new priority: the tasks in between change their interferences
+        touch(task, std::min(key, t.key), false);
+        t.key = key;
+        sortCluster(t.cluster);
+    }
+
+    void SchedAnalysis::repack()
+    {
+        // Packing on the WCET: any change of utilization may move the tasks
+        if (_packing == PACK_NONE || _clusters.size() < 2)
+            return;
+        assign();
+        for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+        {
+            c->dirty = true;
+            c->from_key = LLONG_MIN;
+            c->grow = false;
+        }
+    }
+
+    void SchedAnalysis::setTiming(std::size_t task, const TaskTiming &timing)
+    {
+        long long c = toTicks(timing.wcet), j = toTicks(timing.jitter), b = toTicks(timing.blocking);
+        if (c < 0 || j < 0 || b < 0)
+            throw SchedAnalysisExc("Negative timing of a task");
+        retime(task, c, j, b);
+    }
+
+    void SchedAnalysis::retime(std::size_t task, long long c, long long j, long long b)
+    {
+        _Task &t = _tasks[task];
+        if (c == t.c && j == t.j && b == t.b)
+            return;
+        bool grow = (c >= t.c && j >= t.j && b >= t.b);
+        bool util = (c != t.c);
+        t.c = c;
+        t.j = j;
+        t.b = b;
+        touch(task, t.key, grow);
+        if (util)
+            repack();
+    }
+
+    void SchedAnalysis::setPeriod(std::size_t task, double iat)
+    {
+        _Task &t = _tasks[task];
+        long long p = toTicks(iat);
+        if (p == t.t)
+            return;
+        bool grow = (p > 0 && t.t > 0 && p < t.t);
+        t.t = p;
+        if (p <= 0)
+            t.aperiodic = true;
+        rekey(task, grow);
+        repack();
+    }
+
+    void SchedAnalysis::setDeadline(std::size_t task, double rdl)
+    {
+        _Task &t = _tasks[task];
+        long long d = toTicks(rdl);
+        if (d == t.d)
+            return;
+
+        // The demand does not change (the analyses stopped at the former
+        // deadline are resumed where they stopped)
+        t.d = d;
+        rekey(task, true);
+        if (t.aperiodic)
+            repack();
+    }
+
+    void SchedAnalysis::setPriority(std::size_t task, int priority)
+    {
+        _Task &t = _tasks[task];
+        if (t.has_prio && t.prio == priority)
+            return;
+        t.prio = priority;
+        t.has_prio = true;
+        rekey(task, true);
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::analyze()
+    {
+        Verdict v = SCHEDULABLE;
+        for (std::vector<_Cluster>::iterator c = _clusters.begin(); c != _clusters.end(); ++c)
+        {
+            if (c->dirty)
+            {
+                c->verdict = analyzeCluster(*c);
+                c->dirty = false;
+                c->from_key = LLONG_MAX;
+                c->grow = true;
+            }
+            v = combine(v, c->verdict);
+        }
+        _verdict = v;
+        return v;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::analyzeCluster(_Cluster &c)
+    {
+        // Necessary conditions: no overload, and no job longer than
+        // its deadline (with the jitter, a miss is only possible)
+        double u = 0;
+        bool aperiodic = false;
+        bool synchronous = true;
+        bool fail = false;
+        long long ph = -1;
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+        {
+            const _Task &t = _tasks[*i];
+            if (t.aperiodic)
+            {
+                aperiodic = true;
+                continue;
+            }
+            if (t.c > t.d)
+                fail = true;
+            u += t.c / static_cast<double>(t.t);
+            if (ph >= 0 && t.ph != ph)
+                synchronous = false;
+            ph = t.ph;
+        }
+
+        // Only the fixed-priority analyses compute response times
+        bool fp = (_policy == FP || _policy == DM || _policy == RM);
+        if (fail || u > c.cores || !fp)
+        {
+            for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+                _tasks[*i].r = NOT_BOUNDED;
+            c.valid = false;
+        }
+        if (fail || u > c.cores)
+            return UNSCHEDULABLE;
+
+        Verdict v;
+        if (_policy == OTHER)
+            v = UNKNOWN;
+        else if (c.cores == 1)
+            v = (_policy == EDF) ? edfUni(c, aperiodic) : fpUni(c);
+        else
+            v = (_policy == EDF) ? edfGlobal(c, aperiodic) : fpGlobal(c, aperiodic);
+
+        // The exact tests assume synchronous activations
+        if (v == UNSCHEDULABLE && !synchronous)
+            v = UNKNOWN;
+        return v;
+    }
+
+    long long SchedAnalysis::fpResponse(const _Cluster &c, std::size_t pos, bool blocking, bool jitter,
+                                        long long &w0) const
+    {
+        const _Task &t = _tasks[c.tasks[pos]];
+        if (t.aperiodic)
+            return NOT_BOUNDED;
+
+        // The tasks of higher or equal priority
+        std::size_t end = pos + 1;
+        while (end < c.tasks.size() && _tasks[c.tasks[end]].key == t.key)
+            ++end;
+        double u = t.c / static_cast<double>(t.t);
+        for (std::size_t p = 0; p < end; ++p)
+        {
+            const _Task &h = _tasks[c.tasks[p]];
+            if (p == pos)
+                continue;
+            if (h.aperiodic)
+                return NOT_BOUNDED;
+            u += h.c / static_cast<double>(h.t);
+        }
+        if (u > 1)
+            return UNBOUNDED;
+
+        // Busy windows of the jobs in the level-i busy period, from the
+        // (lower bound) w0 of the first one
+        long long b = blocking ? t.b : 0;
+        long long j = jitter ? t.j : 0;
+        long long r = 0, w = 0;
+        for (long long q = 0; q < MAX_ITERATIONS; ++q)
+        {
+            w = (q == 0) ? std::max(w0, b + t.c) : w + t.c;
+            for (long long it = 0; ; ++it)
+            {
+                if (it == MAX_ITERATIONS)
+                    return NOT_BOUNDED;
+                long long next = b + (q + 1) * t.c;
+                for (std::size_t p = 0; p < end; ++p)
+                {
+                    const _Task &h = _tasks[c.tasks[p]];
+                    if (p != pos)
+                        next += ceilDiv(w + (jitter ? h.j : 0), h.t) * h.c;
+                }
+                if (next <= w)
+                    break;
+                w = next;
+
+                // No need of the exact value past the deadline
+                if (w - q * t.t + j > t.d)
+                {
+                    if (q == 0)
+                        w0 = w;
+                    return w - q * t.t + j;
+                }
+            }
+            if (q == 0)
+                w0 = w;
+            r = std::max(r, w - q * t.t + j);
+            if (w + j <= (q + 1) * t.t)
+                return r;
+        }
+        return NOT_BOUNDED;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::fpUni(_Cluster &c)
+    {
+        // Tasks of higher priority than the changed ones keep their
+        // response times (if they were computed)
+        const long long from_key = c.valid ? c.from_key : LLONG_MIN;
+        const bool grow = c.valid && c.grow;
+        c.valid = true;
+
+        Verdict v = SCHEDULABLE;
+        for (std::size_t pos = 0; pos < c.tasks.size(); ++pos)
+        {
+            _Task &t = _tasks[c.tasks[pos]];
+            if (t.key >= from_key)
+            {
+                long long w0 = grow ? t.w0 : 0;
+                t.r = fpResponse(c, pos, true, true, w0);
+                t.w0 = w0;
+            }
+            if (t.r == NOT_BOUNDED)
+            {
+                v = combine(v, UNKNOWN);
+                continue;
+            }
+            if (t.r <= t.d)
+                continue;
+
+            // A deadline miss is certain only if it happens without
+            // blocking and jitter (bounds, which may not be reached), and
+            // does not depend on the order of ties
+            bool tie = (pos > 0 && _tasks[c.tasks[pos - 1]].key == t.key) ||
+                (pos + 1 < c.tasks.size() && _tasks[c.tasks[pos + 1]].key == t.key);
+            long long w0 = 0;
+            if (!tie && fpResponse(c, pos, false, false, w0) > t.d)
+                v = combine(v, UNSCHEDULABLE);
+            else
+                v = combine(v, UNKNOWN);
+        }
+        return v;
+    }
+
+    long long SchedAnalysis::demand(const _Cluster &c, long long t, bool blocking, bool jitter) const
+    {
+        long long h = 0, b = 0;
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+        {
+            const _Task &k = _tasks[*i];
+            long long d = k.d - (jitter ? k.j : 0);
+            if (k.aperiodic || k.c == 0 || d > t)
+                continue;
+            h += ((t - d) / k.t + 1) * k.c;
+            if (blocking)
+                b = std::max(b, k.b);
+        }
+        return h + b;
+    }
+
+    long long SchedAnalysis::lastDeadline(const _Cluster &c, long long t, bool jitter) const
+    {
+        long long last = -1;
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+        {
+            const _Task &k = _tasks[*i];
+            long long d = k.d - (jitter ? k.j : 0);
+            if (k.aperiodic || k.c == 0 || d >= t)
+                continue;
+            last = std::max(last, d + (t - 1 - d) / k.t * k.t);
+        }
+        return last;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::qpa(const _Cluster &c, bool blocking, bool jitter) const
+    {
+        // Trivial case: implicit deadlines (or later), no jitter and no
+        // blocking; the utilization was already checked
+        double u = 0, slack = 0;
+        long long sum = 0, bmax = 0, dmin = LLONG_MAX, dmax = 0;
+        bool trivial = true;
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+        {
+            const _Task &k = _tasks[*i];
+            if (k.aperiodic || k.c == 0)
+                continue;
+            long long d = k.d - (jitter ? k.j : 0);
+            double uk = k.c / static_cast<double>(k.t);
+            u += uk;
+            slack += (k.t - d) * uk;
+            sum += k.c;
+            if (blocking)
+                bmax = std::max(bmax, k.b);
+            dmin = std::min(dmin, d);
+            dmax = std::max(dmax, d);
+            if (d < k.t || (blocking && k.b > 0))
+                trivial = false;
+        }
+        if (trivial)
+            return SCHEDULABLE;
+
+        // The interval to check: the synchronous busy period, and the
+        // bound of the demand for U < 1
+        long long l = sum + bmax;
+        for (long long it = 0; ; ++it)
+        {
+            if (it == MAX_ITERATIONS)
+                return UNKNOWN;
+            long long next = bmax;
+            for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+            {
+                const _Task &k = _tasks[*i];
+                if (!k.aperiodic && k.c > 0)
+                    next += ceilDiv(l + (jitter ? k.j : 0), k.t) * k.c;
+            }
+            if (next <= l)
+                break;
+            l = next;
+        }
+        if (u < 1)
+        {
+            double la = std::max(std::ceil((slack + bmax) / (1 - u)), static_cast<double>(dmax));
+            if (la + 1 < l)
+                l = static_cast<long long>(la) + 1;
+        }
+
+        // Quick Processor-demand Analysis
+        long long t = lastDeadline(c, l, jitter);
+        for (long long it = 0; it < MAX_ITERATIONS; ++it)
+        {
+            long long h = demand(c, t, blocking, jitter);
+            if (h <= dmin)
+                return SCHEDULABLE;
+            if (h > t)
+                return UNSCHEDULABLE;
+            t = (h < t) ? h : lastDeadline(c, t, jitter);
+        }
+        return UNKNOWN;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::edfUni(const _Cluster &c, bool aperiodic) const
+    {
+        bool blocking = false, jitter = false;
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+        {
+            blocking = blocking || _tasks[*i].b > 0;
+            jitter = jitter || _tasks[*i].j > 0;
+        }
+
+        Verdict v = qpa(c, blocking, jitter);
+
+        // Blocking and jitter are bounds, which may not be reached: a
+        // deadline miss is certain only if it happens without them
+        if (v == UNSCHEDULABLE && (blocking || jitter) && qpa(c, false, false) != UNSCHEDULABLE)
+            v = UNKNOWN;
+
+        // Aperiodic tasks only add demand
+        if (v == SCHEDULABLE && aperiodic)
+            v = UNKNOWN;
+        return v;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::fpGlobal(_Cluster &c, bool aperiodic)
+    {
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+            _tasks[*i].r = NOT_BOUNDED;
+        if (aperiodic)
+            return UNKNOWN;
+
+        // Response-time analysis of Bertogna and Cirinei: the interference
+        // of a higher-priority task is bounded by its workload in the
+        // window (with carry-in, given its response time; its deadline for
+        // ties not yet analyzed). The jobs of a task must not overlap, i.e.,
+        // complete within the period
+        const long long m = c.cores;
+        for (std::size_t pos = 0; pos < c.tasks.size(); ++pos)
+        {
+            _Task &t = _tasks[c.tasks[pos]];
+            std::size_t end = pos + 1;
+            while (end < c.tasks.size() && _tasks[c.tasks[end]].key == t.key)
+                ++end;
+
+            long long r = t.c + t.b;
+            for (long long it = 0; ; ++it)
+            {
+                if (it == MAX_ITERATIONS || r + t.j > std::min(t.d, t.t))
+                    return UNKNOWN;
+                long long interf = 0;
+                for (std::size_t p = 0; p < end; ++p)
+                {
+                    if (p == pos)
+                        continue;
+                    const _Task &h = _tasks[c.tasks[p]];
+                    long long rh = (p < pos) ? h.r : h.d;
+                    long long n = (r + rh - h.c) / h.t;
+                    long long wl = n * h.c + std::min(h.c, r + rh - h.c - n * h.t);
+                    interf += std::min(wl, r - t.c + 1);
+                }
+                long long next = t.c + t.b + interf / m;
+                if (next <= r)
+                    break;
+                r = next;
+            }
+            t.r = r + t.j;
+        }
+        return SCHEDULABLE;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::edfGlobal(const _Cluster &c, bool aperiodic) const
+    {
+        if (aperiodic)
+            return UNKNOWN;
+
+        // Density test of Goossens, Funk and Baruah
+        double sum = 0, top = 0;
+        for (std::vector<uint32_t>::const_iterator i = c.tasks.begin(); i != c.tasks.end(); ++i)
+        {
+            const _Task &k = _tasks[*i];
+            if (k.c == 0)
+                continue;
+            double density = (k.c + k.b) / static_cast<double>(std::min(k.d - k.j, k.t));
+            sum += density;
+            top = std::max(top, density);
+        }
+        return (sum <= c.cores - (c.cores - 1) * top) ? SCHEDULABLE : UNKNOWN;
+    }
+
+    void SchedAnalysis::screen(const double *wcet, std::size_t candidates, Verdict *out) const
+    {
+        const std::size_t k = candidates;
+        const std::size_t nc = _clusters.size();
+
+        // Per cluster and candidate (candidates contiguous): utilization,
+        // density, product of the densities + 1 (hyperbolic bound), largest
+        // density and largest excess of a WCET over its deadline
+        std::vector<double> util(nc * k, 0.0), dens(nc * k, 0.0), prod(nc * k, 1.0), top(nc * k, 0.0);
+        std::vector<double> excess(k, -1.0);
+
+        // Per cluster: the slack of the rounding of the WCET to ticks,
+        // and whether the bounds can tell it is schedulable
+        std::vector<double> u_slack(nc, 0.0), d_slack(nc, 0.0);
+        std::vector<char> bounded(nc, 1), hyperbolic(nc, 1);
+
+        const bool packed = (_packing != PACK_NONE && nc > 1);
+        const double res = _time_resolution;
+        for (std::size_t i = 0; i < _tasks.size() && !packed; ++i)
+        {
+            const _Task &t = _tasks[i];
+            const std::size_t cl = t.cluster;
+            const double *w = wcet + i * k;
+            if (t.aperiodic)
+            {
+                bounded[cl] = 0;
+                continue;
+            }
+
+            // Jitter and blocking are added to the WCET in the density (the
+            // demand of the blocking is charged to every deadline)
+            const double su = res / t.t;
+            const double dl = static_cast<double>(std::min(t.d - t.j, t.t));
+            const double sd = (dl > 0) ? res / dl : 0;
+            const double bd = (dl > 0) ? t.b / dl : 0;
+            const double lim = static_cast<double>(t.d);
+            u_slack[cl] += 0.5 / t.t;
+            if (dl > 0)
+                d_slack[cl] += 0.5 / dl;
+            else
+                bounded[cl] = 0;
+            if (t.j > 0 || t.b > 0 || (_policy == RM && t.d < t.t) || (_policy == DM && t.d > t.t))
+                hyperbolic[cl] = 0;
+
+            double *u = &util[cl * k];
+            double *d = &dens[cl * k];
+            double *p = &prod[cl * k];
+            double *m = &top[cl * k];
+            double *e = &excess[0];
+            if (_policy == RM)
+            {
+                for (std::size_t c = 0; c < k; ++c)
+                    p[c] *= 1.0 + w[c] * su;
+            }
+            else
+            {
+                for (std::size_t c = 0; c < k; ++c)
+                    p[c] *= 1.0 + w[c] * sd;
+            }
+            for (std::size_t c = 0; c < k; ++c)
+            {
+                const double x = w[c] * sd + bd;
+                u[c] += w[c] * su;
+                d[c] += x;
+                m[c] = (x > m[c]) ? x : m[c];
+                e[c] = (w[c] * res - lim > e[c]) ? w[c] * res - lim : e[c];
+            }
+        }
+
+        SchedAnalysis *scratch = NULL;
+        for (std::size_t c = 0; c < k; ++c)
+        {
+            Verdict v = UNKNOWN;
+            if (!packed)
+            {
+                // Certain misses (a WCET larger than its deadline, even if
+                // rounded, whatever the jitter; an overloaded cluster), then
+                // sufficient bounds
+                v = SCHEDULABLE;
+                if (excess[c] > 0.5)
+                    v = UNSCHEDULABLE;
+                for (std::size_t cl = 0; cl < nc && v != UNSCHEDULABLE; ++cl)
+                {
+                    const _Cluster &x = _clusters[cl];
+                    const std::size_t j = cl * k + c;
+                    if (util[j] - u_slack[cl] > x.cores)
+                    {
+                        v = UNSCHEDULABLE;
+                        break;
+                    }
+                    if (!bounded[cl] || _policy == OTHER)
+                    {
+                        v = UNKNOWN;
+                        continue;
+                    }
+                    const double d = dens[j] + d_slack[cl];
+                    bool ok;
+                    if (x.cores > 1)
+                        ok = (_policy == EDF) && d <= x.cores - (x.cores - 1) * (top[j] + d_slack[cl]);
+                    else if (_policy == EDF)
+                        ok = (d <= 1);
+                    else
+                        ok = (_policy != FP) && hyperbolic[cl] &&
+                            prod[j] * std::exp(_policy == RM ? u_slack[cl] : d_slack[cl]) <= 2;
+                    if (!ok)
+                        v = UNKNOWN;
+                }
+            }
+            if (v != UNKNOWN)
+            {
+                out[c] = v;
+                continue;
+            }
+
+            // The others: the analysis of the candidate, changing the WCET
+            // of the previous one
+            if (scratch == NULL)
+                scratch = new SchedAnalysis(*this);
+            for (std::size_t i = 0; i < _tasks.size(); ++i)
+            {
+                long long wc = toTicks(wcet[i * k + c]);
+                if (wc < 0)
+                    throw SchedAnalysisExc("Negative timing of a task");
+                scratch->retime(i, wc, scratch->_tasks[i].j, scratch->_tasks[i].b);
+            }
+            out[c] = scratch->analyze();
+        }
+        delete scratch;
+    }
+
+    SchedAnalysis::Verdict SchedAnalysis::prescreen(const KernelConfig &conf, const std::vector<TaskTiming> &timing)
+    {
+        try
+        {
+            SchedAnalysis a(conf, timing);
+            return a.analyze();
+        }
+        catch (SchedAnalysisExc &)
+        {
+            return UNKNOWN;
+        }
+        catch (KernelConfigExc &)
+        {
+            return UNKNOWN;
+        }
+    }
+
+    double SchedAnalysis::getWCET(const std::vector<std::string> &body)
+    {
+        Task t(body);
+        return t.getWCET();
+    }
+}
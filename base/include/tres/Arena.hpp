@@ -0,0 +1,190 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file Arena.hpp
+ */
+
+#ifndef TRES_ARENA_HDR
+#define TRES_ARENA_HDR
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+
+    /**
+     * \brief Monotonic arena for the object graph of a simulation context
+     *
+     * Objects are carved out of large blocks and never freed one by one:
+     * release() runs the destructors of the objects that need one (in
+     * reverse order of construction) and then frees the blocks. Objects
+     * with a trivial destructor cost nothing at release time.
+     *
+     * \note Objects created in an arena must not be deleted by anyone else
+     */
+    class Arena
+    {
+
+    public:
+
+        /** Allocation counters */
+        struct Stats
+        {
+            /** Number of allocations served */
+            std::size_t allocations;
+
+            /** Bytes handed out (padding included) */
+            std::size_t bytes;
+
+            /** Number of blocks obtained from the system */
+            std::size_t blocks;
+
+            /** Bytes obtained from the system */
+            std::size_t reserved;
+
+            /** Number of registered destructors */
+            std::size_t finalizers;
+        };
+
+        /** Default size of the blocks */
+        static const std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        /**
+         * \brief Constructor
+         */
+        explicit Arena(std::size_t block_size = DEFAULT_BLOCK_SIZE);
+
+        /**
+         * \brief Destructor (see release())
+         */
+        ~Arena();
+
+        /**
+         * \brief Return size bytes of raw memory, aligned to align
+         */
+        void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t));
+
+        /**
+         * \brief Construct an object of type T in the arena
+         *
+         * The destructor of T (if not trivial) is run by release()
+         */
+        template <typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            // The finalizer is allocated first: once T is built,
+            // registering its destructor cannot fail
+            _Finalizer *fin = NULL;
+            if (!std::is_trivially_destructible<T>::value)
+                fin = static_cast<_Finalizer *>(allocate(sizeof(_Finalizer), alignof(_Finalizer)));
+            T *obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+            if (fin != NULL)
+            {
+                fin->destroy = &_destroy<T>;
+                fin->obj = obj;
+                fin->next = _finalizers;
+                _finalizers = fin;
+                ++_stats.finalizers;
+            }
+            return obj;
+        }
+
+        /**
+         * \brief Destroy all the objects and give the memory back
+         *
+         * The arena can be used again afterwards
+         */
+        void release();
+
+        /**
+         * \brief Return the allocation counters (since the last release())
+         */
+        const Stats& getStats() const { return _stats; }
+
+    private:
+
+        /** Header of a memory block */
+        struct _Block
+        {
+            _Block *next;
+            std::size_t size;
+        };
+
+        /** A registered destructor */
+        struct _Finalizer
+        {
+            void (*destroy)(void *);
+            void *obj;
+            _Finalizer *next;
+        };
+
+        template <typename T>
+        static void _destroy(void *p)
+        {
+            static_cast<T *>(p)->~T();
+        }
+
+        /** Prevent copies */
+        Arena(const Arena&);
+        Arena& operator=(const Arena&);
+
+        /** Get a new block, large enough for size bytes aligned to align */
+        void grow(std::size_t size, std::size_t align);
+
+        std::size_t _block_size;
+
+        /** Blocks, most recent first */
+        _Block *_blocks;
+
+        /** Free space in the current block */
+        char *_cur;
+        char *_end;
+
+        /** Destructors to run, most recent first */
+        _Finalizer *_finalizers;
+
+        Stats _stats;
+    };
+
+    /** @} */
+}
+
+#endif // TRES_ARENA_HDR
@@ -0,0 +1,162 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file BinaryIO.hpp
+ *
+ * Compact binary images of plain values, strings and vectors, used for
+ * the model cache and for the snapshots of the simulation state.
+ */
+
+#ifndef TRES_BINARYIO_HDR
+#define TRES_BINARYIO_HDR
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../../src/BaseExc.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+
+    /**
+     * \brief Exception raised when decoding a malformed binary image
+     */
+    DECL_EXC(BinaryIOExc, "BinaryIO");
+
+    /**
+     * \brief Serializes plain values, strings and vectors into a buffer
+     *
+     * Values are stored in the native representation (the images are not
+     * meant to be portable across architectures).
+     */
+    class BinaryWriter
+    {
+
+    public:
+
+        template <typename T>
+        void put(const T &v)
+        {
+            _buf.append(reinterpret_cast<const char *>(&v), sizeof(T));
+        }
+
+        void putString(const std::string &s)
+        {
+            put<uint64_t>(s.size());
+            _buf.append(s);
+        }
+
+        template <typename T>
+        void putVector(const std::vector<T> &v)
+        {
+            put<uint64_t>(v.size());
+            if (!v.empty())
+                _buf.append(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(T));
+        }
+
+        /**
+         * \brief Returns the serialized data
+         */
+        const std::string &data() const { return _buf; }
+
+    private:
+
+        std::string _buf;
+    };
+
+    /**
+     * \brief Reads back the data written by a BinaryWriter
+     *
+     * \throw BinaryIOExc when reading past the end of the data
+     */
+    class BinaryReader
+    {
+
+    public:
+
+        BinaryReader(const char *data, std::size_t size) : _p(data), _end(data + size) {}
+
+        template <typename T>
+        T get()
+        {
+            T v;
+            need(sizeof(T));
+            std::memcpy(&v, _p, sizeof(T));
+            _p += sizeof(T);
+            return v;
+        }
+
+        std::string getString()
+        {
+            std::size_t n = static_cast<std::size_t>(get<uint64_t>());
+            need(n);
+            std::string s(_p, n);
+            _p += n;
+            return s;
+        }
+
+        template <typename T>
+        void getVector(std::vector<T> &v)
+        {
+            std::size_t n = static_cast<std::size_t>(get<uint64_t>());
+            if (n > static_cast<std::size_t>(_end - _p) / sizeof(T))
+                throw BinaryIOExc("Truncated image");
+            v.resize(n);
+            if (n > 0)
+                std::memcpy(v.data(), _p, n * sizeof(T));
+            _p += n * sizeof(T);
+        }
+
+        bool atEnd() const { return _p == _end; }
+
+    private:
+
+        void need(std::size_t n)
+        {
+            if (n > static_cast<std::size_t>(_end - _p))
+                throw BinaryIOExc("Truncated image");
+        }
+
+        const char *_p;
+        const char *_end;
+    };
+    /** @} */
+}
+#endif // TRES_BINARYIO_HDR
@@ -0,0 +1,156 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file BranchRunner.hpp
+ */
+
+#ifndef TRES_BRANCHRUNNER_HDR
+#define TRES_BRANCHRUNNER_HDR
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "../../src/BaseExc.hpp"
+#include "../../src/RandomGen.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+
+    /**
+     * \brief Exception raised when the branches cannot be run
+     */
+    DECL_EXC(BranchRunnerExc, "BranchRunner");
+
+    /**
+     * \brief Runs several stochastic continuations of a common simulation prefix
+     *
+     * The prefix (e.g., a warm-up) is simulated once by the calling process;
+     * run() then forks a child process per branch. The child inherits the
+     * whole state of the simulation with copy-on-write memory, including
+     * the process-global state of third-party engines (the MetaSim event
+     * queue of the RTSim kernels, the OMNeT++ simulation of the networks),
+     * which cannot be saved otherwise (see Kernel::saveState()).
+     *
+     * Each child starts its own stream of the random generators
+     * (see RandomVar::reseed()), runs the body of the branch and stores its
+     * results in a slot of a shared-memory area, read by the parent once the
+     * child has exited. A branch fails if its body throws or its process
+     * does not exit normally; its results are then ignored.
+     *
+     * The runner waits for its own children only, in launch order. Only
+     * POSIX systems are supported.
+     */
+    class BranchRunner
+    {
+
+    public:
+
+        /**
+         * \brief Body of a branch: index of the branch and its result slot
+         * (fields values, initialized to zero)
+         */
+        typedef std::function<void(std::size_t, double *)> Body;
+
+        /** Statistics of a result field over the completed branches (NaN if none) */
+        struct Summary
+        {
+            std::size_t count;
+            double min;
+            double max;
+            double mean;
+            double stddev;
+        };
+
+        /**
+         * \brief Constructor
+         *
+         * \param branches is the number of branches
+         * \param fields is the number of results of a branch
+         * \param seed is the seed of the streams of the branches
+         * \param max_children is the maximum number of branches running at
+         * once (by default, the number of hardware threads)
+         */
+        BranchRunner(std::size_t branches, std::size_t fields, RandNum seed = 1,
+                     std::size_t max_children = 0);
+
+        ~BranchRunner();
+
+        /**
+         * \brief Run all the branches from the current state of the process
+         *
+         * \return the number of completed branches
+         * \throw BranchRunnerExc if the shared memory or the child processes
+         * cannot be created
+         */
+        std::size_t run(const Body &body);
+
+        /**
+         * \brief Whether a branch completed (in the last run())
+         */
+        bool completed(std::size_t branch) const;
+
+        /**
+         * \brief The results of a branch
+         */
+        const double *result(std::size_t branch) const;
+
+        /**
+         * \brief Statistics of a result field over the completed branches
+         */
+        Summary summarize(std::size_t field) const;
+
+    private:
+
+        BranchRunner(const BranchRunner &);
+        BranchRunner &operator=(const BranchRunner &);
+
+        std::size_t _branches;
+        std::size_t _fields;
+        RandNum _seed;
+        std::size_t _max_children;
+
+        /** The shared area: a completion flag per branch, then the results */
+        void *_shm;
+        std::size_t _shm_size;
+
+        /** Completion of the branches (from the exit status of the children) */
+        std::vector<bool> _completed;
+    };
+    /** @} */
+}
+#endif // TRES_BRANCHRUNNER_HDR
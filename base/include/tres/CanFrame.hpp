@@ -0,0 +1,101 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CanFrame.hpp
+ */
+
+#ifndef TRES_CANFRAME_HDR
+#define TRES_CANFRAME_HDR
+#include <cstdint>
+#include <string>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_base_network_abstractions
+     * @{
+     */
+
+    /**
+     * \brief Models of the stuff bits of the frames of a CAN bus
+     *
+     * The frames have the largest number of stuff bits, the stuff bits of
+     * their actual bit stream, or none at all. The frame model is shared by
+     * the CAN network engines and the CAN analyses, so that the bounds of
+     * the latter hold for the simulations of the former.
+     */
+    enum CanStuffing
+    {
+        CAN_STUFF_WORST = 0,
+        CAN_STUFF_EXACT,
+        CAN_STUFF_NONE
+    };
+
+    /**
+     * \brief Parse a stuffing mode of a network description ("worst",
+     * "exact" or "none")
+     *
+     * \return false if the mode is unknown
+     */
+    bool parseCanStuffing(const std::string &value, CanStuffing &mode);
+
+    /**
+     * \brief Parse a CAN identifier (in hexadecimal, with or without the
+     * "0x" prefix)
+     *
+     * Identifiers above 0x7ff, or written with more than 3 digits, are
+     * extended (29-bit) identifiers.
+     *
+     * \return false if the identifier is invalid
+     */
+    bool parseCanIdentifier(const std::string &uid, uint32_t &id, bool &extended);
+
+    /**
+     * \brief Arbitration key of an identifier (the lower, the higher the
+     * priority): the arbitration field, with standard frames winning over
+     * extended ones with the same base identifier
+     */
+    uint64_t canArbitrationKey(uint32_t id, bool extended);
+
+    /**
+     * \brief Number of bits of a data frame, with the inter-frame space,
+     * and with the largest number of stuff bits (or none)
+     */
+    int canFrameBits(bool extended, int dlc, bool stuffing = true);
+
+    /** @} */
+}
+
+#endif // TRES_CANFRAME_HDR
@@ -59,12 +59,20 @@
  */
 typedef std::string defaultIDKeyType;
 
+/**
+ * \brief Type of the description of the products
+ */
+typedef std::vector<std::string> defaultParamType;
+
 /**
  * \brief The abstract factory itself
  *
- * Implemented using the Singleton pattern
+ * Implemented using the Singleton pattern. By default products are described
+ * by a vector of strings; a different (typed) description can be used by
+ * means of the paramType argument, in which case a separate registry is kept.
  */
-template <class manufacturedObj, typename classIDKey=defaultIDKeyType>
+template <class manufacturedObj, typename classIDKey=defaultIDKeyType,
+          typename paramType=defaultParamType>
 class Factory 
 {
     public:
@@ -73,10 +81,10 @@ class Factory
          * \brief A base function for object creation
          * 
          * A BASE_CREATE_FN is a function that takes a description of a specialized
-         * implementation of a manufacturedObj as a vector of strings, and returns an
-         * unique_ptr to a manufacturedObj.
+         * implementation of a manufacturedObj (by default, as a vector of strings),
+         * and returns an unique_ptr to a manufacturedObj.
          */
-        typedef std::unique_ptr<manufacturedObj> (*BASE_CREATE_FN)(std::vector<std::string> &par);
+        typedef std::unique_ptr<manufacturedObj> (*BASE_CREATE_FN)(paramType &par);
 
         /**
          * \brief FN_REGISTRY is the registry of all the BASE_CREATE_FN
@@ -103,7 +111,7 @@ class Factory
         /**
          * \brief Create a new class of the type specified by className
          */
-        std::unique_ptr<manufacturedObj> create(const classIDKey &className, std::vector<std::string> &parms) const;
+        std::unique_ptr<manufacturedObj> create(const classIDKey &className, paramType &parms) const;
 
     private:
 
@@ -139,17 +147,18 @@ class Factory
  */
 template <class ancestorType,
           class manufacturedObj,
-          typename classIDKey=defaultIDKeyType>
+          typename classIDKey=defaultIDKeyType,
+          typename paramType=defaultParamType>
 class registerInFactory
 {
     public:
-        static std::unique_ptr<ancestorType> createInstance(std::vector<std::string> &par)
+        static std::unique_ptr<ancestorType> createInstance(paramType &par)
         {
             return std::unique_ptr<ancestorType>(manufacturedObj::createInstance(par));
         }
         registerInFactory(const classIDKey &id)
         {
-            Factory<ancestorType>::instance().regCreateFn(id, createInstance);
+            Factory<ancestorType, classIDKey, paramType>::instance().regCreateFn(id, createInstance);
         }
 };
 
@@ -159,13 +168,13 @@ class registerInFactory
 #define FACT(xxx) Factory<xxx>::instance()
 /** @} */
 
-template <class manufacturedObj, typename classIDKey>
-Factory<manufacturedObj, classIDKey>::Factory()
+template <class manufacturedObj, typename classIDKey, typename paramType>
+Factory<manufacturedObj, classIDKey, paramType>::Factory()
 {
 }
 
-template <class manufacturedObj, typename classIDKey>
-Factory<manufacturedObj, classIDKey> &Factory<manufacturedObj, classIDKey>::instance()
+template <class manufacturedObj, typename classIDKey, typename paramType>
+Factory<manufacturedObj, classIDKey, paramType> &Factory<manufacturedObj, classIDKey, paramType>::instance()
 {
     // Note that this is not thread-safe!
     static Factory theInstance;
@@ -175,16 +184,16 @@ Factory<manufacturedObj, classIDKey> &Factory<manufacturedObj, classIDKey>::inst
 // Register the creation function.  This simply associates the classIDKey
 // with the function used to create the class.  The return value is a dummy
 // value, which is used to allow static initialization of the registry.
-template <class manufacturedObj, typename classIDKey>
-void Factory<manufacturedObj, classIDKey>::regCreateFn(const classIDKey &clName, BASE_CREATE_FN func)
+template <class manufacturedObj, typename classIDKey, typename paramType>
+void Factory<manufacturedObj, classIDKey, paramType>::regCreateFn(const classIDKey &clName, BASE_CREATE_FN func)
 {
     registry[clName]=func;
 }
 
 // The create function simple looks up the class ID, and if it's in the list,
 // the statement "(*i).second();" calls the function.
-template <class manufacturedObj, typename classIDKey>
-std::unique_ptr<manufacturedObj> Factory<manufacturedObj, classIDKey>::create(const classIDKey &className, std::vector<std::string> &parms) const
+template <class manufacturedObj, typename classIDKey, typename paramType>
+std::unique_ptr<manufacturedObj> Factory<manufacturedObj, classIDKey, paramType>::create(const classIDKey &className, paramType &parms) const
 {
     std::unique_ptr<manufacturedObj> ret(nullptr);
     typename FN_REGISTRY::const_iterator regEntry=registry.find(className);
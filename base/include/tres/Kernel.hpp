@@ -40,6 +40,7 @@
 #define TRES_KERNEL_HDR
 #include <map>
 #include <vector>
+#include <tres/BinaryIO.hpp>
 #include <tres/RTOSEvent.hpp>
 
 namespace tres
@@ -94,6 +95,16 @@ namespace tres
          */
         virtual int getNextWakeUpTime() = 0;
 
+        /**
+         * \brief Return the RT-Simulator time before which the outputs of the Kernel
+         * cannot change
+         *
+         * No task is triggered before that time, unless aperiodic activations are
+         * requested meanwhile: the host simulator can step up to it. By default, the
+         * next wake-up time.
+         */
+        virtual int getQuiescentHorizon() { return getNextWakeUpTime(); }
+
         /**
          * \brief Update the list of running tasks
          */
@@ -150,8 +161,41 @@ namespace tres
          */
         const std::string& getName();
 
+        /**
+         * \brief Save the state of the kernel
+         *
+         * The snapshot holds the trigger state of the kernel followed by the
+         * state of the scheduling engine (see saveEngineState()); it can be
+         * restored by loadState() into a kernel built from the same
+         * configuration, e.g. to branch several simulations from a common
+         * prefix. The state of the tasks (see tres::Task) is saved separately.
+         *
+         * \throw BinaryIOExc if the engine does not support snapshots
+         */
+        void saveState(BinaryWriter &w);
+
+        /**
+         * \brief Restore a state saved by saveState()
+         *
+         * \throw BinaryIOExc if the snapshot is malformed or does not match
+         * the configuration of the kernel
+         */
+        void loadState(BinaryReader &r);
+
     protected:
 
+        /**
+         * \brief Save the state of the scheduling engine
+         *
+         * Snapshots are not supported by default
+         */
+        virtual void saveEngineState(BinaryWriter &w);
+
+        /**
+         * \brief Restore a state saved by saveEngineState()
+         */
+        virtual void loadEngineState(BinaryReader &r);
+
         /** Instance ID */
         std::string _kernel_name;
 
@@ -0,0 +1,215 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file KernelConfig.hpp
+ */
+
+#ifndef TRES_KERNELCONFIG_HDR
+#define TRES_KERNELCONFIG_HDR
+#include <string>
+#include <vector>
+#include "../../src/BaseExc.hpp"
+
+namespace tres
+{
+    class BinaryWriter;
+    class BinaryReader;
+
+    /**
+     * \addtogroup tres_base_rtos
+     * @{
+     */
+
+    /**
+     * \brief Exception raised for malformed kernel configurations
+     */
+    DECL_EXC(KernelConfigExc, "KernelConfig");
+
+    /**
+     * \brief Description of a task of the task-set
+     *
+     * Timing parameters are expressed in the time unit of the model
+     * (i.e., they are \em not yet scaled by the time resolution).
+     */
+    struct TaskConfig
+    {
+        /** Task type (e.g., "PeriodicTask", "AperiodicTask") */
+        std::string type;
+
+        /** Task name (univoque identifier) */
+        std::string name;
+
+        /** InterArrival Time (0 for aperiodic tasks) */
+        double iat;
+
+        /** Relative DeadLine */
+        double rdl;
+
+        /** Activation PHase */
+        double ph;
+
+        /**
+         * \brief Further parameters, as given by the user
+         *
+         * Their meaning is up to the engine (e.g., the RTSim kernel gives
+         * the first one, if any, to RTSim as the priority of the task)
+         */
+        std::vector<std::string> params;
+
+        TaskConfig() : iat(0), rdl(0), ph(0) {}
+
+        /**
+         * \brief Read a further parameter as a number
+         *
+         * Returns false if the parameter is missing or empty.
+         *
+         * \throw KernelConfigExc if the parameter is not a number
+         */
+        bool getNumericParam(std::vector<std::string>::size_type i, double &value) const;
+
+        /**
+         * \brief Returns true for aperiodic tasks ("Task" is the RTSim name)
+         */
+        bool isAperiodic() const { return type == "AperiodicTask" || type == "Task"; }
+    };
+
+    /**
+     * \brief Description of the scheduling policy
+     */
+    struct SchedulerConfig
+    {
+        /** Policy (e.g., "EDF", "FIXED_PRIORITY", "DEADLINE_MONOTONIC" or a custom one) */
+        std::string policy;
+
+        /** Further parameters of custom policies (as given by the user) */
+        std::vector<std::string> params;
+    };
+
+    /**
+     * \brief Typed configuration of a tres::Kernel
+     *
+     * The configuration is parsed and validated once, and then handed to the
+     * concrete kernel implementations through the
+     * Factory<Kernel, Kernel::BASE_KEY_TYPE, const KernelConfig> registry.
+     */
+    struct KernelConfig
+    {
+        /** The task-set */
+        std::vector<TaskConfig> tasks;
+
+        /** The scheduling policy */
+        SchedulerConfig scheduler;
+
+        /** Number of CPU cores */
+        int num_cores;
+
+        /** Time resolution (number of simulator ticks per model time unit) */
+        double time_resolution;
+
+        /** Name (UID) of the kernel instance */
+        std::string name;
+
+        /**
+         * \brief Standard random generator of the simulation
+         *
+         * The name of a generator of the RandomGen factory (e.g., "minstd",
+         * "xoshiro256**", "pcg64"), or empty to keep the current one
+         */
+        std::string generator;
+
+        /** Seed of the generator */
+        long long seed;
+
+        KernelConfig() : num_cores(1), time_resolution(1.0), seed(1) {}
+
+        /**
+         * \brief Check the consistency of the configuration
+         *
+         * Non-null inter-arrival times and deadlines must also be at least
+         * half a tick at the time resolution (they would round to 0).
+         *
+         * \throw KernelConfigExc if the configuration is not valid
+         */
+        void validate() const;
+
+        /**
+         * \brief Make the generator of the configuration (if any) the
+         * standard one of the random variables
+         *
+         * See RandomVar::selectGenerator(). The kernels call this when
+         * they are built: the variables created afterwards (e.g., the
+         * execution times of the tasks) draw from the new generator.
+         *
+         * \throw KernelConfigExc if no generator is registered with that name
+         */
+        void selectGenerator() const;
+
+        /**
+         * \brief Build the configuration from its string form
+         *
+         * This is the input adapter for the vector-of-strings descriptions
+         * used by the Factory<Kernel> creators, i.e.:
+         *   - the number of tasks in the task-set (#tasks) - std::string (1)
+         *   - the task-set description                     - std::string (#tasks)
+         *     ("type;name;iat;rdl;ph;[param;]...")
+         *   - the scheduling policy description            - std::string (1)
+         *     ("policy;[param;]...")
+         *   - the number of CPU cores                      - std::string (1)
+         *   - the time resolution                          - std::string (1)
+         *   - the name (UID) of the kernel instance        - std::string (1)
+         *   - the random generator (optional)              - std::string (1)
+         *     ("name;[seed;]")
+         *
+         * The returned configuration is already validated. If the
+         * tres::ModelCache is enabled, the parsed configuration is looked
+         * up there (by the hash of the description) before parsing.
+         *
+         * \throw KernelConfigExc if the description is not valid
+         */
+        static KernelConfig fromStrings(const std::vector<std::string> &);
+
+        /**
+         * \brief Write the binary image of the configuration
+         */
+        void serialize(BinaryWriter &) const;
+
+        /**
+         * \brief Read a configuration from its binary image
+         */
+        static KernelConfig deserialize(BinaryReader &);
+    };
+    /** @} */
+}
+#endif // TRES_KERNELCONFIG_HDR
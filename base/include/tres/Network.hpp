@@ -70,6 +70,15 @@ namespace tres
          */
         virtual ~Network() = default;
 
+        /**
+         * \brief Release the instance at the end of a simulation
+         *
+         * By default the instance is destroyed. Adapters with an expensive
+         * set-up may instead keep it, to restart it when a network with the
+         * same configuration is requested again.
+         */
+        virtual void dispose() { delete this; }
+
         /**
          * \brief Process the next simulation step
          */
@@ -93,6 +102,15 @@ namespace tres
          */
         virtual int getNextWakeUpTime() = 0;
 
+        /**
+         * \brief Return the time before which the outputs of the tres::Network
+         * instance cannot change
+         *
+         * No message is delivered before that time, unless new messages are sent
+         * meanwhile. By default, the time of the next event.
+         */
+        virtual int getQuiescentHorizon() { return getTimeOfNextEvent(); }
+
         /**
          * \brief Add a message to the trigger queue
          */
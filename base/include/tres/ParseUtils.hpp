@@ -44,6 +44,10 @@
 
 #ifndef TRES_PARSEUTILS_HDR
 #define TRES_PARSEUTILS_HDR
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 #include <vector>
 #include "../../src/BaseExc.hpp"
 
@@ -58,6 +62,157 @@
  */
 namespace tres_parse_utils
 {
+    /**
+     * \brief A non-owning, read-only view of a sequence of characters
+     *
+     * A str_slice refers to (a part of) a string owned by someone else,
+     * which must outlive the slice. The member functions have the same
+     * semantics as the homonymous std::string ones, so the slice-based
+     * parse functions below return exactly the same substrings as the
+     * std::string-based ones, without allocating memory.
+     */
+    class str_slice
+    {
+
+    public:
+
+        typedef std::size_t size_type;
+        typedef const char *const_iterator;
+
+        static const size_type npos = static_cast<size_type>(-1);
+
+        str_slice() : _data(""), _size(0) {}
+
+        str_slice(const char *d, size_type n) : _data(d), _size(n) {}
+
+        explicit str_slice(const char *s) : _data(s), _size(std::strlen(s)) {}
+
+        explicit str_slice(const std::string &s) : _data(s.data()), _size(s.size()) {}
+
+        const char *data() const { return _data; }
+
+        size_type size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        const_iterator begin() const { return _data; }
+
+        const_iterator end() const { return _data + _size; }
+
+        char operator[](size_type i) const { return _data[i]; }
+
+        /**
+         * \brief Returns a copy of the slice as a std::string
+         */
+        std::string str() const { return std::string(_data, _size); }
+
+        /**
+         * \brief Returns the sub-slice [pos, pos+n), clamped to the end
+         *
+         * \throw std::out_of_range if pos > size() (as std::string::substr)
+         */
+        str_slice substr(size_type pos, size_type n = npos) const
+        {
+            if (pos > _size)
+                throw std::out_of_range("str_slice::substr");
+            return str_slice(_data + pos, n < _size - pos ? n : _size - pos);
+        }
+
+        size_type find(char c, size_type pos = 0) const
+        {
+            for (; pos < _size; ++pos)
+                if (_data[pos] == c)
+                    return pos;
+            return npos;
+        }
+
+        size_type find(const str_slice &s, size_type pos = 0) const
+        {
+            if (s._size > _size || pos > _size - s._size)
+                return npos;
+            for (; pos <= _size - s._size; ++pos)
+                if (std::memcmp(_data + pos, s._data, s._size) == 0)
+                    return pos;
+            return npos;
+        }
+
+        size_type find_first_of(const str_slice &s, size_type pos = 0) const
+        {
+            for (; pos < _size; ++pos)
+                if (s.find(_data[pos]) != npos)
+                    return pos;
+            return npos;
+        }
+
+        size_type find_first_not_of(const str_slice &s, size_type pos = 0) const
+        {
+            for (; pos < _size; ++pos)
+                if (s.find(_data[pos]) == npos)
+                    return pos;
+            return npos;
+        }
+
+        size_type find_last_of(const str_slice &s) const
+        {
+            for (size_type i = _size; i-- > 0; )
+                if (s.find(_data[i]) != npos)
+                    return i;
+            return npos;
+        }
+
+        size_type find_last_not_of(char c) const
+        {
+            for (size_type i = _size; i-- > 0; )
+                if (_data[i] != c)
+                    return i;
+            return npos;
+        }
+
+        bool operator==(const str_slice &s) const
+        {
+            return _size == s._size && std::memcmp(_data, s._data, _size) == 0;
+        }
+
+        bool operator!=(const str_slice &s) const { return !(*this == s); }
+
+        bool operator==(const char *s) const { return *this == str_slice(s); }
+
+        bool operator!=(const char *s) const { return !(*this == str_slice(s)); }
+
+    private:
+
+        const char *_data;
+        size_type _size;
+    };
+
+    /**
+     * \brief Single-pass tokenizer for strings of substrings terminated by
+     * a separator (';' by default)
+     *
+     * Each call to next() returns the next substring (without spaces at the
+     * beginning and at the end). As with split_instr(), a trailing substring
+     * which is not terminated by the separator is ignored.
+     */
+    class instr_tokenizer
+    {
+
+    public:
+
+        explicit instr_tokenizer(str_slice code, char sep = ';')
+            : _code(code), _pos(0), _sep(sep) {}
+
+        /**
+         * \brief Extracts the next substring in tok; returns false at the end
+         */
+        bool next(str_slice &tok);
+
+    private:
+
+        str_slice _code;
+        str_slice::size_type _pos;
+        char _sep;
+    };
+
     /**
      * \brief Removes trailing spaces from the beginning and from the end of
      * the input string
@@ -110,6 +265,44 @@ namespace tres_parse_utils
      */
     void parse_double(const std::string &nums, double &res, std::string &unit);
 
+    /**
+     * \name Allocation-free versions of the functions above
+     *
+     * The returned slices refer to the input, and the vector versions
+     * clear and fill the vector provided by the caller (so that its
+     * capacity can be reused across calls).
+     * @{
+     */
+    str_slice remove_spaces(str_slice);
+
+    void split(str_slice, str_slice sep, std::vector<str_slice> &out);
+
+    void split_instr(str_slice, std::vector<str_slice> &out);
+
+    str_slice get_token(str_slice, str_slice open_par = str_slice("("));
+
+    str_slice get_param(str_slice, str_slice open_par = str_slice("("),
+                        str_slice close_par = str_slice(")"));
+
+    void split_param(str_slice, std::vector<str_slice> &out, str_slice sep = str_slice(","),
+                     char open_par = '(', char close_par = ')');
+
+    /**
+     * \brief Converts the slices into the strings expected by the factories
+     */
+    void to_strings(const std::vector<str_slice> &in, std::vector<std::string> &out);
+
+    /**
+     * \brief Same as atof() on a copy of the slice
+     */
+    double to_double(str_slice);
+
+    /**
+     * \brief Same as atoi() on a copy of the slice
+     */
+    int to_int(str_slice);
+    /** @} */
+
     /**
      * \brief Exception raised by the above functions
      */
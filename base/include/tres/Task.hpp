@@ -41,7 +41,7 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include "../../src/Segment.hpp"
+#include "../../src/RandExecSegment.hpp"
 
 namespace tres
 {
@@ -63,7 +63,7 @@ namespace tres
         /**
          * \brief The virtual destructor
          */
-        virtual ~Task() = default;
+        virtual ~Task();
 
         /**
          * \brief Construct a Task object and assign it a sequence of pseudo instructions
@@ -86,17 +86,80 @@ namespace tres
          */
         double getSegmentDuration() const;
 
+        /**
+         * \brief Get the worst-case execution time of a job (the sum of the
+         * worst-case execution times of the pseudo instructions)
+         *
+         * \throw RandomVar::MaxException if the duration of an instruction is
+         * not bounded
+         */
+        double getWCET() const;
+
+        /**
+         * \brief Save the state of the task (the current instruction and the
+         * state of the pseudo instructions)
+         */
+        void saveState(BinaryWriter &w) const;
+
+        /**
+         * \brief Restore a state saved by saveState()
+         *
+         * \throw BinaryIOExc if the state was saved by a task with a
+         * different number of pseudo instructions
+         */
+        void loadState(BinaryReader &r);
+
     protected:
 
+        /**
+         * \brief A segment of the task body
+         *
+         * Fixed-duration segments are stored just as their duration;
+         * the others keep the Segment object, which is called without
+         * virtual dispatch when it is a RandExecSegment
+         */
+        struct _Slot
+        {
+            enum Kind { FIXED, RANDOM, OTHER };
+
+            /** Kind of segment */
+            Kind kind;
+
+            /** Duration (FIXED segments only) */
+            double duration;
+
+            /** The segment (owned by the task; NULL for FIXED segments) */
+            Segment *seg;
+        };
+
+        /** Get the duration of the next execution of a segment */
+        static double nextDuration(const _Slot &s)
+        {
+            switch (s.kind)
+            {
+            case _Slot::FIXED:
+                return s.duration;
+            case _Slot::RANDOM:
+                return static_cast<const RandExecSegment *>(s.seg)->nextSample();
+            default:
+                return s.seg->getDuration();
+            }
+        }
+
         /** Sequence of segments representing the task body */
-        std::vector<Segment*> _segment_q;
+        std::vector<_Slot> _segment_q;
 
-        /** Pointer to the segment which is being executed */
-        std::vector<Segment*>::iterator _run_seg;
+        /** Index of the segment which is being executed */
+        std::vector<_Slot>::size_type _run_seg;
 
         /** Total computation time of the current instruction */
         double _run_seg_duration;
 
+    private:
+
+        Task(const Task&);
+        Task& operator=(const Task&);
+
     };
     /** @} */
 }
@@ -0,0 +1,110 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file AliasTable.cpp
+ */
+
+#include "AliasTable.hpp"
+#include "BaseExc.hpp"
+
+namespace tres
+{
+    AliasTable::AliasTable()
+    {
+    }
+
+    void AliasTable::build(const std::vector<double> &values, const std::vector<double> &weights)
+    {
+        const std::size_t n = values.size();
+        if (n == 0 || weights.size() != n)
+            throw BaseExc("Malformed distribution", "AliasTable", "AliasTable");
+
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            if (weights[i] < 0)
+                throw BaseExc("Negative weight in distribution", "AliasTable", "AliasTable");
+            sum += weights[i];
+        }
+        if (sum <= 0)
+            throw BaseExc("Distribution weights sum to 0", "AliasTable", "AliasTable");
+
+        // Scale the weights so that the mean is 1, then split the
+        // columns into under-full (< 1) and over-full (>= 1) ones
+        std::vector<double> scaled(n);
+        std::vector<std::size_t> small, large;
+        small.reserve(n);
+        large.reserve(n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            scaled[i] = weights[i] * n / sum;
+            if (scaled[i] < 1.0)
+                small.push_back(i);
+            else
+                large.push_back(i);
+        }
+
+        _table.assign(n, _Column());
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            _table[i].value = values[i];
+            _table[i].alias = values[i];
+        }
+
+        // Fill every under-full column with the excess of an over-full one
+        while (!small.empty() && !large.empty())
+        {
+            std::size_t s = small.back();
+            small.pop_back();
+            std::size_t l = large.back();
+
+            _table[s].prob = scaled[s];
+            _table[s].alias = values[l];
+
+            scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+            if (scaled[l] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+
+        // What's left is full up to rounding errors
+        for (std::size_t i = 0; i < large.size(); ++i)
+            _table[large[i]].prob = 1.0;
+        for (std::size_t i = 0; i < small.size(); ++i)
+            _table[small[i]].prob = 1.0;
+    }
+}
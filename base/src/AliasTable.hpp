@@ -0,0 +1,119 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file AliasTable.hpp
+ */
+
+#ifndef TRES_ALIASTABLE_HDR
+#define TRES_ALIASTABLE_HDR
+#include <cstddef>
+#include <vector>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+    /**
+     * \brief Walker/Vose alias table for sampling discrete distributions in O(1)
+     *
+     * The table is built once from a list of (value, weight) pairs. Each
+     * sample costs two uniform numbers in [0,1): the first one selects a
+     * column, the second one decides between the value of the column and
+     * its alias. Columns are stored contiguously, so a sample touches a
+     * single entry of the table regardless of the number of values.
+     */
+    class AliasTable
+    {
+
+    public:
+
+        /**
+         * \brief Construct an empty table
+         */
+        AliasTable();
+
+        /**
+         * \brief Build the table for the given values and (non-normalized) weights
+         *
+         * \note Weights must be non-negative and must not sum to 0
+         */
+        void build(const std::vector<double> &values, const std::vector<double> &weights);
+
+        /**
+         * \brief Extract a value given two uniform numbers in [0,1)
+         */
+        double sample(double u1, double u2) const
+        {
+            std::size_t i = static_cast<std::size_t>(u1 * _table.size());
+            if (i >= _table.size())
+                i = _table.size() - 1;
+            const _Column &c = _table[i];
+            return (u2 < c.prob) ? c.value : c.alias;
+        }
+
+        /**
+         * \brief Get the number of columns (values) in the table
+         */
+        std::size_t size() const { return _table.size(); }
+
+        /**
+         * \brief Check if the table has been built
+         */
+        bool empty() const { return _table.empty(); }
+
+    private:
+
+        /**
+         * \brief A column of the table
+         */
+        struct _Column
+        {
+            /** Probability of returning \ref value rather than \ref alias */
+            double prob;
+            /** The value owning the column */
+            double value;
+            /** The value of the alias column */
+            double alias;
+        };
+
+        /** The columns of the table */
+        std::vector<_Column> _table;
+
+    };
+    /** @} */
+}
+#endif // TRES_ALIASTABLE_HDR
@@ -0,0 +1,119 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file Arena.cpp
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <tres/Arena.hpp>
+
+namespace tres
+{
+    /** Round p up to a multiple of align (a power of 2) */
+    static inline std::uintptr_t alignUp(std::uintptr_t p, std::size_t align)
+    {
+        return (p + align - 1) & ~static_cast<std::uintptr_t>(align - 1);
+    }
+
+    Arena::Arena(std::size_t block_size) :
+        _block_size(block_size), _blocks(NULL), _cur(NULL), _end(NULL), _finalizers(NULL)
+    {
+        _stats.allocations = 0;
+        _stats.bytes = 0;
+        _stats.blocks = 0;
+        _stats.reserved = 0;
+        _stats.finalizers = 0;
+    }
+
+    Arena::~Arena()
+    {
+        release();
+    }
+
+    void Arena::grow(std::size_t size, std::size_t align)
+    {
+        std::size_t need = sizeof(_Block) + size + align;
+        std::size_t bsize = need > _block_size ? need : _block_size;
+        _Block *b = static_cast<_Block *>(std::malloc(bsize));
+        if (b == NULL)
+            throw std::bad_alloc();
+        b->next = _blocks;
+        b->size = bsize;
+        _blocks = b;
+        _cur = reinterpret_cast<char *>(b + 1);
+        _end = reinterpret_cast<char *>(b) + bsize;
+        ++_stats.blocks;
+        _stats.reserved += bsize;
+    }
+
+    void* Arena::allocate(std::size_t size, std::size_t align)
+    {
+        std::uintptr_t p = alignUp(reinterpret_cast<std::uintptr_t>(_cur), align);
+        if (_cur == NULL || p + size > reinterpret_cast<std::uintptr_t>(_end))
+        {
+            grow(size, align);
+            p = alignUp(reinterpret_cast<std::uintptr_t>(_cur), align);
+        }
+        _stats.bytes += p + size - reinterpret_cast<std::uintptr_t>(_cur);
+        ++_stats.allocations;
+        _cur = reinterpret_cast<char *>(p + size);
+        return _cur - size;
+    }
+
+    void Arena::release()
+    {
+        // Destructors first (in reverse order of construction), as
+        // objects may still refer to each other
+        while (_finalizers != NULL)
+        {
+            _Finalizer *f = _finalizers;
+            _finalizers = f->next;
+            f->destroy(f->obj);
+        }
+        while (_blocks != NULL)
+        {
+            _Block *b = _blocks;
+            _blocks = b->next;
+            std::free(b);
+        }
+        _cur = _end = NULL;
+        _stats.allocations = 0;
+        _stats.bytes = 0;
+        _stats.blocks = 0;
+        _stats.reserved = 0;
+        _stats.finalizers = 0;
+    }
+}
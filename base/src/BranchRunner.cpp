@@ -0,0 +1,210 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file BranchRunner.cpp
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <tres/BranchRunner.hpp>
+#include "RandomVar.hpp"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace tres
+{
+    BranchRunner::BranchRunner(std::size_t branches, std::size_t fields, RandNum seed,
+                               std::size_t max_children) :
+        _branches(branches), _fields(fields), _seed(seed), _max_children(max_children),
+        _shm(NULL), _shm_size(0), _completed(branches, false)
+    {
+        if (_max_children == 0)
+            _max_children = std::max(1u, std::thread::hardware_concurrency());
+#ifndef _WIN32
+        _shm_size = branches * (sizeof(uint64_t) + fields * sizeof(double));
+        if (_shm_size > 0)
+        {
+            _shm = mmap(NULL, _shm_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+            if (_shm == MAP_FAILED)
+            {
+                _shm = NULL;
+                throw BranchRunnerExc(std::string("Cannot map the shared memory: ") + strerror(errno));
+            }
+        }
+#endif
+    }
+
+    BranchRunner::~BranchRunner()
+    {
+#ifndef _WIN32
+        if (_shm != NULL)
+            munmap(_shm, _shm_size);
+#endif
+    }
+
+    bool BranchRunner::completed(std::size_t branch) const
+    {
+        return _completed[branch];
+    }
+
+    const double *BranchRunner::result(std::size_t branch) const
+    {
+        const uint64_t *flags = static_cast<const uint64_t *>(_shm);
+        return reinterpret_cast<const double *>(flags + _branches) + branch * _fields;
+    }
+
+#ifndef _WIN32
+    std::size_t BranchRunner::run(const Body &body)
+    {
+        uint64_t *flags = static_cast<uint64_t *>(_shm);
+        double *results = reinterpret_cast<double *>(flags + _branches);
+        if (_shm != NULL)
+            memset(_shm, 0, _shm_size);
+        _completed.assign(_branches, false);
+
+        // Buffered output would be written by every child
+        std::cout.flush();
+        std::cerr.flush();
+        fflush(NULL);
+
+        std::size_t done = 0;
+        std::deque<std::pair<pid_t, std::size_t> > live;
+        auto reap = [&]()
+        {
+            std::pair<pid_t, std::size_t> c = live.front();
+            live.pop_front();
+            int status = 0;
+            while (waitpid(c.first, &status, 0) < 0 && errno == EINTR)
+                ;
+            _completed[c.second] = WIFEXITED(status) && WEXITSTATUS(status) == 0 && flags[c.second] == 1;
+            if (_completed[c.second])
+                ++done;
+        };
+
+        for (std::size_t b = 0; b < _branches; ++b)
+        {
+            while (live.size() >= _max_children)
+                reap();
+
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                const int err = errno;
+                while (!live.empty())
+                    reap();
+                throw BranchRunnerExc(std::string("Cannot fork a branch: ") + strerror(err));
+            }
+            if (pid == 0)
+            {
+                // The branch: its own random stream, then the body
+                int code = 1;
+                try
+                {
+                    RandomVar::reseed(_seed, b);
+                    body(b, results + b * _fields);
+                    flags[b] = 1;
+                    code = 0;
+                }
+                catch (std::exception &e)
+                {
+                    std::cerr << "Branch " << b << " failed: " << e.what() << std::endl;
+                }
+                catch (...)
+                {
+                    std::cerr << "Branch " << b << " failed" << std::endl;
+                }
+
+                // Leave without running the destructors of the state
+                // shared with the parent
+                std::cout.flush();
+                std::cerr.flush();
+                fflush(NULL);
+                _exit(code);
+            }
+            live.push_back(std::make_pair(pid, b));
+        }
+        while (!live.empty())
+            reap();
+        return done;
+    }
+#else
+    std::size_t BranchRunner::run(const Body &)
+    {
+        throw BranchRunnerExc("Branching is not supported on this platform");
+    }
+#endif
+
+    BranchRunner::Summary BranchRunner::summarize(std::size_t field) const
+    {
+        Summary s;
+        s.count = 0;
+        s.min = s.max = s.mean = s.stddev = std::numeric_limits<double>::quiet_NaN();
+
+        // Welford's algorithm
+        double m2 = 0;
+        for (std::size_t b = 0; b < _branches; ++b)
+        {
+            if (!_completed[b])
+                continue;
+            const double v = result(b)[field];
+            if (s.count++ == 0)
+            {
+                s.min = s.max = s.mean = v;
+                continue;
+            }
+            s.min = std::min(s.min, v);
+            s.max = std::max(s.max, v);
+            const double d = v - s.mean;
+            s.mean += d / s.count;
+            m2 += d * (v - s.mean);
+        }
+        if (s.count > 0)
+            s.stddev = (s.count > 1) ? std::sqrt(m2 / (s.count - 1)) : 0;
+        return s;
+    }
+}
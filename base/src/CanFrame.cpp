@@ -0,0 +1,85 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file CanFrame.cpp
+ */
+
+#include <cstdlib>
+#include <tres/CanFrame.hpp>
+
+namespace tres
+{
+    bool parseCanStuffing(const std::string &value, CanStuffing &mode)
+    {
+        if (value == "worst")
+            mode = CAN_STUFF_WORST;
+        else if (value == "exact")
+            mode = CAN_STUFF_EXACT;
+        else if (value == "none")
+            mode = CAN_STUFF_NONE;
+        else
+            return false;
+        return true;
+    }
+
+    bool parseCanIdentifier(const std::string &uid, uint32_t &id, bool &extended)
+    {
+        std::string hex = (uid.compare(0, 2, "0x") == 0 || uid.compare(0, 2, "0X") == 0) ? uid.substr(2) : uid;
+        char *end;
+        unsigned long v = std::strtoul(hex.c_str(), &end, 16);
+        if (hex.empty() || *end != '\0' || v > 0x1fffffffUL)
+            return false;
+        id = static_cast<uint32_t>(v);
+        extended = (hex.size() > 3 || v > 0x7ff);
+        return true;
+    }
+
+    uint64_t canArbitrationKey(uint32_t id, bool extended)
+    {
+        // Base identifier, then SRR/IDE (recessive in extended frames),
+        // then the identifier extension
+        if (extended)
+            return (static_cast<uint64_t>(id >> 18) << 19) | (1ULL << 18) | (id & 0x3ffff);
+        return static_cast<uint64_t>(id) << 19;
+    }
+
+    int canFrameBits(bool extended, int dlc, bool stuffing)
+    {
+        // The bits subject to stuffing (SOF to CRC), the worst-case stuff
+        // bits, then CRC delimiter, ACK, EOF and inter-frame space
+        int g = (extended ? 54 : 34) + 8 * dlc;
+        return g + 13 + (stuffing ? (g - 1) / 4 : 0);
+    }
+}
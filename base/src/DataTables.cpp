@@ -0,0 +1,342 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file DataTables.cpp
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+#include <tres/ParseUtils.hpp>
+#include "DataTables.hpp"
+#include "ModelCache.hpp"
+#include "RandomVar.hpp"
+
+namespace tres
+{
+    using namespace std;
+    using namespace tres_parse_utils;
+
+    static const double PDF_ERR = 0.00000000001;
+
+    /** Kinds of interned tables (the PDF mode is added to PDF_KIND) */
+    static const int PDF_KIND = 0;
+    static const int TRACE_KIND = 16;
+
+    /**
+     * \brief Scans the tokens (separated by white spaces) of a buffer
+     */
+    class _TokenScanner
+    {
+
+    public:
+
+        _TokenScanner(const char *data, size_t size) : _p(data), _end(data + size) {}
+
+        bool next(str_slice &tok)
+        {
+            while (_p != _end && isSpace(*_p))
+                ++_p;
+            if (_p == _end)
+                return false;
+            const char *b = _p;
+            while (_p != _end && !isSpace(*_p))
+                ++_p;
+            tok = str_slice(b, _p - b);
+            return true;
+        }
+
+    private:
+
+        static bool isSpace(char c)
+        {
+            return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+        }
+
+        const char *_p;
+        const char *_end;
+    };
+
+    /** Convert a (whole) token into a double */
+    static bool toDouble(str_slice t, double &v)
+    {
+        char buf[64];
+        if (t.size() >= sizeof(buf))
+            return false;
+        memcpy(buf, t.data(), t.size());
+        buf[t.size()] = '\0';
+        char *end;
+        v = strtod(buf, &end);
+        return end != buf && *end == '\0';
+    }
+
+    /** Read the numbers in a file; throw on malformed content */
+    static void readNumbers(const MappedFile &f, vector<double> &out, const string &path, const char *cl)
+    {
+        _TokenScanner sc(f.data(), f.size());
+        str_slice tok;
+        double v;
+        while (sc.next(tok))
+        {
+            if (!toDouble(tok, v))
+                throw RandomVar::Exc(string(RandomVar::Exc::_WRONGPDF) + " in " + path + "\n", cl);
+            out.push_back(v);
+        }
+    }
+
+    /** Hash of the content of a file plus a tag (for use with ModelCache) */
+    static uint64_t cacheKey(const MappedFile &f, int tag)
+    {
+        uint64_t h = fnv1a(f.data(), f.size());
+        return fnv1a(&tag, sizeof(tag), h);
+    }
+
+    /** Drop the entries of the tables no longer referenced */
+    template <typename Map>
+    static void prune(Map &tables)
+    {
+        for (typename Map::iterator i = tables.begin(); i != tables.end(); )
+        {
+            if (i->second.expired())
+                tables.erase(i++);
+            else
+                ++i;
+        }
+    }
+
+    bool DataTables::_Key::operator<(const _Key &k) const
+    {
+        if (kind != k.kind) return kind < k.kind;
+        if (mtime != k.mtime) return mtime < k.mtime;
+        if (mtime_ns != k.mtime_ns) return mtime_ns < k.mtime_ns;
+        if (size != k.size) return size < k.size;
+        if (inode != k.inode) return inode < k.inode;
+        return path < k.path;
+    }
+
+    bool DataTables::makeKey(int kind, const string &path, _Key &key)
+    {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0)
+            return false;
+        key.kind = kind;
+        key.path = path;
+        key.mtime = static_cast<long long>(st.st_mtime);
+#if defined(_WIN32)
+        key.mtime_ns = 0;
+#elif defined(__APPLE__)
+        key.mtime_ns = static_cast<long long>(st.st_mtimespec.tv_nsec);
+#else
+        key.mtime_ns = static_cast<long long>(st.st_mtim.tv_nsec);
+#endif
+        key.size = static_cast<long long>(st.st_size);
+        key.inode = static_cast<unsigned long long>(st.st_ino);
+        return true;
+    }
+
+    DataTables &DataTables::instance()
+    {
+        static DataTables theInstance;
+        return theInstance;
+    }
+
+    shared_ptr<const PdfTable> DataTables::pdf(const string &path, int mode)
+    {
+        lock_guard<mutex> lock(_mutex);
+
+        // Look for the table among the interned ones
+        _Key key;
+        if (!makeKey(PDF_KIND + mode, path, key))
+            throw RandomVar::Exc(RandomVar::Exc::_FILEOPEN + path + "\n", "GenericVar");
+        shared_ptr<const PdfTable> t;
+        auto i = _pdfs.find(key);
+        if (i != _pdfs.end())
+            t = i->second.lock();
+        if (t)
+            return t;
+
+        // A miss: forget the tables (and the versions of the files) no
+        // longer in use
+        prune(_pdfs);
+
+        MappedFile f;
+        if (!f.open(path))
+            throw RandomVar::Exc(RandomVar::Exc::_FILEOPEN + path + "\n", "GenericVar");
+
+        shared_ptr<PdfTable> pdf = make_shared<PdfTable>();
+
+        // Look for the parsed PDF in the model cache
+        ModelCache &cache = ModelCache::instance();
+        uint64_t ckey = cache.enabled() ? cacheKey(f, PDF_KIND + mode) : 0;
+        MappedFile img;
+        const char *payload;
+        size_t size;
+        bool cached = false;
+        if (cache.enabled() && cache.load(ModelCache::PDF_TABLE, ckey, img, payload, size))
+        {
+            try
+            {
+                BinaryReader r(payload, size);
+                r.getVector(pdf->values);
+                r.getVector(pdf->probs);
+                cached = r.atEnd() && pdf->values.size() == pdf->probs.size();
+            }
+            catch (BinaryIOExc &)
+            {
+                // Malformed entry: rebuild it
+            }
+        }
+
+        if (!cached)
+        {
+            // Parse the "value probability" pairs
+            pdf->values.clear();
+            pdf->probs.clear();
+            vector<double> nums;
+            readNumbers(f, nums, path, "GenericVar");
+            if (nums.size() % 2 != 0)
+                throw RandomVar::Exc(string(RandomVar::Exc::_WRONGPDF) + " in " + path + "\n", "GenericVar");
+
+            // Values are integers (truncated, as they have always been
+            // read): each one must appear once
+            map<int, double> bins;
+            double sum = 0;
+            int n = 0;
+            for (size_t i = 0; i < nums.size(); i += 2)
+            {
+                n = static_cast<int>(nums[i]);
+                if (bins[n] != 0)
+                    throw RandomVar::Exc(string(RandomVar::Exc::_WRONGPDF) + " in " + path + "\n", "GenericVar");
+                bins[n] = nums[i+1];
+                sum += nums[i+1];
+            }
+
+            if (sum > 1 || bins.empty())
+                throw RandomVar::Exc(string(RandomVar::Exc::_WRONGPDF) + " in " + path + "\n", "GenericVar");
+
+            if (sum < (1.0 - PDF_ERR))
+            {
+                cerr << "Warning: PDF values in " << path << " sum to " << sum << " < 1\n";
+                if (mode == 0)
+                    bins[n] += (1 - sum);
+                else
+                    bins[1] += (1 - sum);
+            }
+
+            pdf->values.reserve(bins.size());
+            pdf->probs.reserve(bins.size());
+            for (map<int, double>::const_iterator i = bins.begin(); i != bins.end(); ++i)
+            {
+                pdf->values.push_back(i->first);
+                pdf->probs.push_back(i->second);
+            }
+
+            if (cache.enabled())
+            {
+                BinaryWriter w;
+                w.putVector(pdf->values);
+                w.putVector(pdf->probs);
+                cache.store(ModelCache::PDF_TABLE, ckey, w.data());
+            }
+        }
+
+        pdf->table.build(pdf->values, pdf->probs);
+        _pdfs[key] = pdf;
+        return pdf;
+    }
+
+    shared_ptr<const vector<double> > DataTables::trace(const string &path)
+    {
+        lock_guard<mutex> lock(_mutex);
+
+        // Look for the trace among the interned ones
+        _Key key;
+        if (!makeKey(TRACE_KIND, path, key))
+            throw RandomVar::Exc(RandomVar::Exc::_FILEOPEN + path + "\n", "DetVar");
+        shared_ptr<const vector<double> > t;
+        auto i = _traces.find(key);
+        if (i != _traces.end())
+            t = i->second.lock();
+        if (t)
+            return t;
+
+        // A miss: forget the tables (and the versions of the files) no
+        // longer in use
+        prune(_traces);
+
+        MappedFile f;
+        if (!f.open(path))
+            throw RandomVar::Exc(RandomVar::Exc::_FILEOPEN + path + "\n", "DetVar");
+
+        shared_ptr<vector<double> > trace = make_shared<vector<double> >();
+
+        // Look for the parsed trace in the model cache
+        ModelCache &cache = ModelCache::instance();
+        uint64_t ckey = cache.enabled() ? cacheKey(f, TRACE_KIND) : 0;
+        MappedFile img;
+        const char *payload;
+        size_t size;
+        bool cached = false;
+        if (cache.enabled() && cache.load(ModelCache::TRACE, ckey, img, payload, size))
+        {
+            try
+            {
+                BinaryReader r(payload, size);
+                r.getVector(*trace);
+                cached = r.atEnd();
+            }
+            catch (BinaryIOExc &)
+            {
+                // Malformed entry: rebuild it
+            }
+        }
+
+        if (!cached)
+        {
+            trace->clear();
+            readNumbers(f, *trace, path, "DetVar");
+            if (cache.enabled())
+            {
+                BinaryWriter w;
+                w.putVector(*trace);
+                cache.store(ModelCache::TRACE, ckey, w.data());
+            }
+        }
+
+        _traces[key] = trace;
+        return trace;
+    }
+}
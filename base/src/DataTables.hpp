@@ -0,0 +1,152 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file DataTables.hpp
+ *
+ * Loaders for the data files referenced by random variables (PDFs and
+ * traces of measured execution times). Files are mapped in memory and
+ * parsed once; the parsed tables are immutable and shared by all the
+ * variables referencing the same file.
+ */
+
+#ifndef TRES_DATATABLES_HDR
+#define TRES_DATATABLES_HDR
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "AliasTable.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+
+    /**
+     * \brief A discrete PDF read from a file
+     */
+    struct PdfTable
+    {
+        /** The values (sorted, and truncated to integers) */
+        std::vector<double> values;
+
+        /** The corresponding probabilities */
+        std::vector<double> probs;
+
+        /** The alias table used to sample the PDF */
+        AliasTable table;
+    };
+
+    /**
+     * \brief Process-wide registry of the parsed data files
+     *
+     * Tables are interned by path and modification time: as long as a table
+     * is referenced by some variable, loading the same (unmodified) file
+     * again returns the same table. Tables are released when the last
+     * reference goes away, and their entries are dropped at the next miss.
+     * A file rewritten in place with the same size is only detected if the
+     * file system records sub-second modification times. On a miss, the
+     * parsed content is also looked up in (and added to) the
+     * tres::ModelCache, if enabled.
+     *
+     * Loading is thread-safe.
+     */
+    class DataTables
+    {
+
+    public:
+
+        /**
+         * \brief Singleton access
+         */
+        static DataTables &instance();
+
+        /**
+         * \brief Get the PDF stored in a file
+         *
+         * The file contains pairs "value probability" separated by
+         * white spaces. Values are integers (non-integer ones are
+         * truncated). If the probabilities sum to less than 1, the
+         * residual probability is given to the last value (mode 0) or
+         * to the value 1 (mode 1).
+         *
+         * \throw RandomVar::Exc if the file cannot be read or is malformed
+         */
+        std::shared_ptr<const PdfTable> pdf(const std::string &path,
+                                            int mode = 0);
+
+        /**
+         * \brief Get the sequence of numbers stored in a file
+         *
+         * The file contains numbers separated by white spaces.
+         *
+         * \throw RandomVar::Exc if the file cannot be read or is malformed
+         */
+        std::shared_ptr<const std::vector<double> >
+        trace(const std::string &path);
+
+    private:
+
+        DataTables() {}
+
+        DataTables(const DataTables &);
+        DataTables &operator=(const DataTables &);
+
+        /** Key of the interned tables: kind, path, modification time
+         * (with the nanoseconds, where available), size and inode */
+        struct _Key
+        {
+            int kind;
+            std::string path;
+            long long mtime;
+            long long mtime_ns;
+            long long size;
+            unsigned long long inode;
+            bool operator<(const _Key &k) const;
+        };
+
+        /** Build the key of a file; returns false if it cannot be read */
+        static bool makeKey(int kind, const std::string &path, _Key &key);
+
+        std::mutex _mutex;
+        std::map<_Key, std::weak_ptr<const PdfTable> > _pdfs;
+        std::map<_Key, std::weak_ptr<const std::vector<double> > > _traces;
+    };
+    /** @} */
+}
+#endif // TRES_DATATABLES_HDR
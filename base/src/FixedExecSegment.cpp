@@ -42,7 +42,8 @@
 namespace tres
 {
     FixedExecSegment::FixedExecSegment(double duration) :
-        RandExecSegment(new DeltaVar(duration))
+        RandExecSegment(new DeltaVar(duration)),
+        _duration(duration)
     {
     }
 
@@ -50,4 +51,9 @@ namespace tres
     {
         return new FixedExecSegment(atof(par[0].c_str()));
     }
+
+    double FixedExecSegment::getDuration() const
+    {
+        return _duration;
+    }
 }
@@ -64,6 +64,19 @@ namespace tres
          */
         static Segment* createInstance(std::vector<std::string>&);
 
+        /**
+         * \brief Get the total computation time of the instruction
+         *
+         * \note The duration is constant, so it's returned as is without
+         * going through the buffer of prefetched samples
+         */
+        virtual double getDuration() const;
+
+    protected:
+
+        /** The (constant) duration of the segment */
+        double _duration;
+
     };
     /** @} */
 }
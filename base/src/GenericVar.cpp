@@ -36,8 +36,9 @@
  * \file GenericVar.cpp
  */
 
-#include <cmath>
+#include <algorithm>
 #include <tres/ParseUtils.hpp>
+#include "DataTables.hpp"
 #include "GenericVar.hpp"
 
 namespace tres
@@ -45,80 +46,32 @@ namespace tres
     using namespace std;
     using namespace tres_parse_utils;
 
-    static const double PDF_ERR = 0.00000000001;
-
-    void GenericVar::readPDF(ifstream &f, int mode)
-    {
-        int n;
-        double p;
-        double sum;
-
-        sum = 0;
-        while(!f.eof())
-        {
-            f >> n;
-            f >> p;
-            cout << n << "\t" << p << "\n";
-            if (!f.eof())
-            {
-                if (_pdf[n] != 0)
-                {
-                    string errMsg = Exc::_WRONGPDF + string("\n");
-                    throw Exc(errMsg, "GenericVar");
-                }
-                sum += p;
-                _pdf[n] = p;
-            }
-        }
-
-        if (sum > 1)
-        {
-            string errMsg = Exc::_WRONGPDF + string("\n");
-            throw Exc(errMsg, "GenericVar");
-        }
-
-        if (sum < (1.0 - PDF_ERR))
-        {
-            cerr << "Warning: PDF values sum to " << sum << " < 1\n";
-            if (mode == 0)
-                _pdf[n] += (1 - sum);
-            else
-                _pdf[1] += (1 - sum);
-        }
-    }    
-
     GenericVar::GenericVar(const std::string &fileName) : 
-        UniformVar(0, 1, NULL)
+        UniformVar(0, 1, NULL),
+        _pdf(DataTables::instance().pdf(fileName))
     {
-        ifstream inFile(fileName.c_str());
-
-        if (!inFile.is_open())
-        {
-            string errMsg = Exc::_FILEOPEN  + string(fileName) + "\n";
-            throw Exc(errMsg, "GenericVar");
-        }
-
-        readPDF(inFile);
     }
 
     double GenericVar::get()
     {
-        double v, CDF;
-        map<int, double>::iterator i;
-
-        v = UniformVar::get();
-        CDF = 0;
+        double u1 = UniformVar::get();
+        double u2 = UniformVar::get();
+        return _pdf->table.sample(u1, u2);
+    }
 
-        for(i = _pdf.begin(); i != _pdf.end(); i++)
+    void GenericVar::fill(double *out, size_t n)
+    {
+        // Two uniform samples per value, in the order of get()
+        double u[2 * FILL_CHUNK];
+        while (n > 0)
         {
-            CDF = CDF + i->second;
-            if (CDF > v)
-                return i->first;
+            size_t chunk = std::min<size_t>(n, FILL_CHUNK);
+            fillUniform(u, 2 * chunk);
+            for (size_t i = 0; i < chunk; ++i)
+                out[i] = _pdf->table.sample(u[2 * i], u[2 * i + 1]);
+            out += chunk;
+            n -= chunk;
         }
-
-        /* We cannot arrive here... */
-        /* It means that v > 1 or that lim_{i -> \infty} CDF < 1... */
-        throw Exc("Panic", "GenericVar");
     }
 
     RandomVar *GenericVar::createInstance(vector<string> &par)
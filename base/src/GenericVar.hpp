@@ -44,8 +44,8 @@
 
 #ifndef TRES_GENERICVAR_HDR
 #define TRES_GENERICVAR_HDR
-#include <iostream>
-#include <map>
+#include <memory>
+#include "DataTables.hpp"
 #include "RandomVar.hpp"
 
 namespace tres
@@ -56,6 +56,11 @@ namespace tres
      */
     /**
      * \brief Random variable used to model a generic distribution
+     *
+     * The PDF is read from a file and turned into an alias table, so that
+     * sampling takes constant time regardless of the number of bins. The
+     * table is shared with the other variables reading the same file
+     * (see DataTables)
      * \todo Add the doc to methods
      */
     class GenericVar: public UniformVar
@@ -67,13 +72,14 @@ namespace tres
         virtual ~GenericVar() {}
   
         virtual double get(void);
+        virtual void fill(double *out, size_t n);
 
         static RandomVar *createInstance(vector<string> &par);
 
     private:
 
-        std::map<int, double> _pdf;
-        void readPDF(std::ifstream &f, int mode = 0);// throw(Exc);
+        /** The PDF (shared by all the variables reading the same file) */
+        std::shared_ptr<const PdfTable> _pdf;
 
     };
     /** @} */
@@ -40,6 +40,10 @@
 
 namespace tres
 {
+    /** Tag of the kernel snapshots ("TRKS"), followed by the format version */
+    static const uint32_t STATE_MAGIC = 0x534b5254;
+    static const uint32_t STATE_VERSION = 1;
+
     void Kernel::addNewTasksToTriggerQueue()
     {
         for (auto task = _running_tasks.begin();
@@ -101,4 +105,55 @@ namespace tres
     {
         return _kernel_name;
     }
+
+    void Kernel::saveState(BinaryWriter &w)
+    {
+        w.put(STATE_MAGIC);
+        w.put(STATE_VERSION);
+        w.putString(_kernel_name);
+        w.put<uint64_t>(_tasks_to_trigger.size());
+        for (auto task = _tasks_to_trigger.begin(); task != _tasks_to_trigger.end(); ++task)
+            w.putString(*task);
+        w.put<uint64_t>(_running_tasks.size());
+        for (auto task = _running_tasks.begin(); task != _running_tasks.end(); ++task)
+            w.putString(*task);
+        w.put<uint64_t>(_jobs_status.size());
+        for (auto st = _jobs_status.begin(); st != _jobs_status.end(); ++st)
+        {
+            w.putString(st->first);
+            w.put<int32_t>(st->second);
+        }
+        saveEngineState(w);
+    }
+
+    void Kernel::loadState(BinaryReader &r)
+    {
+        if (r.get<uint32_t>() != STATE_MAGIC || r.get<uint32_t>() != STATE_VERSION)
+            throw BinaryIOExc("Not a kernel snapshot (or unsupported version)");
+        if (r.getString() != _kernel_name)
+            throw BinaryIOExc("The snapshot belongs to a different kernel");
+        _tasks_to_trigger.clear();
+        for (uint64_t n = r.get<uint64_t>(); n > 0; --n)
+            _tasks_to_trigger.push_back(r.getString());
+        _running_tasks.clear();
+        for (uint64_t n = r.get<uint64_t>(); n > 0; --n)
+            _running_tasks.push_back(r.getString());
+        _jobs_status.clear();
+        for (uint64_t n = r.get<uint64_t>(); n > 0; --n)
+        {
+            std::string task = r.getString();
+            _jobs_status[task] = r.get<int32_t>();
+        }
+        loadEngineState(r);
+    }
+
+    void Kernel::saveEngineState(BinaryWriter &)
+    {
+        throw BinaryIOExc("The kernel " + _kernel_name + " does not support snapshots");
+    }
+
+    void Kernel::loadEngineState(BinaryReader &)
+    {
+        throw BinaryIOExc("The kernel " + _kernel_name + " does not support snapshots");
+    }
 }
@@ -0,0 +1,265 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file KernelConfig.cpp
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <tres/KernelConfig.hpp>
+#include <tres/ParseUtils.hpp>
+#include "ModelCache.hpp"
+#include "RandomVar.hpp"
+
+namespace tres
+{
+    using namespace tres_parse_utils;
+
+    /** Convert a (whole) slice into a double, or throw */
+    static double parseNumber(str_slice s, const char *what)
+    {
+        char buf[64];
+        if (s.empty() || s.size() >= sizeof(buf))
+            throw KernelConfigExc(std::string("Malformed ") + what + ": '" + s.str() + "'");
+        memcpy(buf, s.data(), s.size());
+        buf[s.size()] = '\0';
+        char *end;
+        double v = strtod(buf, &end);
+        if (*end != '\0')
+            throw KernelConfigExc(std::string("Malformed ") + what + ": '" + s.str() + "'");
+        return v;
+    }
+
+    bool TaskConfig::getNumericParam(std::vector<std::string>::size_type i, double &value) const
+    {
+        if (i >= params.size() || params[i].empty())
+            return false;
+        value = parseNumber(str_slice(params[i]), "parameter of task");
+        return true;
+    }
+
+    void KernelConfig::validate() const
+    {
+        if (num_cores < 1)
+            throw KernelConfigExc("The number of CPU cores must be positive");
+        if (!(time_resolution > 0))
+            throw KernelConfigExc("The time resolution must be positive");
+        if (scheduler.policy.empty())
+            throw KernelConfigExc("Missing scheduling policy");
+        for (std::vector<TaskConfig>::const_iterator t = tasks.begin(); t != tasks.end(); ++t)
+        {
+            if (t->type.empty() || t->name.empty())
+                throw KernelConfigExc("Missing type or name of a task");
+            if (t->iat < 0 || t->rdl < 0 || t->ph < 0)
+                throw KernelConfigExc("Negative timing parameter for task " + t->name);
+            if (t->iat == 0 && !t->isAperiodic())
+                throw KernelConfigExc("Null inter-arrival time for task " + t->name);
+            // Values shorter than half a tick would silently become 0
+            if (t->iat > 0 && std::llround(t->iat * time_resolution) == 0)
+                throw KernelConfigExc("The inter-arrival time of task " + t->name
+                                      + " is 0 ticks at the given time resolution");
+            if (t->rdl > 0 && std::llround(t->rdl * time_resolution) == 0)
+                throw KernelConfigExc("The relative deadline of task " + t->name
+                                      + " is 0 ticks at the given time resolution");
+        }
+    }
+
+    void KernelConfig::selectGenerator() const
+    {
+        if (generator.empty())
+            return;
+        try
+        {
+            RandomVar::selectGenerator(generator, seed);
+        }
+        catch (BaseExc &e)
+        {
+            throw KernelConfigExc("Unknown random generator '" + generator + "'");
+        }
+    }
+
+    void KernelConfig::serialize(BinaryWriter &w) const
+    {
+        w.put<uint64_t>(tasks.size());
+        for (std::vector<TaskConfig>::const_iterator t = tasks.begin(); t != tasks.end(); ++t)
+        {
+            w.putString(t->type);
+            w.putString(t->name);
+            w.put(t->iat);
+            w.put(t->rdl);
+            w.put(t->ph);
+            w.put<uint64_t>(t->params.size());
+            for (std::vector<std::string>::const_iterator p = t->params.begin(); p != t->params.end(); ++p)
+                w.putString(*p);
+        }
+        w.putString(scheduler.policy);
+        w.put<uint64_t>(scheduler.params.size());
+        for (std::vector<std::string>::const_iterator p = scheduler.params.begin(); p != scheduler.params.end(); ++p)
+            w.putString(*p);
+        w.put<int32_t>(num_cores);
+        w.put(time_resolution);
+        w.putString(name);
+        w.putString(generator);
+        w.put<int64_t>(seed);
+    }
+
+    KernelConfig KernelConfig::deserialize(BinaryReader &r)
+    {
+        KernelConfig conf;
+        conf.tasks.resize(static_cast<std::size_t>(r.get<uint64_t>()));
+        for (std::vector<TaskConfig>::iterator t = conf.tasks.begin(); t != conf.tasks.end(); ++t)
+        {
+            t->type = r.getString();
+            t->name = r.getString();
+            t->iat = r.get<double>();
+            t->rdl = r.get<double>();
+            t->ph = r.get<double>();
+            t->params.resize(static_cast<std::size_t>(r.get<uint64_t>()));
+            for (std::vector<std::string>::iterator p = t->params.begin(); p != t->params.end(); ++p)
+                *p = r.getString();
+        }
+        conf.scheduler.policy = r.getString();
+        conf.scheduler.params.resize(static_cast<std::size_t>(r.get<uint64_t>()));
+        for (std::vector<std::string>::iterator p = conf.scheduler.params.begin(); p != conf.scheduler.params.end(); ++p)
+            *p = r.getString();
+        conf.num_cores = r.get<int32_t>();
+        conf.time_resolution = r.get<double>();
+        conf.name = r.getString();
+        conf.generator = r.getString();
+        conf.seed = r.get<int64_t>();
+        return conf;
+    }
+
+    /** Parse a task descriptor (type; name; iat; rdl; ph; [param;]...) */
+    static void parseTask(const std::string &descr, TaskConfig &t)
+    {
+        std::vector<str_slice> p;
+        split_instr(str_slice(descr), p);
+        if (p.size() < 5)
+            throw KernelConfigExc("Malformed task description: '" + descr + "'");
+        t.type = p[0].str();
+        t.name = p[1].str();
+        t.iat = parseNumber(p[2], "inter-arrival time");
+        t.rdl = parseNumber(p[3], "relative deadline");
+        t.ph = parseNumber(p[4], "phase");
+        to_strings(std::vector<str_slice>(p.begin()+5, p.end()), t.params);
+    }
+
+    /** Parse (and validate) the string form of the configuration */
+    static KernelConfig parseStrings(const std::vector<std::string> &par)
+    {
+        if (par.size() < 5)
+            throw KernelConfigExc("Wrong number of parameters");
+
+        KernelConfig conf;
+        int num_tasks = static_cast<int>(parseNumber(str_slice(par[0]), "number of tasks"));
+        if (num_tasks < 0 || par.size() < static_cast<std::size_t>(num_tasks) + 5
+                          || par.size() > static_cast<std::size_t>(num_tasks) + 6)
+            throw KernelConfigExc("Wrong number of parameters");
+
+        // The task-set
+        conf.tasks.resize(num_tasks);
+        for (int i = 0; i < num_tasks; ++i)
+            parseTask(par[1+i], conf.tasks[i]);
+
+        // The scheduling policy
+        std::vector<str_slice> p;
+        split_instr(str_slice(par[1+num_tasks]), p);
+        if (p.empty())
+            throw KernelConfigExc("Malformed scheduling policy description");
+        conf.scheduler.policy = p[0].str();
+        to_strings(std::vector<str_slice>(p.begin()+1, p.end()), conf.scheduler.params);
+
+        // The platform
+        conf.num_cores = static_cast<int>(parseNumber(str_slice(par[2+num_tasks]), "number of cores"));
+        conf.time_resolution = parseNumber(str_slice(par[3+num_tasks]), "time resolution");
+        conf.name = par[4+num_tasks];
+
+        // The random generator (optional)
+        if (par.size() > static_cast<std::size_t>(num_tasks) + 5)
+        {
+            split_instr(str_slice(par[5+num_tasks]), p);
+            if (p.empty() || p.size() > 2)
+                throw KernelConfigExc("Malformed random generator description: '" + par[5+num_tasks] + "'");
+            conf.generator = p[0].str();
+            if (p.size() > 1)
+                conf.seed = static_cast<long long>(parseNumber(p[1], "seed"));
+        }
+
+        conf.validate();
+        return conf;
+    }
+
+    KernelConfig KernelConfig::fromStrings(const std::vector<std::string> &par)
+    {
+        ModelCache &cache = ModelCache::instance();
+        if (!cache.enabled())
+            return parseStrings(par);
+
+        // The key is the hash of the whole description
+        uint64_t key = fnv1a(NULL, 0);
+        for (std::vector<std::string>::const_iterator p = par.begin(); p != par.end(); ++p)
+        {
+            uint64_t len = p->size();
+            key = fnv1a(&len, sizeof(len), key);
+            key = fnv1a(p->data(), p->size(), key);
+        }
+
+        MappedFile img;
+        const char *payload;
+        std::size_t size;
+        if (cache.load(ModelCache::KERNEL_CONFIG, key, img, payload, size))
+        {
+            try
+            {
+                BinaryReader r(payload, size);
+                KernelConfig conf = deserialize(r);
+                if (r.atEnd())
+                    return conf;
+            }
+            catch (BinaryIOExc &)
+            {
+                // Malformed entry: rebuild it
+            }
+        }
+
+        KernelConfig conf = parseStrings(par);
+        BinaryWriter w;
+        conf.serialize(w);
+        cache.store(ModelCache::KERNEL_CONFIG, key, w.data());
+        return conf;
+    }
+}
@@ -0,0 +1,228 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file ModelCache.cpp
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "ModelCache.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace tres
+{
+    using namespace std;
+
+    const uint32_t ModelCache::FORMAT_VERSION = 2;
+
+    /** Header of the cache entries */
+    struct _ImageHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t kind;
+        uint64_t key;
+        uint64_t size;
+        uint64_t hash;
+    };
+
+    static const char IMAGE_MAGIC[8] = { 'T', 'R', 'E', 'S', 'I', 'M', 'G', '\0' };
+
+    uint64_t fnv1a(const void *data, size_t n, uint64_t h)
+    {
+        const unsigned char *p = static_cast<const unsigned char *>(data);
+        for (size_t i = 0; i < n; ++i)
+        {
+            h ^= p[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    MappedFile::MappedFile() : _data(NULL), _size(0), _mapped(false)
+    {
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const string &path)
+    {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        _size = static_cast<size_t>(st.st_size);
+        if (_size > 0)
+        {
+            void *m = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED)
+            {
+                _data = static_cast<const char *>(m);
+                _mapped = true;
+                ::close(fd);
+                return true;
+            }
+        }
+        ::close(fd);
+#endif
+        // Fallback: read the whole file
+        ifstream f(path.c_str(), ios::in | ios::binary);
+        if (!f.is_open())
+            return false;
+        _buf.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+        _data = _buf.empty() ? "" : _buf.data();
+        _size = _buf.size();
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+#ifndef _WIN32
+        if (_mapped)
+            munmap(const_cast<char *>(_data), _size);
+#endif
+        _buf.clear();
+        _data = NULL;
+        _size = 0;
+        _mapped = false;
+    }
+
+    ModelCache &ModelCache::instance()
+    {
+        static ModelCache theInstance;
+        return theInstance;
+    }
+
+    ModelCache::ModelCache()
+    {
+        const char *dir = getenv("TRES_CACHE_DIR");
+        if (dir != NULL)
+            _dir = dir;
+    }
+
+    string ModelCache::entryPath(Kind kind, uint64_t key) const
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "/tres-%u-%016llx.img",
+                 static_cast<unsigned>(kind), static_cast<unsigned long long>(key));
+        return _dir + name;
+    }
+
+    bool ModelCache::load(Kind kind, uint64_t key, MappedFile &img,
+                          const char *&payload, size_t &size) const
+    {
+        if (!enabled() || !img.open(entryPath(kind, key)))
+            return false;
+
+        // Check the header (and the integrity of the payload)
+        _ImageHeader h;
+        if (img.size() < sizeof(h))
+            return false;
+        memcpy(&h, img.data(), sizeof(h));
+        if (memcmp(h.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 ||
+            h.version != FORMAT_VERSION || h.kind != static_cast<uint32_t>(kind) ||
+            h.key != key || h.size != img.size() - sizeof(h))
+            return false;
+        payload = img.data() + sizeof(h);
+        size = static_cast<size_t>(h.size);
+        return fnv1a(payload, size) == h.hash;
+    }
+
+    void ModelCache::store(Kind kind, uint64_t key, const string &payload) const
+    {
+        if (!enabled())
+            return;
+
+        _ImageHeader h;
+        memcpy(h.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+        h.version = FORMAT_VERSION;
+        h.kind = kind;
+        h.key = key;
+        h.size = payload.size();
+        h.hash = fnv1a(payload.data(), payload.size());
+
+        // Write a temporary file and then rename it, so that
+        // concurrent runs never see partially written entries
+        string path = entryPath(kind, key);
+        stringstream tmp;
+#ifndef _WIN32
+        tmp << path << ".tmp." << getpid();
+#else
+        tmp << path << ".tmp";
+#endif
+        {
+            ofstream f(tmp.str().c_str(), ios::out | ios::binary | ios::trunc);
+            if (!f.is_open())
+                return;
+            f.write(reinterpret_cast<const char *>(&h), sizeof(h));
+            f.write(payload.data(), payload.size());
+            if (!f.good())
+            {
+                f.close();
+                remove(tmp.str().c_str());
+                return;
+            }
+        }
+        if (rename(tmp.str().c_str(), path.c_str()) != 0)
+            remove(tmp.str().c_str());
+    }
+
+    bool ModelCache::hashFile(const string &path, uint64_t &h)
+    {
+        MappedFile f;
+        if (!f.open(path))
+            return false;
+        h = fnv1a(f.data(), f.size());
+        return true;
+    }
+}
@@ -0,0 +1,172 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file ModelCache.hpp
+ *
+ * Binary cache of the parsed model inputs (kernel configurations, PDF
+ * tables, traces). Entries are versioned binary images keyed by a hash of
+ * the content of the inputs they are built from, so that they become
+ * stale (and are rebuilt) as soon as any input changes. The cache is
+ * enabled by setting the TRES_CACHE_DIR environment variable to an
+ * existing directory.
+ */
+
+#ifndef TRES_MODELCACHE_HDR
+#define TRES_MODELCACHE_HDR
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tres/BinaryIO.hpp>
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+
+    /**
+     * \brief The FNV-1a (64 bit) hash function
+     *
+     * The last parameter allows to hash non-contiguous data incrementally
+     */
+    uint64_t fnv1a(const void *data, std::size_t n,
+                   uint64_t h = 14695981039346656037ULL);
+
+    /**
+     * \brief A read-only file mapped in memory
+     *
+     * Files are mapped with mmap() where available, otherwise they are read
+     * into a buffer.
+     */
+    class MappedFile
+    {
+
+    public:
+
+        MappedFile();
+
+        ~MappedFile();
+
+        /**
+         * \brief Maps the file; returns false if it cannot be opened
+         */
+        bool open(const std::string &path);
+
+        /**
+         * \brief Unmaps the file (if any)
+         */
+        void close();
+
+        const char *data() const { return _data; }
+
+        std::size_t size() const { return _size; }
+
+    private:
+
+        MappedFile(const MappedFile &);
+        MappedFile &operator=(const MappedFile &);
+
+        const char *_data;
+        std::size_t _size;
+        bool _mapped;
+        std::vector<char> _buf;
+    };
+
+    /**
+     * \brief The (process-wide) cache of compiled model inputs
+     *
+     * Each entry is a file named after the kind and key of the entry,
+     * holding a header (magic, format version, kind, key, size and hash of
+     * the payload) followed by the payload. Entries which do not match
+     * their header are ignored. Storing is best-effort: a failure just
+     * leaves the entry uncached.
+     */
+    class ModelCache
+    {
+
+    public:
+
+        /** Kinds of cached entries */
+        enum Kind { KERNEL_CONFIG = 1, PDF_TABLE = 2, TRACE = 3 };
+
+        /** Version of the binary format (bump on any change of the layout) */
+        static const uint32_t FORMAT_VERSION;
+
+        /**
+         * \brief Singleton access
+         */
+        static ModelCache &instance();
+
+        /**
+         * \brief Returns true if the cache is enabled (TRES_CACHE_DIR is set)
+         */
+        bool enabled() const { return !_dir.empty(); }
+
+        /**
+         * \brief Look up an entry
+         *
+         * On success, the image is mapped in img and the payload is
+         * available through payload/size
+         */
+        bool load(Kind kind, uint64_t key, MappedFile &img,
+                  const char *&payload, std::size_t &size) const;
+
+        /**
+         * \brief Store an entry
+         */
+        void store(Kind kind, uint64_t key, const std::string &payload) const;
+
+        /**
+         * \brief Content hash of a file; returns false if it cannot be read
+         */
+        static bool hashFile(const std::string &path, uint64_t &h);
+
+    private:
+
+        ModelCache();
+
+        ModelCache(const ModelCache &);
+        ModelCache &operator=(const ModelCache &);
+
+        std::string entryPath(Kind kind, uint64_t key) const;
+
+        /** The cache directory (empty if the cache is disabled) */
+        std::string _dir;
+    };
+    /** @} */
+}
+#endif // TRES_MODELCACHE_HDR
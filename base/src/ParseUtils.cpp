@@ -37,121 +37,183 @@
  */
  
 #include <cstdlib>
+#include <cstring>
 #include <tres/ParseUtils.hpp>
 
 namespace tres_parse_utils
 {
     using namespace std;
 
+    bool instr_tokenizer::next(str_slice &tok)
+    {
+        str_slice::size_type pos = _code.find(_sep, _pos);
+        if (pos == str_slice::npos)
+        {
+            _pos = _code.size();
+            return false;
+        }
+        tok = remove_spaces(_code.substr(_pos, pos - _pos));
+        _pos = pos + 1;
+        return true;
+    }
+
     //removes the spaces at the beginning and at the end of the string
+    str_slice remove_spaces(str_slice tk)
+    {
+        str_slice::size_type first = tk.find_first_not_of(str_slice(" "));
+        if (first == str_slice::npos)
+            return str_slice(tk.end(), 0);
+        return tk.substr(first, tk.find_last_not_of(' ') - first + 1);
+    }
+
+    void split(str_slice code, str_slice sep, vector<str_slice> &out)
+    {
+        out.clear();
+        str_slice::size_type pos = 0;
+        str_slice::size_type old_pos = 0;
+        while (pos != str_slice::npos)
+        {
+            pos = code.find(sep, old_pos);
+            if (pos != str_slice::npos)
+            {
+                out.push_back(remove_spaces(code.substr(old_pos, pos - old_pos)));
+                old_pos = pos + sep.size();
+            }
+            else
+                out.push_back(remove_spaces(code.substr(old_pos)));
+        }
+    }
+
+    void split_instr(str_slice code, vector<str_slice> &out)
+    {
+        out.clear();
+        instr_tokenizer tk(code);
+        str_slice t;
+        while (tk.next(t))
+            out.push_back(t);
+    }
+
+    str_slice get_token(str_slice instr, str_slice open_par)
+    {
+        str_slice::size_type pos = instr.find(open_par);
+        str_slice::size_type pos1 = instr.find_first_not_of(str_slice(" \n"));
+        return instr.substr(pos1, pos - pos1);
+    }
+
+    str_slice get_param(str_slice instr, str_slice open_par, str_slice close_par)
+    {
+        str_slice::size_type pos = instr.find(open_par);
+        if (pos == str_slice::npos)
+            return str_slice(instr.end(), 0);
+        str_slice::size_type end = instr.find_last_of(close_par);
+        return instr.substr(pos+1, end-pos-1);
+    }
+
+    void split_param(str_slice p, vector<str_slice> &out, str_slice sep,
+                     char open_par, char close_par)
+    {
+        out.clear();
+        str_slice::size_type pos = 0;
+        str_slice::size_type old_pos = 0;
+        while (pos <= p.size())
+        {
+            // Look for the next separator or open parenthesis
+            while (pos < p.size() && p[pos] != open_par && sep.find(p[pos]) == str_slice::npos)
+                ++pos;
+            if (pos == p.size())
+                pos = str_slice::npos;
+            if (pos != str_slice::npos && p[pos] == open_par)
+            {
+                // Skip up to (and including) the closing parenthesis
+                pos = p.find(close_par, pos);
+                if (pos == str_slice::npos)
+                    throw ParseExc("split_param", p.str());
+                ++pos;
+            }
+            if (pos != str_slice::npos)
+            {
+                out.push_back(remove_spaces(p.substr(old_pos, pos - old_pos)));
+                old_pos = ++pos;
+            }
+        }
+        if (pos != old_pos)
+        {
+            str_slice t = remove_spaces(p.substr(old_pos));
+            if (!t.empty())
+                out.push_back(t);
+        }
+    }
+
+    void to_strings(const vector<str_slice> &in, vector<string> &out)
+    {
+        out.resize(in.size());
+        for (vector<str_slice>::size_type i = 0; i < in.size(); ++i)
+            out[i].assign(in[i].data(), in[i].size());
+    }
+
+    double to_double(str_slice s)
+    {
+        char buf[64];
+        if (s.size() >= sizeof(buf))
+            return atof(s.str().c_str());
+        memcpy(buf, s.data(), s.size());
+        buf[s.size()] = '\0';
+        return atof(buf);
+    }
+
+    int to_int(str_slice s)
+    {
+        char buf[32];
+        if (s.size() >= sizeof(buf))
+            return atoi(s.str().c_str());
+        memcpy(buf, s.data(), s.size());
+        buf[s.size()] = '\0';
+        return atoi(buf);
+    }
+
     string remove_spaces(const string &tk)
     {
-	    string temp = tk;
-	    string::size_type pos = 0;
-	    if (tk == "")
-	        return temp;
-	    // remove spaces at the beginning...
-	    temp.erase(0, temp.find_first_not_of(' '));
-	    pos = temp.find_last_not_of(' ');
-	    temp.erase(pos+1, temp.size() - pos - 1);
-	    return temp;
+        return remove_spaces(str_slice(tk)).str();
     }
 
     vector<string> split(const string &code, const string &sep, 
-			 const string &open_par, 
-			 const string &close_par)
+			 const string &, const string &)
     {
-	    vector<string> temp;
-	    string::size_type pos = 0;
-	    string::size_type old_pos = 0;
-	    int count = 0;
-	    while (pos != string::npos)
-        {
-	        pos = code.find(sep, old_pos);
-	        if (pos != string::npos)
-	        { 
-		        temp.push_back(remove_spaces(code.substr(old_pos,pos-old_pos)));
-		        old_pos = pos + sep.size();
-		        count ++;
-	        }
-	        else
-    		    temp.push_back(remove_spaces(code.substr(old_pos, code.size() - old_pos)));
-	    }
-	    return temp;
+        vector<str_slice> sl;
+        vector<string> temp;
+        split(str_slice(code), str_slice(sep), sl);
+        to_strings(sl, temp);
+        return temp;
     }
 
     vector<string> split_instr(const string &code)
     {
-	    vector<string> temp;
-	    string::size_type pos = 0;
-	    string::size_type old_pos = 0;
-	    while (pos != string::npos)
-	    {
-	        pos = code.find(';', old_pos);
-	        if (pos != string::npos)
-	        { 
-		        temp.push_back(remove_spaces(code.substr(old_pos,pos-old_pos)));
-		        old_pos = ++pos;
-	        }
-	    }
-	    return temp;
+        vector<str_slice> sl;
+        vector<string> temp;
+        split_instr(str_slice(code), sl);
+        to_strings(sl, temp);
+        return temp;
     }
 
     string get_token(const string &instr, const string &open_par)
     {
-	    string temp;
-	    string::size_type pos = instr.find(open_par);
-	    string::size_type pos1 = instr.find_first_not_of(" \n");
-	    temp = instr.substr(pos1, pos - pos1);
-	    return temp;
+        return get_token(str_slice(instr), str_slice(open_par)).str();
     }
 
     string get_param(const string &instr, const string &open_par,
 		     const string &close_par)
     {
-	    string temp("");
-	    string::size_type pos = instr.find(open_par);
-	    if (pos != string::npos)
-	    {
-	        string::size_type end = instr.find_last_of(close_par);
-	        temp = instr.substr(pos+1, end-pos-1);
-	    }
-	    return temp;
+        return get_param(str_slice(instr), str_slice(open_par), str_slice(close_par)).str();
     }
 
     vector<string> split_param(const string &p, const string &sep,
 			       char open_par, char close_par)
     {
-	    vector<string> temp;
-	    string::size_type pos = 0;
-	    string::size_type old_pos = 0;
-	    string symbols = sep + open_par;
-	    while (pos <= p.size())
-	    {
-	        pos = p.find_first_of(symbols, pos);
-	        if (pos != string::npos)
-		        if (p[pos] == open_par)
-		        {
-		            pos = p.find(close_par, pos);
-		            if (pos == p.size())
-		                pos = string::npos;
-		            else
-		                ++pos;
-		        }
-            if (pos != string::npos)
-	        {
-		        string t = remove_spaces(p.substr(old_pos, pos - old_pos));
-		        temp.push_back(t);
-		        old_pos = ++pos;
-            }
-	    }
-	    if (pos != old_pos)
-	    {
-	        string t = remove_spaces(p.substr(old_pos, p.size() - old_pos));
-	        if (t != "")
-	            temp.push_back(t);
-	    }
-	    return temp;
+        vector<str_slice> sl;
+        vector<string> temp;
+        split_param(str_slice(p), sl, str_slice(sep), open_par, close_par);
+        to_strings(sl, temp);
+        return temp;
     }
 
     void parse_double(const string &nums, double &res, string &unit)
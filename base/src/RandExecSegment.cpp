@@ -45,13 +45,23 @@
 
 namespace tres
 {
+    const size_t RandExecSegment::PREFETCH_SIZE;
+
+    bool RandExecSegment::_prefetch_enabled = false;
+
     RandExecSegment::RandExecSegment(unique_ptr<RandomVar> &c) :
-        cost(std::move(c))
+        cost(std::move(c)),
+        _prefetching(_prefetch_enabled),
+        _prefetch_pos(0),
+        _prefetch_epoch(0)
     {
     }
 
     RandExecSegment::RandExecSegment(RandomVar *c) :
-        cost(c)
+        cost(c),
+        _prefetching(_prefetch_enabled),
+        _prefetch_pos(0),
+        _prefetch_epoch(0)
     {
     }
 
@@ -65,9 +75,12 @@ namespace tres
         else
         {
             using namespace tres_parse_utils;
-            std::string token = get_token(par[0]);
-            std::string p = get_param(par[0]);
-            std::vector<std::string> parms = split_param(p);
+            str_slice descr(par[0]);
+            std::string token = get_token(descr).str();
+            std::vector<str_slice> p;
+            split_param(get_param(descr), p);
+            std::vector<std::string> parms;
+            to_strings(p, parms);
             unique_ptr<RandomVar> var(Factory<RandomVar>::instance().create(token,parms));
             if (!var.get()) throw ParseExc("RandExecSegment", par[0]);
             temp = new RandExecSegment(var);
@@ -82,6 +95,31 @@ namespace tres
 
     double RandExecSegment::getDuration() const
     {
-        return cost->get();
+        return nextSample();
+    }
+
+    void RandExecSegment::refill() const
+    {
+        // Draw PREFETCH_SIZE samples at once
+        _prefetch.resize(PREFETCH_SIZE);
+        cost->fill(_prefetch.data(), _prefetch.size());
+        _prefetch_pos = 0;
+        _prefetch_epoch = RandomVar::getEpoch();
+    }
+
+    void RandExecSegment::saveState(BinaryWriter &w) const
+    {
+        // Only the samples not consumed yet
+        std::vector<double> left(_prefetch.begin() + _prefetch_pos, _prefetch.end());
+        w.putVector(left);
+        cost->saveState(w);
+    }
+
+    void RandExecSegment::loadState(BinaryReader &r)
+    {
+        r.getVector(_prefetch);
+        _prefetch_pos = 0;
+        _prefetch_epoch = RandomVar::getEpoch();
+        cost->loadState(r);
     }
 }
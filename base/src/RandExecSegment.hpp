@@ -85,11 +85,78 @@ namespace tres
          */
         virtual double getDuration() const;
 
+        /**
+         * \brief Draw the next sample of \ref cost
+         *
+         * Same as RandExecSegment::getDuration(), but can be called without
+         * virtual dispatch (see tres::Task)
+         */
+        double nextSample() const
+        {
+            if (!_prefetching)
+                return cost->get();
+            if (_prefetch_pos == _prefetch.size() || _prefetch_epoch != RandomVar::getEpoch())
+                refill();
+            return _prefetch[_prefetch_pos++];
+        }
+
+        /**
+         * \brief Enable (or disable) the prefetching of durations
+         *
+         * Segments built afterwards draw their durations PREFETCH_SIZE at a
+         * time, with a single RandomVar::fill() call. The distribution of
+         * each segment is unchanged, but segments (and tasks) sharing a
+         * generator then consume its numbers in a different order: the same
+         * seed no longer gives the same sequence of durations as without
+         * prefetching. Hence, it is disabled by default.
+         */
+        static void setPrefetch(bool enable) { _prefetch_enabled = enable; }
+
+        /**
+         * \brief Whether segments built now prefetch their durations
+         */
+        static bool getPrefetch() { return _prefetch_enabled; }
+
+        /**
+         * \brief Save the samples drawn in advance and the state of \ref cost
+         */
+        virtual void saveState(BinaryWriter &w) const;
+
+        virtual void loadState(BinaryReader &r);
+
     protected:
 
+        /** Draw a new buffer of samples */
+        void refill() const;
+
+        /** Whether new segments prefetch their durations */
+        static bool _prefetch_enabled;
+
+        /** Number of samples drawn at once from \ref cost */
+        static const size_t PREFETCH_SIZE = 64;
+
         /** RandomVar instance representing the instruction cost/duration */
         unique_ptr<RandomVar> cost;
 
+        /**
+         * \name Samples of \ref cost drawn in advance
+         *
+         * If prefetching was enabled when the segment was built (see
+         * setPrefetch()), getDuration() consumes them one at a time and
+         * refills the buffer with a single RandomVar::fill() call when it
+         * runs out
+         * @{
+         */
+        bool _prefetching;
+        mutable std::vector<double> _prefetch;
+        mutable std::vector<double>::size_type _prefetch_pos;
+
+        /** Epoch of the samples (see RandomVar::reseed()) */
+        mutable unsigned _prefetch_epoch;
+        /**
+         * @}
+         */
+
     };
     /** @} */
 }
@@ -0,0 +1,266 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file RandomGen.cpp
+ *
+ * Implementation of the pseudo-random number generators.
+ */
+
+#include <cstdlib>
+#include <tres/ParseUtils.hpp>
+#include "RandomGen.hpp"
+
+namespace tres
+{
+
+    using namespace std;
+    using namespace tres_parse_utils;
+
+    /** Parse the optional seed parameter of the generator creators */
+    static RandNum parseSeed(vector<string> &par, const char *cl)
+    {
+        if (par.size() > 1)
+            throw ParseExc("Wrong number of parameters", cl);
+        return par.empty() ? 1 : atoll(par[0].c_str());
+    }
+
+    /** SplitMix64 step, used to expand a seed into a larger state */
+    static uint64_t splitmix64(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    /*
+     * The 64-bit generators return the 52 most significant bits of
+     * their output plus 1, i.e., numbers in [1, 2^52]; with M = 2^52+1
+     * the ratio sample()/M is in (0,1) and exactly representable
+     */
+    const RandNum Xoshiro256Gen::M = (1LL << 52) + 1;
+    const RandNum Pcg64Gen::M = (1LL << 52) + 1;
+
+    void RandomGen::saveState(BinaryWriter &) const
+    {
+        throw BinaryIOExc("The generator does not support snapshots");
+    }
+
+    void RandomGen::loadState(BinaryReader &)
+    {
+        throw BinaryIOExc("The generator does not support snapshots");
+    }
+
+    const RandNum MinStdGen::A = 16807;
+    const RandNum MinStdGen::M = 2147483647;
+    const RandNum MinStdGen::Q = 127773; // M div A
+    const RandNum MinStdGen::R = 2836;   // M mod A
+
+    MinStdGen::MinStdGen(RandNum s) : _seed(s), _xn(s)
+    {
+    }
+
+    RandNum MinStdGen::sample()
+    {
+        RandNum xq, xr;
+
+        xq = _xn / Q;
+        xr = _xn % Q;
+
+        _xn = A * xr - R * xq;
+        if (_xn < 0)
+            _xn += M;
+        return _xn;
+    }
+
+    void MinStdGen::init(RandNum s)
+    {
+        _xn = _seed = s;
+    }
+
+    void MinStdGen::saveState(BinaryWriter &w) const
+    {
+        w.put(_seed);
+        w.put(_xn);
+    }
+
+    void MinStdGen::loadState(BinaryReader &r)
+    {
+        _seed = r.get<RandNum>();
+        _xn = r.get<RandNum>();
+    }
+
+    RandomGen *MinStdGen::createInstance(vector<string> &par)
+    {
+        return new MinStdGen(parseSeed(par, "MinStdGen"));
+    }
+
+    Xoshiro256Gen::Xoshiro256Gen(RandNum s)
+    {
+        init(s);
+    }
+
+    void Xoshiro256Gen::init(RandNum s)
+    {
+        _seed = s;
+        uint64_t x = static_cast<uint64_t>(s);
+        for (int i = 0; i < 4; ++i)
+            _s[i] = splitmix64(x);
+    }
+
+    static inline uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    RandNum Xoshiro256Gen::sample()
+    {
+        const uint64_t result = rotl(_s[1] * 5, 7) * 9;
+        const uint64_t t = _s[1] << 17;
+
+        _s[2] ^= _s[0];
+        _s[3] ^= _s[1];
+        _s[1] ^= _s[2];
+        _s[0] ^= _s[3];
+        _s[2] ^= t;
+        _s[3] = rotl(_s[3], 45);
+
+        return static_cast<RandNum>(result >> 12) + 1;
+    }
+
+    void Xoshiro256Gen::saveState(BinaryWriter &w) const
+    {
+        w.put(_seed);
+        for (int i = 0; i < 4; ++i)
+            w.put(_s[i]);
+    }
+
+    void Xoshiro256Gen::loadState(BinaryReader &r)
+    {
+        _seed = r.get<RandNum>();
+        for (int i = 0; i < 4; ++i)
+            _s[i] = r.get<uint64_t>();
+    }
+
+    RandomGen *Xoshiro256Gen::createInstance(vector<string> &par)
+    {
+        return new Xoshiro256Gen(parseSeed(par, "Xoshiro256Gen"));
+    }
+
+    // PCG default 128-bit multiplier
+    static const uint64_t PCG_MULT_HI = 2549297995355413924ULL;
+    static const uint64_t PCG_MULT_LO = 4865540595714422341ULL;
+
+    /** 64x64 -> 128 bit multiplication (high half) */
+    static inline uint64_t mulhi64(uint64_t a, uint64_t b)
+    {
+#ifdef __SIZEOF_INT128__
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+#else
+        const uint64_t a_lo = a & 0xffffffffULL, a_hi = a >> 32;
+        const uint64_t b_lo = b & 0xffffffffULL, b_hi = b >> 32;
+        const uint64_t p0 = a_lo * b_lo;
+        const uint64_t p1 = a_lo * b_hi;
+        const uint64_t p2 = a_hi * b_lo;
+        const uint64_t p3 = a_hi * b_hi;
+        const uint64_t mid = (p0 >> 32) + (p1 & 0xffffffffULL) + (p2 & 0xffffffffULL);
+        return p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+    }
+
+    Pcg64Gen::Pcg64Gen(RandNum s)
+    {
+        init(s);
+    }
+
+    void Pcg64Gen::step()
+    {
+        // state = state * MULT + inc (mod 2^128)
+        uint64_t hi = mulhi64(_state_lo, PCG_MULT_LO)
+                      + _state_hi * PCG_MULT_LO + _state_lo * PCG_MULT_HI;
+        uint64_t lo = _state_lo * PCG_MULT_LO;
+        _state_lo = lo + _inc_lo;
+        _state_hi = hi + _inc_hi + (_state_lo < lo ? 1 : 0);
+    }
+
+    void Pcg64Gen::init(RandNum s)
+    {
+        _seed = s;
+        uint64_t x = static_cast<uint64_t>(s);
+        const uint64_t init_hi = splitmix64(x), init_lo = splitmix64(x);
+        // the increment must be odd
+        _inc_hi = splitmix64(x);
+        _inc_lo = splitmix64(x) | 1;
+        _state_hi = 0;
+        _state_lo = 0;
+        step();
+        uint64_t lo = _state_lo + init_lo;
+        _state_hi += init_hi + (lo < _state_lo ? 1 : 0);
+        _state_lo = lo;
+        step();
+    }
+
+    RandNum Pcg64Gen::sample()
+    {
+        step();
+        const uint64_t xored = _state_hi ^ _state_lo;
+        const unsigned rot = static_cast<unsigned>(_state_hi >> 58);
+        const uint64_t result = (xored >> rot) | (xored << ((64 - rot) & 63));
+        return static_cast<RandNum>(result >> 12) + 1;
+    }
+
+    void Pcg64Gen::saveState(BinaryWriter &w) const
+    {
+        w.put(_seed);
+        w.put(_state_hi);
+        w.put(_state_lo);
+        w.put(_inc_hi);
+        w.put(_inc_lo);
+    }
+
+    void Pcg64Gen::loadState(BinaryReader &r)
+    {
+        _seed = r.get<RandNum>();
+        _state_hi = r.get<uint64_t>();
+        _state_lo = r.get<uint64_t>();
+        _inc_hi = r.get<uint64_t>();
+        _inc_lo = r.get<uint64_t>();
+    }
+
+    RandomGen *Pcg64Gen::createInstance(vector<string> &par)
+    {
+        return new Pcg64Gen(parseSeed(par, "Pcg64Gen"));
+    }
+}
@@ -0,0 +1,254 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file RandomGen.hpp
+ *
+ * Pseudo-random number generators used by the RandomVar classes. The
+ * default generator is the Park-Miller "minimal standard" generator
+ * inherited from MetaSim; other generators can be selected (before
+ * creating the random variables of a simulation) through
+ * RandomVar::selectGenerator().
+ */
+
+#ifndef TRES_RANDOMGEN_HDR
+#define TRES_RANDOMGEN_HDR
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tres/BinaryIO.hpp>
+
+namespace tres
+{
+    typedef long long int RandNum;
+
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+    /** 
+     * \brief The basic (abstract) class for Random Number Generators
+     *
+     * A generator returns integer numbers in [1, getModule()-1], so
+     * that sample()/getModule() is a uniform number in (0,1). It is
+     * possible to derive from this class to implement a new generator
+     */
+    class RandomGen
+    {
+
+    public:
+
+        typedef std::string BASE_KEY_TYPE;
+
+        /**
+         * \brief The virtual destructor
+         */
+        virtual ~RandomGen() = default;
+
+        /**
+         * \brief Initialize the generator with seed s
+         */
+        virtual void init(RandNum s) = 0;
+
+        /**
+         * Extract the next random number from the sequence
+         */
+        virtual RandNum sample() = 0;
+
+        /**
+         * \brief Returns the seed the generator has been initialized with
+         */
+        virtual RandNum getSeed() const = 0;
+
+        /**
+         * \brief Return the constant M (the module of this random generator)
+         */
+        virtual RandNum getModule() const = 0;
+
+        /**
+         * \brief Save the position of the generator in its sequence
+         *
+         * By default, generators do not support snapshots
+         *
+         * \throw BinaryIOExc if the generator does not support snapshots
+         */
+        virtual void saveState(BinaryWriter &w) const;
+
+        /**
+         * \brief Restore a position saved by saveState()
+         */
+        virtual void loadState(BinaryReader &r);
+
+    };
+
+    /**
+     * \brief The Park-Miller minimal standard generator (31 bits)
+     *
+     * This is the legacy T-Res/MetaSim generator: for a given seed it
+     * reproduces bit-exactly the sequences of the previous versions
+     */
+    class MinStdGen : public RandomGen
+    {
+
+    public:
+
+        /**
+         * \brief Creates a Random Generator with s as initial seed
+         */
+        MinStdGen(RandNum s);
+
+        virtual void init(RandNum s);
+
+        virtual RandNum sample();
+
+        virtual RandNum getSeed() const { return _seed; }
+
+        virtual RandNum getModule() const { return M; }
+
+        virtual void saveState(BinaryWriter &w) const;
+
+        virtual void loadState(BinaryReader &r);
+
+        /**
+         * \brief Returns the current sequence number
+         */
+        RandNum getCurrSeed() const { return _xn; }
+
+        /**
+         * \brief Instance creator (the only optional parameter is the seed)
+         */
+        static RandomGen *createInstance(std::vector<std::string> &par);
+
+    private:
+
+        RandNum _seed;
+        RandNum _xn;
+
+        // constants used by the internal pseudo-causal number generator. 
+        static const RandNum A;
+        static const RandNum M;
+        static const RandNum Q;	// M div A
+        static const RandNum R;	// M mod A
+    };
+
+    /**
+     * \brief The xoshiro256** generator (D. Blackman and S. Vigna)
+     *
+     * 256 bits of state, period 2^256-1. Samples have 52 bits of resolution
+     */
+    class Xoshiro256Gen : public RandomGen
+    {
+
+    public:
+
+        /**
+         * \brief Creates a Random Generator with s as initial seed
+         */
+        Xoshiro256Gen(RandNum s);
+
+        virtual void init(RandNum s);
+
+        virtual RandNum sample();
+
+        virtual RandNum getSeed() const { return _seed; }
+
+        virtual RandNum getModule() const { return M; }
+
+        virtual void saveState(BinaryWriter &w) const;
+
+        virtual void loadState(BinaryReader &r);
+
+        /**
+         * \brief Instance creator (the only optional parameter is the seed)
+         */
+        static RandomGen *createInstance(std::vector<std::string> &par);
+
+    private:
+
+        RandNum _seed;
+        uint64_t _s[4];
+
+        static const RandNum M;
+    };
+
+    /**
+     * \brief The PCG64 (XSL RR 128/64) generator (M. E. O'Neill)
+     *
+     * 128 bits of state, period 2^128. Samples have 52 bits of resolution
+     */
+    class Pcg64Gen : public RandomGen
+    {
+
+    public:
+
+        /**
+         * \brief Creates a Random Generator with s as initial seed
+         */
+        Pcg64Gen(RandNum s);
+
+        virtual void init(RandNum s);
+
+        virtual RandNum sample();
+
+        virtual RandNum getSeed() const { return _seed; }
+
+        virtual RandNum getModule() const { return M; }
+
+        virtual void saveState(BinaryWriter &w) const;
+
+        virtual void loadState(BinaryReader &r);
+
+        /**
+         * \brief Instance creator (the only optional parameter is the seed)
+         */
+        static RandomGen *createInstance(std::vector<std::string> &par);
+
+    private:
+
+        RandNum _seed;
+
+        /** \name 128-bit state and increment (high and low halves)
+         * @{ */
+        uint64_t _state_hi, _state_lo;
+        uint64_t _inc_hi, _inc_lo;
+        /** @} */
+
+        /** Advance the state */
+        void step();
+
+        static const RandNum M;
+    };
+    /** @} */
+}
+#endif // TRES_RANDOMGEN_HDR
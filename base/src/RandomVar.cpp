@@ -36,11 +36,14 @@
  * \file RandomVar.cpp
  */
  
+#include <algorithm>
 #include <cmath>
 #include <memory>
+#include <typeinfo>
 #include <cstdlib>
 #include <tres/Factory.hpp>
 #include <tres/ParseUtils.hpp>
+#include "DataTables.hpp"
 #include "RandomVar.hpp"
 
 #ifdef CEPHES_LIB
@@ -52,41 +55,21 @@ namespace tres {
     using namespace std;
     using namespace tres_parse_utils;
 
-    RandomGen RandomVar::_stdgen(1);
+    MinStdGen RandomVar::_stdgen(1);
 
     RandomGen* RandomVar::_pstdgen(&_stdgen);
 
-    const RandNum RandomGen::A = 16807;
-    const RandNum RandomGen::M = 2147483647;
-    const RandNum RandomGen::Q = 127773; // M div A
-    const RandNum RandomGen::R = 2836;   // M mod A
+    unsigned RandomVar::_epoch = 0;
 
+    /** The generators created by selectGenerator(), kept alive for the
+        variables bound to them */
+    static vector<unique_ptr<RandomGen> > _selectedgens;
 
     const char * const RandomVar::Exc::_FILEOPEN = "Unable to open RandFile";
     const char * const RandomVar::Exc::_FILECLOSE = "Too short RandFile";
     const char * const RandomVar::Exc::_WRONGPDF = "Malformed PDF";
 
-    RandomGen::RandomGen(RandNum s) : _seed(s), _xn(s)
-    {
-    }
-
-    RandNum RandomGen::sample()
-    {
-        RandNum xq, xr;
-
-        xq = _xn / Q;
-        xr = _xn % Q;
-
-        _xn = A * xr - R * xq;
-        if (_xn < 0)
-            _xn += M;
-        return _xn;
-    }
-
-    void RandomGen::init(RandNum s)
-    {
-        _xn = _seed = s;
-    }
+    const size_t UniformVar::FILL_CHUNK;
 
     const unsigned long PoissonVar::CUTOFF = 10000;
 
@@ -104,6 +87,12 @@ namespace tres {
     {
     }
 
+    void RandomVar::fill(double *out, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = get();
+    }
+
     RandomGen* RandomVar::changeGenerator(RandomGen *g)
     { 
         RandomGen *old = _pstdgen;
@@ -116,6 +105,85 @@ namespace tres {
         _pstdgen = &_stdgen;
     }
 
+    void RandomVar::selectGenerator(const string &name, RandNum seed)
+    {
+        vector<string> par(1, to_string(seed));
+        unique_ptr<RandomGen> g = Factory<RandomGen>::instance().create(name, par);
+        if (!g)
+            throw Exc("Unknown random generator " + name, "RandomVar");
+        _pstdgen = g.get();
+        _selectedgens.push_back(std::move(g));
+    }
+
+    /** The generators owned by RandomVar that variables may be bound to:
+        the standard one first, then the default one and those created by
+        selectGenerator() (if not standard) */
+    static vector<RandomGen*> ownedGenerators(RandomGen *pstdgen, RandomGen *stdgen)
+    {
+        vector<RandomGen*> gens(1, pstdgen);
+        if (stdgen != pstdgen)
+            gens.push_back(stdgen);
+        for (size_t i = 0; i < _selectedgens.size(); ++i)
+            if (_selectedgens[i].get() != pstdgen)
+                gens.push_back(_selectedgens[i].get());
+        return gens;
+    }
+
+    void RandomVar::saveGenerator(BinaryWriter &w)
+    {
+        vector<RandomGen*> gens = ownedGenerators(_pstdgen, &_stdgen);
+        w.put<uint64_t>(gens.size());
+        for (size_t i = 0; i < gens.size(); ++i)
+            gens[i]->saveState(w);
+    }
+
+    void RandomVar::loadGenerator(BinaryReader &r)
+    {
+        vector<RandomGen*> gens = ownedGenerators(_pstdgen, &_stdgen);
+        if (r.get<uint64_t>() != gens.size())
+            throw BinaryIOExc("The snapshot belongs to a different set of random generators");
+        for (size_t i = 0; i < gens.size(); ++i)
+            gens[i]->loadState(r);
+    }
+
+    /** Seed of the k-th generator for the pair (seed, stream): SplitMix64
+        of the triple, mapped to the seeds valid for any generator, i.e.,
+        [1, M-1] */
+    static RandNum streamSeed(RandNum seed, uint64_t stream, uint64_t k, RandNum module)
+    {
+        uint64_t z = static_cast<uint64_t>(seed) + (stream + 1) * 0x9e3779b97f4a7c15ULL + k * 0xd1b54a32d192ed03ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        return 1 + static_cast<RandNum>(z % static_cast<uint64_t>(module - 1));
+    }
+
+    void RandomVar::reseed(RandNum seed, uint64_t stream)
+    {
+        // The standard generator first, then the other ones the variables
+        // may be bound to (as in saveGenerator()), each with its own seed
+        vector<RandomGen*> gens = ownedGenerators(_pstdgen, &_stdgen);
+        for (size_t k = 0; k < gens.size(); ++k)
+            gens[k]->init(streamSeed(seed, stream, k, gens[k]->getModule()));
+        ++_epoch;
+    }
+
+    void RandomVar::saveState(BinaryWriter &w) const
+    {
+        // The generators owned by RandomVar are saved by saveGenerator()
+        vector<RandomGen*> gens = ownedGenerators(_pstdgen, &_stdgen);
+        const bool own = (find(gens.begin(), gens.end(), _gen) == gens.end());
+        w.put<uint8_t>(own);
+        if (own)
+            _gen->saveState(w);
+    }
+
+    void RandomVar::loadState(BinaryReader &r)
+    {
+        if (r.get<uint8_t>())
+            _gen->loadState(r);
+    }
+
     RandomVar* DeltaVar::createInstance(vector<string> &par) 
     {
         if (par.size() != 1) 
@@ -124,6 +192,11 @@ namespace tres {
         return new DeltaVar(a);
     }
 
+    void DeltaVar::fill(double *out, size_t n)
+    {
+        std::fill(out, out + n, _var);
+    }
+
     double UniformVar::get()
     {
         double tmp;
@@ -133,6 +206,28 @@ namespace tres {
         return tmp;
     }
 
+    void UniformVar::fill(double *out, size_t n)
+    {
+        if (typeid(*this) == typeid(UniformVar))
+            fillUniform(out, n);
+        else
+            RandomVar::fill(out, n);
+    }
+
+    void UniformVar::fillUniform(double *out, size_t n)
+    {
+        // The generator is inherently sequential, so draw the raw samples
+        // first and scale them afterwards. The second loop has no
+        // dependencies between iterations and gets vectorized
+        for (size_t i = 0; i < n; ++i)
+            out[i] = _gen->sample();
+
+        const double range = _max - _min;
+        const double module = _gen->getModule();
+        for (size_t i = 0; i < n; ++i)
+            out[i] = out[i] * range / module + _min;
+    }
+
     RandomVar *UniformVar::createInstance(vector<string> &par) 
     {
         double a,b;
@@ -150,6 +245,13 @@ namespace tres {
         return -log(UniformVar::get()) * _lambda;
     }
 
+    void ExponentialVar::fill(double *out, size_t n)
+    {
+        fillUniform(out, n);
+        for (size_t i = 0; i < n; ++i)
+            out[i] = -log(out[i]) * _lambda;
+    }
+
     RandomVar *ExponentialVar::createInstance(vector<string> &par) 
     {
         if (par.size() != 1)
@@ -164,6 +266,14 @@ namespace tres {
         return _mu * pow (UniformVar::get(), -1/_order);
     }
 
+    void ParetoVar::fill(double *out, size_t n)
+    {
+        const double exponent = -1/_order;
+        fillUniform(out, n);
+        for (size_t i = 0; i < n; ++i)
+            out[i] = _mu * pow (out[i], exponent);
+    }
+
     RandomVar *ParetoVar::createInstance(vector<string> &par) 
     {
         double a,b;
@@ -181,7 +291,7 @@ namespace tres {
     {
         double t1,t2,r;
   
-        if (_yes)
+        if (_yes && _old_epoch == _epoch)
         {
             _yes = false;
             return _oldv;
@@ -198,16 +308,77 @@ namespace tres {
         r = sqrt(-2*log(r)/r) * _sigma;
         _oldv = _mu + t1 * r;
         _yes = 1;
+        _old_epoch = _epoch;
   
         return _mu + t2 * r;
     }
+
+    void NormalVar::fill(double *out, size_t n)
+    {
+        double t1,t2,r;
+        size_t i = 0;
+
+        // Flush the second value of the last pair, if any
+        if (n > 0 && _yes && _old_epoch == _epoch)
+        {
+            _yes = false;
+            out[i++] = _oldv;
+        }
+
+        // Polar method: every accepted pair gives two samples. The
+        // rejection loop does not vectorize, but we save the virtual
+        // calls and the bookkeeping of _yes/_oldv for each sample
+        while (i < n)
+        {
+            do
+            {
+                t1 = 2 * UniformVar::get() - 1;
+                t2 = 2 * UniformVar::get() - 1;
+
+                r = t1*t1 + t2*t2;
+            } while (r >= 1);
+
+            r = sqrt(-2*log(r)/r) * _sigma;
+            out[i++] = _mu + t2 * r;
+            if (i < n)
+                out[i++] = _mu + t1 * r;
+            else
+            {
+                _oldv = _mu + t1 * r;
+                _yes = 1;
+                _old_epoch = _epoch;
+            }
+        }
+    }
 #else
     double NormalVar::get()
     {
         return _mu + _sigma * ndtri(UniformVar::get());
     }
+
+    void NormalVar::fill(double *out, size_t n)
+    {
+        fillUniform(out, n);
+        for (size_t i = 0; i < n; ++i)
+            out[i] = _mu + _sigma * ndtri(out[i]);
+    }
 #endif
 
+    void NormalVar::saveState(BinaryWriter &w) const
+    {
+        UniformVar::saveState(w);
+        w.put<uint8_t>(_yes);
+        w.put(_oldv);
+    }
+
+    void NormalVar::loadState(BinaryReader &r)
+    {
+        UniformVar::loadState(r);
+        _yes = r.get<uint8_t>() != 0;
+        _oldv = r.get<double>();
+        _old_epoch = _epoch;
+    }
+
     RandomVar *NormalVar::createInstance(vector<string> &par) 
     {
         double a,b;
@@ -220,21 +391,104 @@ namespace tres {
         return new NormalVar(a,b);
     } 
 
-    double PoissonVar::get() 
+    const double PoissonVar::PTRS_THRESHOLD = 10;
+
+    PoissonVar::PoissonVar(double l, RandomGen *g) :
+        UniformVar(0, 1, g), _lambda(l)
     {
-        double u = UniformVar::get();
-        double F = exp(-_lambda);
-        double S = F;
+        if (_lambda < PTRS_THRESHOLD)
+        {
+            // Tabulate the CDF until it is 1 (up to rounding errors).
+            // Samples falling beyond the table are rare enough to be
+            // handled by continuing the series, see invert()
+            double F = exp(-_lambda);
+            double S = F;
+            _cdf.push_back(S);
+            for (unsigned long i = 1; i < CUTOFF && S < 1.0 - 1e-15; ++i)
+            {
+                F = F * _lambda / double(i);
+                S += F;
+                _cdf.push_back(S);
+            }
+        }
+        else
+        {
+            _slam = sqrt(_lambda);
+            _loglam = log(_lambda);
+            _b = 0.931 + 2.53 * _slam;
+            _a = -0.059 + 0.02483 * _b;
+            _invalpha = 1.1239 + 1.1328 / (_b - 3.4);
+            _vr = 0.9277 - 3.6224 / (_b - 2);
+        }
+    }
 
-        for (register unsigned int i = 1; i < CUTOFF; ++i)
+    double PoissonVar::invert(double u) const
+    {
+        // Index of the first entry of the table greater than u
+        vector<double>::const_iterator it = upper_bound(_cdf.begin(), _cdf.end(), u);
+        if (it != _cdf.end())
+            return it - _cdf.begin();
+
+        // Continue the series from the end of the table
+        unsigned long i = _cdf.size();
+        double S = _cdf.back();
+        double F = exp(-_lambda);
+        for (unsigned long j = 1; j < i; ++j)
+            F = F * _lambda / double(j);
+        for (; i < CUTOFF; ++i)
         {
-            if (u < S) return i - 1;
             F = F * _lambda / double(i);
             S += F;
+            if (u < S) return i;
         }
         return CUTOFF;
     }
 
+    double PoissonVar::ptrs()
+    {
+        double U, V, us, k;
+        while (true)
+        {
+            U = UniformVar::get() - 0.5;
+            V = UniformVar::get();
+            us = 0.5 - fabs(U);
+            k = floor((2 * _a / us + _b) * U + _lambda + 0.43);
+
+            // Fast acceptance (most of the samples end here)
+            if ((us >= 0.07) && (V <= _vr))
+                return k;
+
+            // Fast rejection
+            if ((k < 0) || ((us < 0.013) && (V > us)))
+                continue;
+
+            // Acceptance test on the log of the PMF
+            if ((log(V) + log(_invalpha) - log(_a / (us * us) + _b)) <=
+                    (-_lambda + k * _loglam - lgamma(k + 1)))
+                return k;
+        }
+    }
+
+    double PoissonVar::get() 
+    {
+        if (_cdf.empty())
+            return ptrs();
+        return invert(UniformVar::get());
+    }
+
+    void PoissonVar::fill(double *out, size_t n)
+    {
+        if (_cdf.empty())
+        {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = ptrs();
+            return;
+        }
+        fillUniform(out, n);
+        for (size_t i = 0; i < n; ++i)
+            out[i] = invert(out[i]);
+    }
+
     RandomVar* PoissonVar::createInstance(vector<string> &par) 
     {
         double a;
@@ -246,61 +500,78 @@ namespace tres {
     } 
 
     DetVar::DetVar(const std::string &filename) :
-        _array()
+        _array(DataTables::instance().trace(filename)),
+        _count(0)
     {
-        ifstream inFile;
-        double v;
-
-        inFile.open(filename.c_str());
-        if (!inFile.is_open())
-        {
-            string errMsg = Exc::_FILEOPEN  + string(filename) + "\n";
-            throw Exc(errMsg, "DetVar");
-        }
-        while (!inFile.eof())
-        {
-            inFile >> v;
-            _array.push_back(v);
-        }
-        inFile.close();
-        _count = 0;
     }
 
-    DetVar::DetVar(vector<double> &a) : _array(a) 
+    DetVar::DetVar(vector<double> &a) :
+        _array(make_shared<vector<double> >(a)),
+        _count(0)
     {
-        _count = 0;
     }
 
-    DetVar::DetVar(double *a, int s)
+    DetVar::DetVar(double *a, int s) :
+        _array(make_shared<vector<double> >(a, a + s)),
+        _count(0)
     {
-        for (int i = 0; i < s; ++i) 
-            _array.push_back(a[i]);
-        _count = 0;
     }
 
     double DetVar::get() 
     {
-        if (_count >= _array.size())
+        const vector<double> &array = *_array;
+        if (_count >= array.size())
             _count = 0;
-        return _array[_count++];
+        return array[_count++];
+    }
+
+    void DetVar::fill(double *out, size_t n)
+    {
+        const vector<double> &array = *_array;
+        if (array.empty())
+        {
+            std::fill(out, out + n, 0.0);
+            return;
+        }
+
+        // Copy the sequence chunk by chunk, starting over
+        // each time the end of the sequence is reached
+        while (n > 0)
+        {
+            if (_count >= array.size())
+                _count = 0;
+            size_t chunk = std::min<size_t>(n, array.size() - _count);
+            std::copy(array.begin() + _count, array.begin() + _count + chunk, out);
+            _count += chunk;
+            out += chunk;
+            n -= chunk;
+        }
+    }
+
+    void DetVar::saveState(BinaryWriter &w) const
+    {
+        RandomVar::saveState(w);
+        w.put<uint32_t>(_count);
+    }
+
+    void DetVar::loadState(BinaryReader &r)
+    {
+        RandomVar::loadState(r);
+        _count = r.get<uint32_t>();
     }
 
     double DetVar::getMaximum() throw(MaxException)
     {
-        if (_array.empty()) return 0;
-        double max = _array[0];
-        for (unsigned int i = 1; i < _array.size(); i++)
-            if (_array[i] > max) max = _array[i];
-        return max;
+        const vector<double> &array = *_array;
+        if (array.empty()) return 0;
+        return *std::max_element(array.begin(), array.end());
     }
 
     double DetVar::getMinimum() throw(MaxException)
     {
-        if (_array.empty()) return 0;
-        double min = _array[0];
-        for (unsigned int i = 1; i < _array.size(); i++)
-            if (_array[i] < min) min = _array[i];
-        return min;
+        const vector<double> &array = *_array;
+        if (array.empty()) return 0;
+        return *std::min_element(array.begin(), array.end());
     }
 
     RandomVar *DetVar::createInstance(vector<string> &par) 
@@ -311,13 +582,45 @@ namespace tres {
         return new DetVar(par[0]);
     } 
     
+    void DistVar::buildTable()
+    {
+        // Convert the cumulative probabilities
+        // into the probabilities of each value
+        vector<double> values, probs;
+        values.reserve(_array.size());
+        probs.reserve(_array.size());
+        double prev = 0;
+        for (auto i = _array.begin(); i != _array.end(); ++i)
+        {
+            if (i->second < prev)
+                throw Exc(Exc::_WRONGPDF, "DistVar");
+            values.push_back(i->first);
+            probs.push_back(i->second - prev);
+            prev = i->second;
+        }
+        _table.build(values, probs);
+    }
+
     double DistVar::get()
     {
-	    double p = UniformVar::get();
-	    //for (auto i : _array) 
-	    for (auto i = _array.begin(); i != _array.end();  ++i )
-	        if (p <= i->second) return i->first;
-	    throw string("cannot extract number in DistVar::get()!!");
+        double u1 = UniformVar::get();
+        double u2 = UniformVar::get();
+        return _table.sample(u1, u2);
+    }
+
+    void DistVar::fill(double *out, size_t n)
+    {
+        // Two uniform samples per value, in the order of get()
+        double u[2 * FILL_CHUNK];
+        while (n > 0)
+        {
+            size_t chunk = std::min<size_t>(n, FILL_CHUNK);
+            fillUniform(u, 2 * chunk);
+            for (size_t i = 0; i < chunk; ++i)
+                out[i] = _table.sample(u[2 * i], u[2 * i + 1]);
+            out += chunk;
+            n -= chunk;
+        }
     }
 
     double DistVar::getMaximum() throw(MaxException)
@@ -361,9 +664,12 @@ namespace tres {
     RandomVar *parsevar(const std::string &str)
     {
         RandomVar *temp;
-        string token = get_token(str);
-        string p = get_param(str);
-        vector<string> parms = split_param(p);
+        str_slice descr(str);
+        string token = get_token(descr).str();
+        vector<str_slice> p;
+        split_param(get_param(descr), p);
+        vector<string> parms;
+        to_strings(p, parms);
 
         std::unique_ptr<RandomVar> 
             var(Factory<RandomVar>::instance().create(token,parms));
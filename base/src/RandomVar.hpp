@@ -49,10 +49,14 @@
 
 #ifndef TRES_RANDOMVAR_HDR
 #define TRES_RANDOMVAR_HDR
+#include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
+#include "AliasTable.hpp"
+#include "RandomGen.hpp"
 #include "BaseExc.hpp"
 
 #ifdef _MSC_VER
@@ -64,7 +68,6 @@ namespace tres
 
     using namespace std;
 
-    typedef long int RandNum;
     const int MAX_SEEDS = 1000;
 
 #define _RANDOMVAR_DBG_LEV  "randomvar"
@@ -73,52 +76,6 @@ namespace tres
      * \addtogroup tres_utils
      * @{
      */
-    /** 
-     * \brief The basic class for Random Number Generator
-     *
-     * It is possible to derive from this class to implement a new generator
-     */
-    class RandomGen
-    {
-
-    public:
-        /**
-         * \brief Creates a Random Generator with s as initial seed
-         */
-        RandomGen(RandNum s);
-
-        /**
-         * \brief Initialize the generator with seed s
-         */
-        void init(RandNum s);
-
-        /**
-         * Extract the next random number from the sequence
-         */
-        RandNum sample();
-
-        /**
-         * \brief Returns the current sequence number
-         */
-        RandNum getCurrSeed() { return _xn; }
-
-        /**
-         * \brief Return the constant M (the module of this random generator)
-         */
-        RandNum getModule() { return M; }
-
-    private:
-
-        RandNum _seed;
-        RandNum _xn;
-
-        // constants used by the internal pseudo-causal number generator. 
-        static const RandNum A;
-        static const RandNum M;
-        static const RandNum Q;	// M div A
-        static const RandNum R;	// M mod A
-    };
-
     /**
      * \brief The basic abstract class for random variables
      *
@@ -191,22 +148,110 @@ namespace tres
         /// Restore the standard generator
         static void restoreGenerator();
 
+        /**
+         * \brief Select the standard generator by name
+         *
+         * The generator is created through the RandomGen factory
+         * ("minstd", "xoshiro256**", "pcg64") and owned by RandomVar.
+         * Random variables bind to the standard generator when they are
+         * built, hence this must be called before creating them. The
+         * generators selected before are kept (the variables already
+         * built still draw from theirs).
+         *
+         * @throw BaseExc if no generator is registered with that name
+         */
+        static void selectGenerator(const string &name, RandNum seed);
+
+        /**
+         * \brief Save the positions of the generators owned by RandomVar
+         *
+         * That is the standard generator, the default one and those
+         * created by selectGenerator(), since variables built earlier may
+         * still be bound to them. They are restored in the same order,
+         * hence the generators must be selected in the same way before
+         * loadGenerator().
+         *
+         * \throw BinaryIOExc if a generator does not support snapshots
+         */
+        static void saveGenerator(BinaryWriter &w);
+
+        /**
+         * \brief Restore the positions saved by saveGenerator()
+         *
+         * \throw BinaryIOExc if the generators are not the saved ones
+         */
+        static void loadGenerator(BinaryReader &r);
+
+        /**
+         * \brief Start a new stream of the generators owned by RandomVar
+         *
+         * The standard generator is initialized with a seed derived from
+         * the pair (seed, stream), and the samples that the random
+         * variables have drawn in advance are discarded (see getEpoch()).
+         * This gives each branch of a simulation its own sequence (see
+         * tres::BranchRunner). The generators that were standard before
+         * (the default one, and those created by selectGenerator()) are
+         * reseeded as well, each with a seed of its own, since variables
+         * built earlier are still bound to them. Generators passed to a
+         * variable, or to changeGenerator() and replaced since, are not
+         * affected.
+         */
+        static void reseed(RandNum seed, uint64_t stream);
+
+        /**
+         * \brief Number of calls of reseed() so far
+         *
+         * Samples drawn in advance under a previous epoch must not be used
+         */
+        static unsigned getEpoch() { return _epoch; }
+
         /** 
             This method must be overloaded in each derived
             class to return a double according to the propoer
             distriibution. */
         virtual double get() = 0;
 
+        /**
+         * \brief Draw \c n samples at once and store them in \c out
+         *
+         * The result is the same sequence that \c n consecutive calls
+         * of get() would return. The default implementation does exactly
+         * that; derived classes override it to avoid a virtual call per
+         * sample and to keep the transformation of the uniform samples in
+         * a separate, branch-free loop that the compiler can vectorize.
+         */
+        virtual void fill(double *out, size_t n);
+
         virtual double getMaximum() throw(MaxException) = 0;
         virtual double getMinimum() throw(MaxException) = 0;
 
+        /**
+         * \brief Save the state of the variable
+         *
+         * The state includes the position of the generator of the
+         * variable when it is not owned by RandomVar (those are saved by
+         * saveGenerator()). Derived classes with a state of their own
+         * extend it.
+         */
+        virtual void saveState(BinaryWriter &w) const;
+
+        /**
+         * \brief Restore a state saved by saveState()
+         *
+         * The variable must have been built with the same parameters
+         */
+        virtual void loadState(BinaryReader &r);
+
     protected:
 
         static RandNum _seed;
         static RandNum _xn;
 
         /// Default generator.
-        static RandomGen _stdgen;
+        static MinStdGen _stdgen;
+
+        /// Number of calls of reseed()
+        static unsigned _epoch;
 
         /** Pointer to the current generator (used by the next
             RandomVar object to be created. */
@@ -228,6 +273,7 @@ namespace tres
     public:
         DeltaVar(double a) : RandomVar(), _var(a) {}
         virtual double get() { return _var; } 
+        virtual void fill(double *out, size_t n);
         virtual ~DeltaVar() {};
         static RandomVar *createInstance(vector<string> &par);  
         virtual double getMaximum() throw(MaxException) {return _var;}
@@ -243,10 +289,26 @@ namespace tres
         UniformVar(double min, double max, RandomGen *g = NULL) 
             : RandomVar(g), _min(min), _max(max) {}
         virtual double get();
+
+        /**
+         * \brief Draw \c n uniform samples at once
+         *
+         * Derived classes that do not override fill() draw one sample at
+         * a time through their get(), so that they never get the uniform
+         * samples of this class in place of their own distribution.
+         */
+        virtual void fill(double *out, size_t n);
         virtual ~UniformVar() {}
         static RandomVar *createInstance(vector<string> &par);
         virtual double getMaximum() throw(MaxException) {return _max;}
         virtual double getMinimum() throw(MaxException) {return _min;}
+    protected:
+        /** The uniform samples of fill(), for the derived classes */
+        void fillUniform(double *out, size_t n);
+
+        /** Values per chunk, for the derived classes drawing several
+            uniform samples per value */
+        static const size_t FILL_CHUNK = 64;
     };
 
     /**
@@ -258,6 +320,7 @@ namespace tres
             UniformVar(0, 1, g), _lambda(m) {}
 
         virtual double get();
+        virtual void fill(double *out, size_t n);
 
         static RandomVar *createInstance(vector<string> &par);
         virtual double getMaximum() throw(MaxException)
@@ -274,6 +337,7 @@ namespace tres
         ParetoVar(double m, double k, RandomGen *g = NULL) : 
             UniformVar(0,1,g), _mu(m), _order(k) {};
         virtual double get();
+        virtual void fill(double *out, size_t n);
         static RandomVar *createInstance(vector<string> &par);
         virtual double getMaximum() throw(MaxException)
             {throw MaxException("ExponentialVar");}
@@ -289,12 +353,16 @@ namespace tres
         double _mu, _sigma;
         bool _yes;
         double _oldv;
+        unsigned _old_epoch;
   
     public:
         NormalVar(double m, double s, RandomGen *g = NULL) : 
-            UniformVar(0,1,g), _mu(m), _sigma(s), _yes(false)
+            UniformVar(0,1,g), _mu(m), _sigma(s), _yes(false), _oldv(0), _old_epoch(0)
             {}
         virtual double get();
+        virtual void fill(double *out, size_t n);
+        virtual void saveState(BinaryWriter &w) const;
+        virtual void loadState(BinaryReader &r);
         static RandomVar *createInstance(vector<string> &par);
         virtual double getMaximum() throw(MaxException)
             {throw MaxException("NormalVar");}
@@ -304,14 +372,40 @@ namespace tres
 
 
     /**
-       This class implements a Poisson distribution, with mean lambda */
+       This class implements a Poisson distribution, with mean lambda.
+
+       For small values of lambda, samples are obtained by inverting a
+       CDF table computed once at construction. For large values of
+       lambda, samples are obtained with the PTRS transformed rejection
+       method (W. Hormann, "The transformed rejection method for
+       generating Poisson random variables", 1993), which takes constant
+       expected time. The method is chosen by the constructor. */
     class PoissonVar : public UniformVar {
         double _lambda;
+
+        /** CDF table used for small values of lambda (empty otherwise) */
+        vector<double> _cdf;
+
+        /** \name Constants of the PTRS method (large values of lambda)
+         * @{ */
+        double _slam, _loglam, _a, _b, _invalpha, _vr;
+        /** @} */
+
+        /** Invert the CDF for the given uniform sample */
+        double invert(double u) const;
+
+        /** Draw a sample with the PTRS method */
+        double ptrs();
+
     public:
         static const unsigned long CUTOFF;
-        PoissonVar(double l, RandomGen *g = NULL) : 
-            UniformVar(0, 1, g), _lambda(l) {}
+
+        /** Lambda from which the PTRS method is used */
+        static const double PTRS_THRESHOLD;
+
+        PoissonVar(double l, RandomGen *g = NULL);
         virtual double get();
+        virtual void fill(double *out, size_t n);
 
         static RandomVar *createInstance(vector<string> &par);
         virtual double getMaximum() throw(MaxException)
@@ -329,13 +423,17 @@ namespace tres
        starts over.
     */
     class DetVar : public RandomVar {
-        vector<double> _array;
+        /** The sequence (shared by the variables reading the same file) */
+        std::shared_ptr<const vector<double> > _array;
         unsigned int _count;
     public:
         DetVar(const std::string &filename);
         DetVar(vector<double> &a);
         DetVar(double a[], int s);
         virtual double get();
+        virtual void fill(double *out, size_t n);
+        virtual void saveState(BinaryWriter &w) const;
+        virtual void loadState(BinaryReader &r);
         virtual ~DetVar(){}
         virtual double getMaximum() throw(MaxException);
         virtual double getMinimum() throw(MaxException);
@@ -345,24 +443,30 @@ namespace tres
 
     /**
        This class implements a generic discrete distribution.  It
-       takes a list of pairs (value, prob), and build an internal list.
-       A certain value will occur with the specified probability
+       takes a list of pairs (value, cumulative prob), and build an
+       internal list. A certain value will occur with the probability
+       given by the difference of its cumulative probability and the
+       one of the previous value. Values are drawn in constant time
+       through an alias table.
      */
     class DistVar : public UniformVar {
     public:
 	typedef std::pair<double, double> Elem; 
 
 	template <typename It>
-	DistVar(It a, It e) : UniformVar(0,1), _array(a, e) {}
+	DistVar(It a, It e) : UniformVar(0,1), _array(a, e) { buildTable(); }
 
-	DistVar(std::initializer_list<Elem> x) : UniformVar(0,1), _array(x) {};
+	DistVar(std::initializer_list<Elem> x) : UniformVar(0,1), _array(x) { buildTable(); }
 	virtual double get();
+        virtual void fill(double *out, size_t n);
 	virtual ~DistVar() {}
         virtual double getMaximum() throw(MaxException);
         virtual double getMinimum() throw(MaxException);
         static RandomVar *createInstance(vector<string> &par);
     private:
 	vector<pair<double, double>> _array;
+	AliasTable _table;
+	void buildTable();
     };
     /** @} */
 }
@@ -39,6 +39,7 @@
 #ifndef TRES_SEGMENT_HDR
 #define TRES_SEGMENT_HDR
 #include <string>
+#include <tres/BinaryIO.hpp>
 
 namespace tres
 {
@@ -70,6 +71,16 @@ namespace tres
          * \brief Get the total computation time of the instruction 
          */
         virtual double getDuration() const = 0;
+
+        /**
+         * \brief Save the state of the instruction (none by default)
+         */
+        virtual void saveState(BinaryWriter &) const {}
+
+        /**
+         * \brief Restore a state saved by saveState()
+         */
+        virtual void loadState(BinaryReader &) {}
     };
     /** @} */
 }
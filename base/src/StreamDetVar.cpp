@@ -0,0 +1,320 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file StreamDetVar.cpp
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <tres/ParseUtils.hpp>
+#include "StreamDetVar.hpp"
+
+namespace tres
+{
+    using namespace std;
+    using namespace tres_parse_utils;
+
+    static const char TRACE_MAGIC[4] = { 'T', 'R', 'S', 'T' };
+    static const uint8_t TRACE_VERSION = 1;
+
+    /** Size of the header: magic, version, encoding, 2 reserved bytes,
+     *  count, scale, min, max */
+    static const streamoff HEADER_SIZE = 4 + 1 + 1 + 2 + 8 + 8 + 8 + 8;
+
+    /** Size of the read buffer of DELTA_VARINT traces */
+    static const size_t BYTES_SIZE = 65536;
+
+    static bool isLittleEndian()
+    {
+        const uint16_t one = 1;
+        return *reinterpret_cast<const uint8_t *>(&one) == 1;
+    }
+
+    template <typename T>
+    static T readField(const char *&p)
+    {
+        T v;
+        memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+
+    template <typename T>
+    static void writeField(ofstream &f, const T &v)
+    {
+        f.write(reinterpret_cast<const char *>(&v), sizeof(T));
+    }
+
+    StreamDetVar::StreamDetVar(const string &filename, uint64_t offset) :
+        RandomVar(),
+        _filename(filename),
+        _file(filename.c_str(), ios::in | ios::binary),
+        _encoding(RAW),
+        _count(0),
+        _scale(1),
+        _min(0),
+        _max(0),
+        _wpos(0),
+        _next(0),
+        _bpos(0),
+        _last(0)
+    {
+        if (!_file.is_open())
+            throw Exc(Exc::_FILEOPEN + filename + "\n", "StreamDetVar");
+        if (!isLittleEndian())
+            throw Exc("Trace files are only supported on little-endian hosts", "StreamDetVar");
+
+        // Read and check the header
+        char h[HEADER_SIZE];
+        _file.read(h, HEADER_SIZE);
+        const char *p = h;
+        if (_file.gcount() != HEADER_SIZE || memcmp(p, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0)
+            throw Exc("Malformed trace file " + filename + "\n", "StreamDetVar");
+        p += sizeof(TRACE_MAGIC);
+        uint8_t version = readField<uint8_t>(p);
+        uint8_t encoding = readField<uint8_t>(p);
+        readField<uint16_t>(p);
+        _count = readField<uint64_t>(p);
+        _scale = readField<double>(p);
+        _min = readField<double>(p);
+        _max = readField<double>(p);
+        if (version != TRACE_VERSION || encoding > DELTA_VARINT)
+            throw Exc("Unsupported trace file " + filename + "\n", "StreamDetVar");
+        _encoding = static_cast<Encoding>(encoding);
+
+        if (offset > 0)
+            seek(offset);
+    }
+
+    void StreamDetVar::rewind()
+    {
+        _file.clear();
+        _file.seekg(HEADER_SIZE);
+        _next = 0;
+        _bytes.clear();
+        _bpos = 0;
+        _last = 0;
+    }
+
+    void StreamDetVar::seek(uint64_t index)
+    {
+        _window.clear();
+        _wpos = 0;
+        if (_count == 0)
+            return;
+        index %= _count;
+        if (_encoding == RAW)
+        {
+            _file.clear();
+            _file.seekg(HEADER_SIZE + static_cast<streamoff>(index * sizeof(double)));
+            _next = index;
+        }
+        else
+        {
+            // Varints can only be decoded sequentially
+            rewind();
+            for (; _next < index; ++_next)
+                decode();
+        }
+    }
+
+    uint8_t StreamDetVar::nextByte()
+    {
+        if (_bpos == _bytes.size())
+        {
+            _bytes.resize(BYTES_SIZE);
+            _file.read(_bytes.data(), BYTES_SIZE);
+            _bytes.resize(static_cast<size_t>(_file.gcount()));
+            _bpos = 0;
+            if (_bytes.empty())
+                throw Exc("Truncated trace file " + _filename + "\n", "StreamDetVar");
+        }
+        return static_cast<uint8_t>(_bytes[_bpos++]);
+    }
+
+    double StreamDetVar::decode()
+    {
+        // LEB128 varint
+        uint64_t u = 0;
+        int shift = 0;
+        uint8_t b;
+        do
+        {
+            if (shift > 63)
+                throw Exc("Malformed trace file " + _filename + "\n", "StreamDetVar");
+            b = nextByte();
+            u |= static_cast<uint64_t>(b & 0x7f) << shift;
+            shift += 7;
+        } while (b & 0x80);
+
+        // Zig-zag decoding of the difference
+        _last += static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1);
+        return _last * _scale;
+    }
+
+    void StreamDetVar::refill()
+    {
+        // Start over at the end of the trace
+        if (_next == _count)
+            rewind();
+
+        size_t n = static_cast<size_t>(min<uint64_t>(WINDOW_SIZE, _count - _next));
+        _window.resize(n);
+        if (_encoding == RAW)
+        {
+            _file.read(reinterpret_cast<char *>(_window.data()), n * sizeof(double));
+            if (static_cast<size_t>(_file.gcount()) != n * sizeof(double))
+                throw Exc("Truncated trace file " + _filename + "\n", "StreamDetVar");
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                _window[i] = decode();
+        }
+        _next += n;
+        _wpos = 0;
+    }
+
+    double StreamDetVar::get()
+    {
+        if (_count == 0)
+            return 0;
+        if (_wpos == _window.size())
+            refill();
+        return _window[_wpos++];
+    }
+
+    void StreamDetVar::fill(double *out, size_t n)
+    {
+        if (_count == 0)
+        {
+            std::fill(out, out + n, 0.0);
+            return;
+        }
+
+        // Copy the samples window by window
+        while (n > 0)
+        {
+            if (_wpos == _window.size())
+                refill();
+            size_t chunk = min(n, _window.size() - _wpos);
+            copy(_window.begin() + _wpos, _window.begin() + _wpos + chunk, out);
+            _wpos += chunk;
+            out += chunk;
+            n -= chunk;
+        }
+    }
+
+    void StreamDetVar::saveState(BinaryWriter &w) const
+    {
+        RandomVar::saveState(w);
+        w.put<uint64_t>(_next - (_window.size() - _wpos));
+    }
+
+    void StreamDetVar::loadState(BinaryReader &r)
+    {
+        RandomVar::loadState(r);
+        seek(r.get<uint64_t>());
+    }
+
+    void StreamDetVar::writeFile(const string &filename, const vector<double> &samples,
+                                 Encoding enc, double scale)
+    {
+        if (!isLittleEndian())
+            throw Exc("Trace files are only supported on little-endian hosts", "StreamDetVar");
+        if (enc == DELTA_VARINT && !(scale > 0))
+            throw Exc("The quantization step must be positive", "StreamDetVar");
+
+        ofstream f(filename.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!f.is_open())
+            throw Exc(Exc::_FILEOPEN + filename + "\n", "StreamDetVar");
+
+        double mn = 0, mx = 0;
+        if (!samples.empty())
+        {
+            mn = *min_element(samples.begin(), samples.end());
+            mx = *max_element(samples.begin(), samples.end());
+        }
+
+        f.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        writeField<uint8_t>(f, TRACE_VERSION);
+        writeField<uint8_t>(f, static_cast<uint8_t>(enc));
+        writeField<uint16_t>(f, 0);
+        writeField<uint64_t>(f, samples.size());
+        writeField<double>(f, enc == DELTA_VARINT ? scale : 1.0);
+        writeField<double>(f, mn);
+        writeField<double>(f, mx);
+
+        if (enc == RAW)
+        {
+            if (!samples.empty())
+                f.write(reinterpret_cast<const char *>(samples.data()), samples.size() * sizeof(double));
+        }
+        else
+        {
+            int64_t last = 0;
+            for (vector<double>::const_iterator s = samples.begin(); s != samples.end(); ++s)
+            {
+                int64_t q = llround(*s / scale);
+                int64_t d = q - last;
+                last = q;
+                uint64_t u = (static_cast<uint64_t>(d) << 1) ^ static_cast<uint64_t>(d >> 63);
+                do
+                {
+                    uint8_t b = u & 0x7f;
+                    u >>= 7;
+                    if (u)
+                        b |= 0x80;
+                    f.put(static_cast<char>(b));
+                } while (u);
+            }
+        }
+
+        if (!f.good())
+            throw Exc("Unable to write " + filename + "\n", "StreamDetVar");
+    }
+
+    RandomVar *StreamDetVar::createInstance(vector<string> &par)
+    {
+        if (par.size() < 1 || par.size() > 2)
+            throw ParseExc("Wrong number of parameters", "StreamDetVar");
+        uint64_t offset = 0;
+        if (par.size() == 2)
+            offset = strtoull(par[1].c_str(), NULL, 10);
+        return new StreamDetVar(par[0], offset);
+    }
+}
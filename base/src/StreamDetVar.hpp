@@ -0,0 +1,185 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file StreamDetVar.hpp
+ */
+
+#ifndef TRES_STREAMDETVAR_HDR
+#define TRES_STREAMDETVAR_HDR
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "RandomVar.hpp"
+
+namespace tres
+{
+    /**
+     * \addtogroup tres_utils
+     * @{
+     */
+    /**
+     * \brief Deterministic variable streaming a (large) binary trace file
+     *
+     * Like DetVar, it returns the numbers of a sequence and starts over
+     * when the end of the sequence is reached; however, the sequence is
+     * read from the file in windows of WINDOW_SIZE samples, so that the
+     * memory footprint does not depend on the length of the trace.
+     *
+     * Trace files are made of a header followed by the samples, stored
+     * either as raw doubles or as delta-encoded varints (see Encoding);
+     * they are written by writeFile(). All the numbers are in the
+     * little-endian format.
+     */
+    class StreamDetVar : public RandomVar
+    {
+
+    public:
+
+        /** Encoding of the samples in a trace file */
+        enum Encoding
+        {
+            /** Samples are stored as doubles */
+            RAW = 0,
+            /**
+             * Samples are quantized (with the scale given in the header),
+             * and the differences between consecutive quantized samples are
+             * stored as zig-zag encoded LEB128 varints
+             */
+            DELTA_VARINT = 1
+        };
+
+        /** Number of samples read at once */
+        static const std::size_t WINDOW_SIZE = 4096;
+
+        /**
+         * \brief Open a trace file, starting from the offset-th sample
+         *
+         * \throw RandomVar::Exc if the file cannot be opened or is malformed
+         */
+        StreamDetVar(const std::string &filename, uint64_t offset = 0);
+
+        virtual ~StreamDetVar() {}
+
+        virtual double get();
+
+        virtual void fill(double *out, std::size_t n);
+
+        /** The state is the position in the trace (restored with seek()) */
+        virtual void saveState(BinaryWriter &w) const;
+
+        virtual void loadState(BinaryReader &r);
+
+        /** Largest sample of the trace (recorded in the header) */
+        virtual double getMaximum() throw(MaxException) { return _max; }
+
+        /** Smallest sample of the trace (recorded in the header) */
+        virtual double getMinimum() throw(MaxException) { return _min; }
+
+        /**
+         * \brief Continue from the index-th sample (modulo the length of the trace)
+         *
+         * This is meant to give a different start offset to each
+         * replication of a simulation. Seeking a DELTA_VARINT trace
+         * takes time linear in the index.
+         */
+        void seek(uint64_t index);
+
+        /**
+         * \brief Number of samples in the trace
+         */
+        uint64_t size() const { return _count; }
+
+        /**
+         * \brief Write a trace file
+         *
+         * \param scale is the quantization step for the DELTA_VARINT encoding
+         * \throw RandomVar::Exc if the file cannot be written
+         */
+        static void writeFile(const std::string &filename, const std::vector<double> &samples,
+                              Encoding enc = RAW, double scale = 1e-9);
+
+        /**
+         * \brief Instance creator: parameters are the file name and the
+         * (optional) start offset
+         */
+        static RandomVar *createInstance(vector<string> &par);
+
+    private:
+
+        StreamDetVar(const StreamDetVar &);
+        StreamDetVar &operator=(const StreamDetVar &);
+
+        /** Load the next window of samples (starting over at the end of the trace) */
+        void refill();
+
+        /** Go back to the first sample */
+        void rewind();
+
+        /** Decode the next sample of a DELTA_VARINT trace */
+        double decode();
+
+        /** Read the next byte of a DELTA_VARINT trace */
+        uint8_t nextByte();
+
+        std::string _filename;
+        std::ifstream _file;
+
+        /** \name Header fields
+         * @{ */
+        Encoding _encoding;
+        uint64_t _count;
+        double _scale;
+        double _min;
+        double _max;
+        /** @} */
+
+        /** The current window of samples */
+        std::vector<double> _window;
+        std::size_t _wpos;
+
+        /** Index (in the trace) of the sample following the window */
+        uint64_t _next;
+
+        /** \name Decoding state (DELTA_VARINT traces)
+         * @{ */
+        std::vector<char> _bytes;
+        std::size_t _bpos;
+        int64_t _last;
+        /** @} */
+    };
+    /** @} */
+}
+#endif // TRES_STREAMDETVAR_HDR
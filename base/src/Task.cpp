@@ -38,39 +38,102 @@
 
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <tres/Factory.hpp>
 #include <tres/ParseUtils.hpp>
 #include <tres/Task.hpp>
+#include "FixedExecSegment.hpp"
 
 namespace tres
 {
+    /**
+     * Durations of the fixed-duration segment descriptors parsed so far.
+     * The table is shared by all the tasks, so that each distinct
+     * descriptor is parsed (and built through the factory) only once
+     */
+    static std::mutex _fixed_mutex;
+    static std::unordered_map<std::string, double> _fixed_durations;
+
     Task::Task(const std::vector<std::string>& instr)
     {
-        // Add pseudo instructions
-        for (unsigned int i=0; i < instr.size(); ++i)
+        using namespace tres_parse_utils;
+
+        // Buffers reused for all the pseudo instructions
+        std::vector<str_slice> par_slices;
+        std::vector<std::string> par_list;
+
+        _segment_q.reserve(instr.size());
+        try
         {
-            using namespace tres_parse_utils;
-            // Extract the token ("fixed", "delay", ...)
-            std::string token = get_token(instr[i]);
+            // Add pseudo instructions
+            for (unsigned int i=0; i < instr.size(); ++i)
+            {
+                _Slot slot;
+                slot.kind = _Slot::FIXED;
+                slot.duration = 0;
+                slot.seg = NULL;
+
+                // Look for the descriptor among the known fixed-duration ones
+                {
+                    std::lock_guard<std::mutex> lock(_fixed_mutex);
+                    std::unordered_map<std::string, double>::const_iterator f = _fixed_durations.find(instr[i]);
+                    if (f != _fixed_durations.end())
+                    {
+                        slot.duration = f->second;
+                        _segment_q.push_back(slot);
+                        continue;
+                    }
+                }
+
+                // Extract the token ("fixed", "delay", ...)
+                str_slice ins(instr[i]);
+                std::string token = get_token(ins).str();
 
-            // Extract the list of parameters
-            std::string param = get_param(instr[i]);
-            std::vector<std::string> par_list = split_param(param);
+                // Extract the list of parameters
+                split_param(get_param(ins), par_slices);
+                to_strings(par_slices, par_list);
 
-            // Create the corresponding Segment
-            std::unique_ptr<Segment> curr = Factory<Segment>::instance().create(token, par_list);
+                // Create the corresponding Segment
+                std::unique_ptr<Segment> curr = Factory<Segment>::instance().create(token, par_list);
+                if (!curr.get()) throw ParseExc("Task", token);
 
-            // Add it to the segment_q
-            Segment *curr_instr = curr.release();
-            if (!curr_instr) throw ParseExc("Task", token);
-            _segment_q.push_back(curr_instr);
+                // Add it to the segment_q
+                if (FixedExecSegment *fixed = dynamic_cast<FixedExecSegment *>(curr.get()))
+                {
+                    slot.duration = fixed->getDuration();
+                    std::lock_guard<std::mutex> lock(_fixed_mutex);
+                    _fixed_durations[instr[i]] = slot.duration;
+                }
+                else
+                {
+                    slot.kind = dynamic_cast<RandExecSegment *>(curr.get()) ? _Slot::RANDOM : _Slot::OTHER;
+                    slot.seg = curr.release();
+                }
+                _segment_q.push_back(slot);
+            }
         }
+        catch (...)
+        {
+            for (std::vector<_Slot>::iterator s = _segment_q.begin(); s != _segment_q.end(); ++s)
+                delete s->seg;
+            throw;
+        }
+
+        if (_segment_q.empty())
+            throw ParseExc("Task", "(empty task body)");
 
-        // Initialize the pointer to the running segment
-        _run_seg = _segment_q.begin();
+        // Initialize the index of the running segment
+        _run_seg = 0;
 
         // Initialize the residual time to segment completion
-        _run_seg_duration = (*_run_seg)->getDuration();
+        _run_seg_duration = nextDuration(_segment_q[0]);
+    }
+
+    Task::~Task()
+    {
+        for (std::vector<_Slot>::iterator s = _segment_q.begin(); s != _segment_q.end(); ++s)
+            delete s->seg;
     }
 
     int Task::getNumberOfSegments() const
@@ -83,13 +146,21 @@ namespace tres
         return (_run_seg_duration);
     }
 
+    double Task::getWCET() const
+    {
+        double wcet = 0;
+        for (std::vector<_Slot>::const_iterator s = _segment_q.begin(); s != _segment_q.end(); ++s)
+            wcet += (s->kind == _Slot::FIXED) ? s->duration : s->seg->getWCET();
+        return wcet;
+    }
+
     int Task::processSegment()
     {
         // Index of the segment which is being activated
         // for the execution -- act_seg_idx indicates that
         // the barrier of the last segment must be activated
-        // when _run_seg == _segment_q.end() (see below)
-        int act_seg_idx = _run_seg - _segment_q.begin();
+        // when _run_seg == _segment_q.size() (see below)
+        int act_seg_idx = _run_seg;
 
         // Note that when _run_seg points to the
         // _past-the-end_ segment (i.e., the
@@ -100,11 +171,11 @@ namespace tres
         //
         // If _run_seg already points to the
         // past-the-end segment
-        if (_run_seg == _segment_q.end())
+        if (_run_seg == _segment_q.size())
         {
             // The next task segment to be
             // executed is the first one
-            _run_seg = _segment_q.begin();
+            _run_seg = 0;
 
             // do nothing else! (_run_seg_duration has
             // already initialized)
@@ -116,18 +187,42 @@ namespace tres
             // operation caused _run_seg
             // to point the past-the-end
             // segment
-            if (++_run_seg == _segment_q.end())
+            if (++_run_seg == _segment_q.size())
                 // Re-Initialize _run_seg_duration with
                 // the duration of first segment: use the
                 // negative sign to indicate the task has
                 // completed its execution
-                _run_seg_duration = -(*_segment_q.begin())->getDuration();
+                _run_seg_duration = -nextDuration(_segment_q[0]);
             else
                 // Re-Initialize _run_seg_duration
-                _run_seg_duration = (*_run_seg)->getDuration();
+                _run_seg_duration = nextDuration(_segment_q[_run_seg]);
         }
 
         // Return act_seg_idx
         return(act_seg_idx);
     }
+
+    void Task::saveState(BinaryWriter &w) const
+    {
+        w.put<uint64_t>(_segment_q.size());
+        w.put<uint64_t>(_run_seg);
+        w.put(_run_seg_duration);
+        for (std::vector<_Slot>::const_iterator s = _segment_q.begin(); s != _segment_q.end(); ++s)
+            if (s->seg != NULL)
+                s->seg->saveState(w);
+    }
+
+    void Task::loadState(BinaryReader &r)
+    {
+        if (r.get<uint64_t>() != _segment_q.size())
+            throw BinaryIOExc("The state belongs to a different task");
+        const uint64_t run_seg = r.get<uint64_t>();
+        if (run_seg > _segment_q.size())
+            throw BinaryIOExc("Malformed task state");
+        _run_seg = static_cast<std::vector<_Slot>::size_type>(run_seg);
+        _run_seg_duration = r.get<double>();
+        for (std::vector<_Slot>::iterator s = _segment_q.begin(); s != _segment_q.end(); ++s)
+            if (s->seg != NULL)
+                s->seg->loadState(r);
+    }
 }
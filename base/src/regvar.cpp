@@ -35,8 +35,9 @@
 /**
  * \file regvar.cpp
  *
- * Register random variables into the tres::Factory registry. Random variables
- * can also be registered with two (or more) different names.
+ * Register random variables (and random number generators) into the
+ * tres::Factory registry. Random variables can also be registered with two
+ * (or more) different names.
  *
  * \warning Users should never access objects of this file; it is used just
  * for initialization of the objects needed for the abstract factory that
@@ -47,6 +48,7 @@
 #include <tres/Factory.hpp>
 #include <tres/ParseUtils.hpp>
 #include "GenericVar.hpp"
+#include "StreamDetVar.hpp"
 
 using namespace std;
 
@@ -102,6 +104,11 @@ namespace tres
                              RandomVar::BASE_KEY_TYPE>
     registerDet("trace");
 
+    static registerInFactory<RandomVar,
+                             StreamDetVar,
+                             RandomVar::BASE_KEY_TYPE>
+    registerStreamDet("stream");
+
     static registerInFactory<RandomVar,
                              GenericVar,
                              RandomVar::BASE_KEY_TYPE>
@@ -111,4 +118,29 @@ namespace tres
                              DistVar,
                              RandomVar::BASE_KEY_TYPE>
     registerDist("dist");
+
+    static registerInFactory<RandomGen,
+                             MinStdGen,
+                             RandomGen::BASE_KEY_TYPE>
+    registerMinStd1("minstd");
+
+    static registerInFactory<RandomGen,
+                             MinStdGen,
+                             RandomGen::BASE_KEY_TYPE>
+    registerMinStd2("legacy");
+
+    static registerInFactory<RandomGen,
+                             Xoshiro256Gen,
+                             RandomGen::BASE_KEY_TYPE>
+    registerXoshiro1("xoshiro256**");
+
+    static registerInFactory<RandomGen,
+                             Xoshiro256Gen,
+                             RandomGen::BASE_KEY_TYPE>
+    registerXoshiro2("xoshiro");
+
+    static registerInFactory<RandomGen,
+                             Pcg64Gen,
+                             RandomGen::BASE_KEY_TYPE>
+    registerPcg("pcg64");
 }
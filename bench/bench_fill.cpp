@@ -0,0 +1,115 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_fill.cpp
+ *
+ * Check that RandomVar::fill() returns the same sequence as consecutive
+ * calls of get() for each distribution, and compare their throughput
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GenericVar.hpp"
+#include "RandomVar.hpp"
+#include "Bench.hpp"
+
+using namespace tres;
+using namespace tres_bench;
+
+/** Build a variable bound to a generator of its own */
+typedef RandomVar* (*Maker)();
+
+static void run(const char *name, Maker make)
+{
+    const size_t N = 1 << 20;
+    std::vector<double> a(N), b(N);
+
+    // Same seed, separate generators
+    MinStdGen g1(12345), g2(12345);
+    RandomVar::changeGenerator(&g1);
+    std::unique_ptr<RandomVar> v1(make());
+    RandomVar::changeGenerator(&g2);
+    std::unique_ptr<RandomVar> v2(make());
+    RandomVar::restoreGenerator();
+
+    double t0 = now();
+    for (size_t i = 0; i < N; ++i)
+        a[i] = v1->get();
+    double t1 = now();
+    // Odd chunks, to cross the internal chunks of the variables
+    for (size_t i = 0; i < N; i += 1000)
+        v2->fill(&b[i], std::min<size_t>(1000, N - i));
+    double t2 = now();
+
+    size_t diff = 0;
+    for (size_t i = 0; i < N; ++i)
+        if (a[i] != b[i])
+            ++diff;
+    std::printf("%-12s get %7.1f Msamples/s  fill %7.1f Msamples/s  mismatches %zu\n",
+                name, N / (t1 - t0) / 1e6, N / (t2 - t1) / 1e6, diff);
+    check(diff == 0, name);
+}
+
+static RandomVar* uniform() { return new UniformVar(2, 5); }
+static RandomVar* exponential() { return new ExponentialVar(3); }
+static RandomVar* pareto() { return new ParetoVar(1, 2.5); }
+static RandomVar* normal() { return new NormalVar(10, 2); }
+static RandomVar* poisson() { return new PoissonVar(4); }
+static RandomVar* poissonLarge() { return new PoissonVar(500); }
+static RandomVar* dist() { return new DistVar({ {3, 0.3}, {7, 1} }); }
+static RandomVar* generic() { return new GenericVar("bench_fill.pdf"); }
+
+int main()
+{
+    {
+        std::ofstream pdf("bench_fill.pdf");
+        pdf << "1 0.2\n10 0.8\n";
+    }
+
+    run("uniform", uniform);
+    run("exponential", exponential);
+    run("pareto", pareto);
+    run("normal", normal);
+    run("poisson", poisson);
+    run("poisson-ptrs", poissonLarge);
+    run("dist", dist);
+    run("pdf", generic);
+
+    std::remove("bench_fill.pdf");
+    return status();
+}
@@ -0,0 +1,149 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_multicore.cpp
+ *
+ * Scheduling cost of the native kernel with many cores and tasks
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <tres_native/KernelNative.hpp>
+#include "Bench.hpp"
+
+using namespace tres;
+using namespace tres_bench;
+
+/** Simulate n random periodic tasks (total utilization 0.7 per core) on
+ * m cores up to the given time, as the co-simulation does (each job runs
+ * one instruction), and return the time per event (ns) */
+static double run(int m, int n, const char *policy, const char *mode, const char *packing,
+                  long long horizon, KernelNative::Stats &stats)
+{
+    std::mt19937 rng(7);
+    KernelConfig kc;
+    kc.name = "bench";
+    kc.num_cores = m;
+    kc.scheduler.policy = policy;
+    kc.scheduler.params.push_back(mode);
+    if (packing)
+        kc.scheduler.params.push_back(packing);
+    for (int i = 0; i < n; ++i)
+    {
+        TaskConfig t;
+        t.type = "PeriodicTask";
+        t.name = "T" + std::to_string(i);
+        t.iat = 1000 + rng() % 9000;
+        t.rdl = t.iat;
+        t.ph = rng() % 100;
+        kc.tasks.push_back(t);
+    }
+    std::vector<double> c(n);
+    std::vector<const double*> pc(n);
+    for (int i = 0; i < n; ++i)
+    {
+        c[i] = kc.tasks[i].iat * 0.7 * m / n * (0.5 + (rng() % 100) / 100.0);
+        pc[i] = &c[i];
+    }
+
+    KernelNative *k = static_cast<KernelNative*>(KernelNative::createInstance(kc));
+    k->initializeSimulation(1, pc.data());
+    double t0 = now();
+    while (k->getTimeOfNextEvent() < horizon)
+    {
+        long long t = k->getTimeOfNextEvent();
+        while (k->getTimeOfNextEvent() == t)
+        {
+            RTOSEvent *e = k->getNextEvent();
+            if (e->getType() == RTOSEventType::END_TASK)
+            {
+                // Task names are "T<index>"
+                SimTask *task = e->getGeneratorTask();
+                int i = std::atoi(task->getUID().c_str() + 1);
+                task->discardInstructions();
+                task->addInstruction(c[i]);
+            }
+            k->processNextEvent();
+        }
+        k->getRunningTasks();
+    }
+    double t1 = now();
+    stats = k->getStats();
+    delete k;
+    return (t1 - t0) / stats.events * 1e9;
+}
+
+static bool sameStats(const KernelNative::Stats &a, const KernelNative::Stats &b)
+{
+    return a.events == b.events && a.jobs == b.jobs && a.preemptions == b.preemptions
+        && a.migrations == b.migrations && a.deadline_misses == b.deadline_misses;
+}
+
+int main()
+{
+    const long long horizon = 200000;
+    const char *policies[] = { "EDF", "FIXED_PRIORITY" };
+    for (int m = 32; m <= 128; m *= 2)
+    {
+        const int n = 32 * m;
+        for (int p = 0; p < 2; ++p)
+        {
+            KernelNative::Stats g, cg, pt, cp, ffd, cl;
+            std::string cm = "clustered:" + std::to_string(m);
+            double tg = run(m, n, policies[p], "global", NULL, horizon, g);
+            run(m, n, policies[p], cm.c_str(), NULL, horizon, cg);
+            double tp = run(m, n, policies[p], "partitioned", NULL, horizon, pt);
+            run(m, n, policies[p], "clustered:1", NULL, horizon, cp);
+            double tf = run(m, n, policies[p], "partitioned", "ffd", horizon, ffd);
+            double tc = run(m, n, policies[p], "clustered:8", "wfd", horizon, cl);
+
+            // Global and partitioned scheduling are the extremes of the
+            // clustered one
+            check(sameStats(g, cg), "global == clustered:<cores>");
+            check(sameStats(pt, cp), "partitioned == clustered:1");
+
+            std::printf("%-14s %3d cores %4d tasks: global %5.0f  partitioned %5.0f  ffd %5.0f  "
+                        "clustered:8/wfd %5.0f ns/event (global: %llu migrations)\n",
+                        policies[p], m, n, tg, tp, tf, tc,
+                        static_cast<unsigned long long>(g.migrations));
+        }
+    }
+
+    return status();
+}
@@ -0,0 +1,219 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_parse.cpp
+ *
+ * Tokenization of a large model (10k task descriptors, 100k segment
+ * instructions) with the std::string parse functions of the previous
+ * versions and with the allocation-free str_slice ones
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <tres/ParseUtils.hpp>
+#include "Bench.hpp"
+
+using namespace tres_parse_utils;
+using namespace tres_bench;
+
+/** The std::string parse functions of the previous versions (reference) */
+namespace legacy
+{
+    using namespace std;
+
+    string remove_spaces(const string &tk)
+    {
+        string temp = tk;
+        string::size_type pos = 0;
+        if (tk == "")
+            return temp;
+        temp.erase(0, temp.find_first_not_of(' '));
+        pos = temp.find_last_not_of(' ');
+        temp.erase(pos+1, temp.size() - pos - 1);
+        return temp;
+    }
+
+    vector<string> split_instr(const string &code)
+    {
+        vector<string> temp;
+        string::size_type pos = 0;
+        string::size_type old_pos = 0;
+        while (pos != string::npos)
+        {
+            pos = code.find(';', old_pos);
+            if (pos != string::npos)
+            {
+                temp.push_back(remove_spaces(code.substr(old_pos,pos-old_pos)));
+                old_pos = ++pos;
+            }
+        }
+        return temp;
+    }
+
+    string get_token(const string &instr, const string &open_par)
+    {
+        string::size_type pos = instr.find(open_par);
+        string::size_type pos1 = instr.find_first_not_of(" \n");
+        return instr.substr(pos1, pos - pos1);
+    }
+
+    string get_param(const string &instr, const string &open_par, const string &close_par)
+    {
+        string temp("");
+        string::size_type pos = instr.find(open_par);
+        if (pos != string::npos)
+        {
+            string::size_type end = instr.find_last_of(close_par);
+            temp = instr.substr(pos+1, end-pos-1);
+        }
+        return temp;
+    }
+
+    vector<string> split_param(const string &p, const string &sep, char open_par, char close_par)
+    {
+        vector<string> temp;
+        string::size_type pos = 0;
+        string::size_type old_pos = 0;
+        string symbols = sep + open_par;
+        while (pos <= p.size())
+        {
+            pos = p.find_first_of(symbols, pos);
+            if (pos != string::npos)
+                if (p[pos] == open_par)
+                {
+                    pos = p.find(close_par, pos);
+                    if (pos == p.size())
+                        pos = string::npos;
+                    else
+                        ++pos;
+                }
+            if (pos != string::npos)
+            {
+                string t = remove_spaces(p.substr(old_pos, pos - old_pos));
+                temp.push_back(t);
+                old_pos = ++pos;
+            }
+        }
+        if (pos != old_pos)
+        {
+            string t = remove_spaces(p.substr(old_pos, p.size() - old_pos));
+            if (t != "")
+                temp.push_back(t);
+        }
+        return temp;
+    }
+}
+
+int main()
+{
+    // 10k tasks of 10 instructions each
+    const int TASKS = 10000, SEGS = 10;
+    std::vector<std::string> bodies(TASKS), descrs(TASKS);
+    for (int t = 0; t < TASKS; ++t)
+    {
+        char b[128];
+        std::snprintf(b, sizeof(b), "task%d; %d ; %d ; %d; %d ;", t, 10 + t % 90, 10 + t % 90, t % 7, t % 4);
+        descrs[t] = b;
+        for (int s = 0; s < SEGS; ++s)
+        {
+            if (s % 3 == 0)
+                std::snprintf(b, sizeof(b), " fixed(%d) ;", 1 + (t + s) % 9);
+            else if (s % 3 == 1)
+                std::snprintf(b, sizeof(b), "delay(unif(%d, %d));", s, s + 5);
+            else
+                std::snprintf(b, sizeof(b), "delay(dist([1:0.5], [2:1]));");
+            bodies[t] += b;
+        }
+    }
+
+    // The std::string functions of the previous versions
+    size_t n_legacy = 0, chars_legacy = 0;
+    double t0 = now();
+    for (int t = 0; t < TASKS; ++t)
+    {
+        std::vector<std::string> d = legacy::split_instr(descrs[t]);
+        n_legacy += d.size();
+        std::vector<std::string> instrs = legacy::split_instr(bodies[t]);
+        for (size_t i = 0; i < instrs.size(); ++i)
+        {
+            std::string tok = legacy::get_token(instrs[i], "(");
+            std::vector<std::string> par = legacy::split_param(legacy::get_param(instrs[i], "(", ")"), ",", '(', ')');
+            n_legacy += 1 + par.size();
+            chars_legacy += tok.size();
+            for (size_t p = 0; p < par.size(); ++p)
+                chars_legacy += par[p].size();
+        }
+    }
+    double t1 = now();
+
+    // The str_slice functions, reusing the vectors
+    size_t n_slice = 0, chars_slice = 0;
+    std::vector<str_slice> d, instrs, par;
+    for (int t = 0; t < TASKS; ++t)
+    {
+        split_instr(str_slice(descrs[t]), d);
+        n_slice += d.size();
+        split_instr(str_slice(bodies[t]), instrs);
+        for (size_t i = 0; i < instrs.size(); ++i)
+        {
+            str_slice tok = get_token(instrs[i]);
+            split_param(get_param(instrs[i]), par);
+            n_slice += 1 + par.size();
+            chars_slice += tok.size();
+            for (size_t p = 0; p < par.size(); ++p)
+                chars_slice += par[p].size();
+        }
+    }
+    double t2 = now();
+
+    // Same tokens with the std::string wrappers of the current version
+    bool same = true;
+    for (int t = 0; t < TASKS && same; t += 97)
+    {
+        std::vector<std::string> a = legacy::split_instr(bodies[t]);
+        same = (a == tres_parse_utils::split_instr(bodies[t]));
+        for (size_t i = 0; i < a.size() && same; ++i)
+            same = legacy::split_param(legacy::get_param(a[i], "(", ")"), ",", '(', ')') ==
+                   tres_parse_utils::split_param(tres_parse_utils::get_param(a[i]));
+    }
+
+    std::printf("%d descriptors, %d instructions\n", TASKS, TASKS * SEGS);
+    std::printf("std::string: %8.2f ms (%zu tokens)\n", (t1 - t0) * 1e3, n_legacy);
+    std::printf("str_slice:   %8.2f ms (%zu tokens), %.1fx\n", (t2 - t1) * 1e3, n_slice, (t1 - t0) / (t2 - t1));
+    check(n_legacy == n_slice && chars_legacy == chars_slice, "same tokens (slices)");
+    check(same, "same tokens (std::string wrappers)");
+    return status();
+}
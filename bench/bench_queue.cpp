@@ -0,0 +1,125 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_queue.cpp
+ *
+ * Event-queue backends of the native engine on a hold model
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include "EventHeap.hpp"
+#include "CalendarQueue.hpp"
+#include "Bench.hpp"
+
+using namespace tres;
+using namespace tres_bench;
+
+/** Fill a queue with n events, then time a number of holds (pop, then push
+ * the event again a random amount later), as a periodic task-set does */
+static double hold(EventQueueNative &q, std::size_t n, std::size_t holds)
+{
+    std::mt19937_64 rng(1);
+    uint64_t seq = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        NativeEvent e = { static_cast<long long>(rng() % 100000), NEVT_ARRIVAL, static_cast<uint32_t>(i), 0, seq++ };
+        q.push(e);
+    }
+    double t0 = now();
+    for (std::size_t i = 0; i < holds; ++i)
+    {
+        NativeEvent e = q.top();
+        q.pop();
+        e.time += 50000 + static_cast<long long>(rng() % 100000);
+        e.seq = seq++;
+        q.push(e);
+    }
+    double t1 = now();
+    q.clear();
+    return (t1 - t0) / holds * 1e9;
+}
+
+int main()
+{
+    // Both backends pop the same events in the same order (simultaneous
+    // events and mixed kinds included)
+    for (int trial = 0; trial < 20; ++trial)
+    {
+        EventHeap h;
+        CalendarQueue c;
+        std::mt19937 rng(trial);
+        uint64_t seq = 0;
+        long long t = 0;
+        bool same = true;
+        for (int i = 0; i < 20000 && same; ++i)
+        {
+            if (rng() % 3 != 0 || h.empty())
+            {
+                long long d = (rng() % 4 == 0) ? 0 : rng() % (trial * 50 + 2);
+                NativeEvent e = { t + d, static_cast<uint32_t>(rng() % NEVT_NONE), 0, 0, seq++ };
+                h.push(e);
+                c.push(e);
+            }
+            else
+            {
+                same = h.top().seq == c.top().seq;
+                t = h.top().time;
+                h.pop();
+                c.pop();
+            }
+        }
+        while (same && !h.empty())
+        {
+            same = h.top().seq == c.top().seq;
+            h.pop();
+            c.pop();
+        }
+        check(same && c.empty(), "calendar queue order");
+    }
+
+    for (std::size_t n = 1000; n <= 1000000; n *= 10)
+    {
+        EventHeap h;
+        CalendarQueue c;
+        double th = hold(h, n, 2000000);
+        double tc = hold(c, n, 2000000);
+        std::printf("%8u pending events: heap %6.1f ns/hold  calendar %6.1f ns/hold\n",
+                    static_cast<unsigned>(n), th, tc);
+    }
+
+    return status();
+}
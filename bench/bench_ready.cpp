@@ -0,0 +1,161 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_ready.cpp
+ *
+ * Bitmap ready queue of the native engine against an ordered set
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <vector>
+#include "BitmapReadyQueue.hpp"
+#include "Bench.hpp"
+
+using namespace tres;
+using namespace tres_bench;
+
+/** The ordered-set queue that the native engine uses for dynamic
+ * priorities, with the interface of BitmapReadyQueue */
+class SetReadyQueue
+{
+
+public:
+
+    SetReadyQueue(std::size_t tasks) : _pos(tasks), _front(0), _back(0) {}
+
+    bool empty() const { return _set.empty(); }
+
+    uint32_t first() const { return _set.begin()->task; }
+
+    void pushBack(uint32_t task, std::size_t level)
+    {
+        _Entry e = { static_cast<long long>(level), _back++, task };
+        _pos[task] = _set.insert(e).first;
+    }
+
+    void pushFront(uint32_t task, std::size_t level)
+    {
+        _Entry e = { static_cast<long long>(level), --_front, task };
+        _pos[task] = _set.insert(e).first;
+    }
+
+    void remove(uint32_t task) { _set.erase(_pos[task]); }
+
+private:
+
+    struct _Entry
+    {
+        long long key;
+        long long seq;
+        uint32_t task;
+
+        bool operator<(const _Entry &o) const
+        {
+            if (key != o.key) return key < o.key;
+            return seq < o.seq;
+        }
+    };
+
+    std::set<_Entry> _set;
+    std::vector<std::set<_Entry>::iterator> _pos;
+    long long _front;
+    long long _back;
+};
+
+/** Run a random mix of dispatches, activations and preemptions on n tasks
+ * (four per priority level) and return a checksum of the dispatched tasks */
+template <typename Queue>
+static uint64_t run(Queue &q, std::size_t n, std::size_t steps, double &ns)
+{
+    const std::size_t levels = (n + 3) / 4;
+    std::mt19937 rng(1);
+    std::vector<uint32_t> idle;
+    for (uint32_t t = 0; t < n; ++t)
+    {
+        if (t % 2)
+            q.pushBack(t, t % levels);
+        else
+            idle.push_back(t);
+    }
+    uint64_t sum = 0;
+    double t0 = now();
+    for (std::size_t i = 0; i < steps; ++i)
+    {
+        unsigned op = rng() % 3;
+        if ((op == 0 && !q.empty()) || idle.empty())
+        {
+            // Dispatch the highest-priority job
+            uint32_t t = q.first();
+            q.remove(t);
+            idle.push_back(t);
+            sum = sum * 31 + t;
+        }
+        else
+        {
+            // Activate a job, or put a preempted one back at the head
+            std::size_t k = rng() % idle.size();
+            uint32_t t = idle[k];
+            idle[k] = idle.back();
+            idle.pop_back();
+            if (op == 1)
+                q.pushBack(t, t % levels);
+            else
+                q.pushFront(t, t % levels);
+        }
+    }
+    ns = (now() - t0) / steps * 1e9;
+    return sum;
+}
+
+int main()
+{
+    const std::size_t steps = 4000000;
+    for (std::size_t n = 16; n <= 65536; n *= 4)
+    {
+        BitmapReadyQueue b((n + 3) / 4, n);
+        SetReadyQueue s(n);
+        double tb, ts;
+        uint64_t cb = run(b, n, steps, tb);
+        uint64_t cs = run(s, n, steps, ts);
+        check(cb == cs, "bitmap queue dispatch order");
+        std::printf("%6u tasks: ordered set %6.1f ns/op  bitmap %6.1f ns/op\n",
+                    static_cast<unsigned>(n), ts, tb);
+    }
+
+    return status();
+}
@@ -0,0 +1,174 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_replay.cpp
+ *
+ * Hyperperiod replay of the native kernel
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <tres_native/KernelNative.hpp>
+#include "Bench.hpp"
+
+using namespace tres;
+using namespace tres_bench;
+
+/** Result of a run */
+struct Run
+{
+    /** Hash of the events and of the triggered ports */
+    uint64_t trace;
+
+    /** Kernel time per event (ns) */
+    double ns;
+
+    /** Counters before and after the events at the horizon */
+    KernelNative::Stats before;
+    KernelNative::Stats after;
+};
+
+static void mix(uint64_t &h, uint64_t v)
+{
+    h = (h ^ v) * 0x100000001b3ull;
+}
+
+/** Simulate n tasks with harmonic periods on m cores up to the given time
+ * (a multiple of the hyperperiod), as the co-simulation does (each job
+ * runs one instruction); the execution time of the first task changes at
+ * change_at */
+static Run run(bool replay, const char *policy, int m, int n, long long horizon, long long change_at)
+{
+    std::mt19937 rng(3);
+    KernelConfig kc;
+    kc.name = "bench";
+    kc.num_cores = m;
+    kc.scheduler.policy = policy;
+    if (replay)
+        kc.scheduler.params.push_back("replay");
+    const long long periods[] = { 1000, 2000, 4000, 5000, 10000, 20000 };
+    for (int i = 0; i < n; ++i)
+    {
+        TaskConfig t;
+        t.type = "PeriodicTask";
+        t.name = "T" + std::to_string(i);
+        t.iat = periods[rng() % 6];
+        t.rdl = t.iat;
+        t.ph = 0;
+        kc.tasks.push_back(t);
+    }
+    std::vector<double> c(n);
+    std::vector<const double*> pc(n);
+    for (int i = 0; i < n; ++i)
+    {
+        c[i] = kc.tasks[i].iat * 0.75 * m / n * (0.5 + (rng() % 100) / 100.0);
+        pc[i] = &c[i];
+    }
+
+    Run r;
+    r.trace = 0xcbf29ce484222325ull;
+    KernelNative *k = static_cast<KernelNative*>(KernelNative::createInstance(kc));
+    k->initializeSimulation(1, pc.data());
+    double t0 = now();
+    while (k->getTimeOfNextEvent() <= horizon)
+    {
+        long long t = k->getTimeOfNextEvent();
+        if (t == horizon)
+            r.before = k->getStats();
+        if (t >= change_at)
+        {
+            c[0] *= 1.25;
+            change_at = horizon;
+        }
+        while (k->getTimeOfNextEvent() == t)
+        {
+            RTOSEvent *e = k->getNextEvent();
+            SimTask *task = e->getGeneratorTask();
+            // Task names are "T<index>"
+            int i = task ? std::atoi(task->getUID().c_str() + 1) : -1;
+            mix(r.trace, t);
+            mix(r.trace, static_cast<uint64_t>(e->getType()));
+            mix(r.trace, static_cast<uint64_t>(i));
+            if (e->getType() == RTOSEventType::END_TASK)
+            {
+                task->discardInstructions();
+                task->addInstruction(c[i]);
+            }
+            k->processNextEvent();
+        }
+        k->getRunningTasks();
+        std::vector<int> ports = k->getPortsToTrigger();
+        for (std::size_t p = 0; p < ports.size(); ++p)
+            mix(r.trace, ports[p]);
+    }
+    r.after = k->getStats();
+    r.ns = (now() - t0) / r.after.events * 1e9;
+    delete k;
+    return r;
+}
+
+int main()
+{
+    const long long horizon = 20000000;
+    const char *policies[] = { "EDF", "FIXED_PRIORITY" };
+    for (int p = 0; p < 2; ++p)
+    {
+        for (int m = 1; m <= 4; m *= 4)
+        {
+            const int n = 50 * m;
+            Run off = run(false, policies[p], m, n, horizon, horizon / 2);
+            Run on = run(true, policies[p], m, n, horizon, horizon / 2);
+            check(on.trace == off.trace, "same trace with and without replay");
+
+            // The counters of a replayed hyperperiod are updated when the
+            // next one starts, hence not for the events at the horizon
+            const KernelNative::Stats &a = on.after, &b = off.before;
+            check(a.events == b.events && a.jobs == b.jobs && a.preemptions == b.preemptions
+                  && a.migrations == b.migrations && a.deadline_misses == b.deadline_misses,
+                  "same counters with and without replay");
+            check(a.replayed_periods > 0, "some hyperperiods are replayed");
+            std::printf("%-14s %d cores %3d tasks: %9llu events, off %5.0f ns/event, on %5.0f ns/event "
+                        "(%llu hyperperiods replayed)\n",
+                        policies[p], m, n, static_cast<unsigned long long>(off.after.events), off.ns, on.ns,
+                        static_cast<unsigned long long>(a.replayed_periods));
+        }
+    }
+
+    return status();
+}
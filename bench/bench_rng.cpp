@@ -0,0 +1,112 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file bench_rng.cpp
+ *
+ * Throughput of the random generators, and check of the legacy sequence
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <tres/Factory.hpp>
+#include "RandomGen.hpp"
+#include "RandomVar.hpp"
+#include "Bench.hpp"
+
+using namespace tres;
+using namespace tres_bench;
+
+int main()
+{
+    // Park and Miller: the 10000th number from seed 1 is 1043618065
+    MinStdGen legacy(1);
+    RandNum x = 0;
+    for (int i = 0; i < 10000; ++i)
+        x = legacy.sample();
+    std::printf("minstd: 10000th sample from seed 1 is %lld\n", static_cast<long long>(x));
+    check(x == 1043618065, "legacy minstd sequence");
+
+    const size_t N = 1 << 24;
+    std::vector<double> out(1 << 12);
+    const char *names[] = { "minstd", "xoshiro256**", "pcg64" };
+    for (int k = 0; k < 3; ++k)
+    {
+        std::vector<std::string> par(1, "12345");
+        std::unique_ptr<RandomGen> g = Factory<RandomGen>::instance().create(names[k], par);
+        check(g.get() != NULL, names[k]);
+        if (!g)
+            continue;
+
+        // Raw samples (virtual calls, as the random variables do)
+        RandomGen *pg = g.get();
+        uint64_t sum = 0;
+        double t0 = now();
+        for (size_t i = 0; i < N; ++i)
+            sum += static_cast<uint64_t>(pg->sample());
+        double t1 = now();
+
+        // Uniform variates in batches
+        UniformVar u(0, 1, pg);
+        for (size_t i = 0; i < N; i += out.size())
+            u.fill(out.data(), out.size());
+        double t2 = now();
+
+        std::printf("%-13s sample %7.1f M/s  UniformVar::fill %7.1f M/s  (%u)\n",
+                    names[k], N / (t1 - t0) / 1e6, N / (t2 - t1) / 1e6,
+                    static_cast<unsigned>(sum % 10));
+    }
+
+    // Variables built before a new selection keep drawing from their
+    // generator
+    RandomVar::selectGenerator("xoshiro256**", 1);
+    UniformVar before(0, 1);
+    RandomVar::selectGenerator("pcg64", 1);
+    double v = before.get();
+    check(v > 0 && v < 1, "variable bound to a replaced generator");
+
+    // ... and get a stream of their own in each branch
+    RandomVar::reseed(42, 0);
+    double b0 = before.get();
+    RandomVar::reseed(42, 1);
+    double b1 = before.get();
+    RandomVar::reseed(42, 0);
+    check(before.get() == b0 && b0 != b1, "reseed of a replaced generator");
+    RandomVar::restoreGenerator();
+
+    return status();
+}
@@ -0,0 +1,3 @@
+set(tres_analysis_INCLUDE_DIRS      ${CMAKE_CURRENT_SOURCE_DIR}/analysis/include)
+set(tres_analysis_LIBRARIES         tres_analysis)
+set(tres_analysis_LINK_DIRECTORIES  ${CMAKE_CURRENT_BINARY_DIR}/analysis/src)
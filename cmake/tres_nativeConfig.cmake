@@ -0,0 +1,3 @@
+set(tres_native_INCLUDE_DIRS      ${CMAKE_CURRENT_SOURCE_DIR}/adapters/native/include)
+set(tres_native_LIBRARIES         tres_native)
+set(tres_native_LINK_DIRECTORIES  ${CMAKE_CURRENT_BINARY_DIR}/adapters/native/src)
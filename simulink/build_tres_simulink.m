@@ -1,3 +1,11 @@
+% Set TRES_VARIABLE_HIT = true in the workspace before running this script
+% to schedule the kernel blocks at the quiescent horizon of their kernel
+% (variable sample time) rather than by zero-crossing detection. Models
+% with aperiodic tasks are not supported in this mode.
+if ~exist('TRES_VARIABLE_HIT','var'),
+    TRES_VARIABLE_HIT = false;
+end
+
 % DO NOT MODIFY BELOW!
 % ====================
 TRES_BASE_INC    = [pwd,'/../base/include/'];
@@ -5,15 +13,21 @@ TRES_RTSIM_INC   = [pwd,'/../adapters/rtsim/include/'];
 RTSIM_INC        = [pwd,'/../3rdparty/rtsim/metasim/src/ -I', ...
                     pwd,'/../3rdparty/rtsim/rtlib/src/'];
 TRES_OMNETPP_INC = [pwd,'/../adapters/omnetpp/include/'];
+TRES_NATIVE_INC  = [pwd,'/../adapters/native/include/'];
 TRES_BASE_LIB    = [pwd,'/../build/base/src/'];
 TRES_RTSIM_LIB   = [pwd,'/../build/adapters/rtsim/src/'];
 TRES_OMNETPP_LIB = [pwd,'/../build/adapters/omnetpp/src/'];
+TRES_NATIVE_LIB  = [pwd,'/../build/adapters/native/src/'];
 MEX_CFLAGS       = 'CXXFLAGS=''$CXXFLAGS -Wall -O0 --std=c++0x''';
-MEX_INC          = sprintf('-I%s -I%s -I%s -I%s', RTSIM_INC, TRES_BASE_INC, TRES_RTSIM_INC, TRES_OMNETPP_INC);
-MEX_LIB          = sprintf('-L%s -L%s -L%s -ltres_base -ltres_rtsim -ltres_omnetpp_gw', ...
-                            TRES_BASE_LIB, TRES_RTSIM_LIB, TRES_OMNETPP_LIB);
+MEX_INC          = sprintf('-I%s -I%s -I%s -I%s -I%s', RTSIM_INC, TRES_BASE_INC, TRES_RTSIM_INC, TRES_OMNETPP_INC, TRES_NATIVE_INC);
+MEX_LIB          = sprintf('-L%s -L%s -L%s -L%s -ltres_base -ltres_rtsim -ltres_native -ltres_omnetpp_gw', ...
+                            TRES_BASE_LIB, TRES_RTSIM_LIB, TRES_OMNETPP_LIB, TRES_NATIVE_LIB);
+MEX_DEFS         = '';
+if TRES_VARIABLE_HIT,
+    MEX_DEFS     = '-DTRES_VARIABLE_HIT';
+end
 MEX_OUT      = '-outdir libs';
-MEX_IN_CLL   = {MEX_OUT, MEX_CFLAGS, ' -g ', MEX_INC, MEX_LIB};
+MEX_IN_CLL   = {MEX_OUT, MEX_CFLAGS, ' -g ', MEX_DEFS, MEX_INC, MEX_LIB};
 MEX_IN_CMD   = [sprintf('%s ',MEX_IN_CLL{1:end-1}), MEX_IN_CLL{end}];
 MDL_SRC      = {'src/common/tres_enabler_df.cpp', ...
                 'src/node/tres_task.cpp', ...
@@ -28,4 +42,4 @@ end
 disp ('Building T-Res mex files...');
 cellfun(@(sfun) eval(sprintf('mex %s %s', MEX_IN_CMD, sfun)), MDL_SRC, 'UniformOutput', true);
 disp ('Building T-Res mex files... DONE!');
-clear LD_PATH RTSIM_INC TRES_BASE_INC TRES_RTSIM_INC TRES_OMNETPP_INC TRES_BASE_LIB TRES_RTSIM_LIB TRES_OMNETPP_LIB MEX_CFLAGS MEX_INC MEX_LIB MDL_SRC MEX_IN_CLL MEX_IN_CMD MEX_OUT
+clear LD_PATH RTSIM_INC TRES_BASE_INC TRES_RTSIM_INC TRES_OMNETPP_INC TRES_NATIVE_INC TRES_BASE_LIB TRES_RTSIM_LIB TRES_OMNETPP_LIB TRES_NATIVE_LIB MEX_CFLAGS MEX_DEFS MEX_INC MEX_LIB MDL_SRC MEX_IN_CLL MEX_IN_CMD MEX_OUT
@@ -38,6 +38,7 @@
 
 #include <tres/Factory.hpp>
 #include <tres_omnetpp/NetworkOppGateway.hpp>
+#include <tres_native/NetworkCanNative.hpp>
 
 namespace tres
 {
@@ -45,4 +46,9 @@ namespace tres
                              NetworkOppGateway,
                              Network::BASE_KEY_TYPE>
     registerNetOpp("OMNeT++");
+
+    static registerInFactory<Network,
+                             NetworkCanNative,
+                             Network::BASE_KEY_TYPE>
+    registerNetCanNative("NATIVE_CAN");
 }
@@ -446,7 +446,7 @@ static void mdlZeroCrossings(SimStruct *S)
     // Get the time resolution back from the real vector workspace
     double time_resolution = ssGetRWork(S)[0];
 
-    ssGetNonsampledZCs(S)[0] = ns->getTimeOfNextEvent()/(time_resolution) - ssGetT(S);
+    ssGetNonsampledZCs(S)[0] = ns->getQuiescentHorizon()/(time_resolution) - ssGetT(S);
 }
 
 // Function: mdlTerminate =================================================
@@ -459,8 +459,8 @@ static void mdlTerminate(SimStruct *S)
     // Get the C++ object back from the pointers vector
     tres::Network *ns = static_cast<tres::Network *>(ssGetPWork(S)[0]);
 
-    // Call its destructor
-    delete ns;
+    // Release it (the adapter may keep it for the next simulation)
+    ns->dispose();
 }
 
 #ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
@@ -38,6 +38,7 @@
 
 #include <tres/Factory.hpp>
 #include <tres_rtsim/KernelRtSim.hpp>
+#include <tres_native/KernelNative.hpp>
 
 namespace tres
 {
@@ -45,4 +46,21 @@ namespace tres
                              KernelRtSim,
                              Kernel::BASE_KEY_TYPE>
     registerKernRtSim("RTSIM");
+
+    static registerInFactory<Kernel,
+                             KernelRtSim,
+                             Kernel::BASE_KEY_TYPE,
+                             const KernelConfig>
+    registerKernRtSimConf("RTSIM");
+
+    static registerInFactory<Kernel,
+                             KernelNative,
+                             Kernel::BASE_KEY_TYPE>
+    registerKernNative("NATIVE");
+
+    static registerInFactory<Kernel,
+                             KernelNative,
+                             Kernel::BASE_KEY_TYPE,
+                             const KernelConfig>
+    registerKernNativeConf("NATIVE");
 }
@@ -39,11 +39,16 @@
 #define S_FUNCTION_NAME tres_kernel
 #define S_FUNCTION_LEVEL 2
 
+#include <iomanip>
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include <memory>
 #include <cstdlib>           // atof
+#include <cstring>           // memcpy
+#include <tres/BinaryIO.hpp>
 #include <tres/Factory.hpp>
+#include <tres/KernelConfig.hpp>
 #include <tres/SimTask.hpp>
 #include <tres/Kernel.hpp>
 #include <tres/RTOSEvent.hpp>
@@ -61,6 +66,12 @@
 #define NUMBER_OF_CORES     5
 #define SIMULATION_ENGINE   6
 
+// Define TRES_VARIABLE_HIT (see the option in build_tres_simulink.m) to schedule
+// the block at the quiescent horizon of the kernel (variable sample time)
+// rather than by zero-crossing detection.
+// The block then runs only when the kernel can change its outputs, so it
+// does not support aperiodic tasks (whose requests would be sampled late).
+
 #include "tres_kernel_utils.cpp"
 
 /**
@@ -105,6 +116,21 @@ namespace _tres_kernel
         receivedAperiodicReq = (aper_activ_idx.size() > 0);
         prev_reqs.assign(*aper_reqs, *aper_reqs+num_aper_reqs);
     }
+
+    /**
+     * \brief Check if the simulation engine of the block supports snapshots
+     *
+     * Only the native engine does (the RTSim one keeps its events in the
+     * global MetaSim queue)
+     */
+    static bool engineSupportsSnapshots(SimStruct *S)
+    {
+        const mxArray *mx_engine = ssGetSFcnParam(S,SIMULATION_ENGINE);
+        std::vector<char> engine(mxGetN(mx_engine)+1);
+        if (mxGetString(mx_engine, engine.data(), engine.size()) != 0)
+            return false;
+        return (std::string(engine.data()) == "NATIVE");
+    }
 }
 
 /**
@@ -156,9 +182,19 @@ static void mdlInitializeSizes(SimStruct *S)
 
     ssSetNumPWork(S, 2);  // store the tres::Kernel and the _tres_kernel::_AperiodicReqsManager
     ssSetNumRWork(S, 1);  // store the time_resolution
+#ifdef TRES_VARIABLE_HIT
+    ssSetNumNonsampledZCs(S, 0);
+#else
     ssSetNumNonsampledZCs(S, 1);    // next hit
+#endif
 
-    ssSetSimStateCompliance(S, USE_DEFAULT_SIM_STATE);
+    // Save and restore the block state through a binary snapshot (see
+    // mdlGetSimState()) when the engine supports it; otherwise, keep the
+    // default SimState, as before
+    if (_tres_kernel::engineSupportsSnapshots(S))
+        ssSetSimStateCompliance(S, USE_CUSTOM_SIM_STATE);
+    else
+        ssSetSimStateCompliance(S, USE_DEFAULT_SIM_STATE);
 }
 
 #if defined(MATLAB_MEX_FILE)
@@ -182,8 +218,13 @@ void mdlSetOutputPortWidth(SimStruct *S, int_T port, int_T width)
 static void mdlInitializeSampleTimes(SimStruct *S)
 {
     // Sample time
+#ifdef TRES_VARIABLE_HIT
+    ssSetSampleTime(S, 0, VARIABLE_SAMPLE_TIME);
+    ssSetOffsetTime(S, 0, 0.0);
+#else
     ssSetSampleTime(S, 0, CONTINUOUS_SAMPLE_TIME);
     ssSetOffsetTime(S, 0, FIXED_IN_MINOR_STEP_OFFSET);
+#endif
 
     // Get the number of tasks (it is equal to the size of output port)
     int_T num_tasks = ssGetOutputPortWidth(S,0);
@@ -207,11 +248,22 @@ static void mdlStart(SimStruct *S)
     char *bufSimEng;  // SIMULATION_ENGINE
     int bufSimEngLen;
 
-    // Build the list of parameters that configure the tres::Kernel
-    std::vector<std::string> kern_params = readMaskAndBuildConfVector(S);
+    // Build the configuration of the tres::Kernel
+    tres::KernelConfig conf = readMaskAndBuildConfig(S);
 
     // Set a name (UID) for the current tres::Kernel instance
-    kern_params.push_back(std::string(ssGetPath(S)));
+    conf.name = std::string(ssGetPath(S));
+
+#ifdef TRES_VARIABLE_HIT
+    for (std::vector<tres::TaskConfig>::const_iterator t = conf.tasks.begin(); t != conf.tasks.end(); ++t)
+    {
+        if (t->isAperiodic())
+        {
+            ssSetErrorStatus(S, "Aperiodic tasks are not supported with variable-hit scheduling (TRES_VARIABLE_HIT)");
+            return;
+        }
+    }
+#endif
 
     // Get the type of the adapter, i.e., the concrete implementation of tres::Kernel
     bufSimEngLen = mxGetN( ssGetSFcnParam(S,SIMULATION_ENGINE) )+1;
@@ -221,8 +273,20 @@ static void mdlStart(SimStruct *S)
     delete bufSimEng;
 
     // Instantiate the concrete representation of tres::Kernel
-    std::unique_ptr<tres::Kernel> kern = Factory<tres::Kernel>::instance()
-                                            .create(engine, kern_params);
+    std::unique_ptr<tres::Kernel> kern;
+    try
+    {
+        const tres::KernelConfig &cconf = conf;
+        kern = Factory<tres::Kernel, tres::Kernel::BASE_KEY_TYPE, const tres::KernelConfig>::instance()
+                    .create(engine, cconf);
+    }
+    catch (std::exception &e)
+    {
+        static std::string err;
+        err = e.what();
+        ssSetErrorStatus(S, err.c_str());
+        return;
+    }
 
     // Save the C++ object to the pointers vector
     tres::Kernel *_kern = kern.release();
@@ -232,13 +296,8 @@ static void mdlStart(SimStruct *S)
 	ssGetPWork(S)[1] = new _tres_kernel::_AperiodicReqsManager(ssGetInputPortWidth(S,1),
                                                                 (InputBooleanPtrsType) ssGetInputPortSignalPtrs(S,1));
 
-    // Get the time resolution (actually, its floating point representation)
-    // It is guaranteed to be at end()-2 position in the vector kern_params
-    std::vector<std::string>::iterator it = kern_params.end()-2;
-    double time_resolution = atof((*it).c_str());
-
     // Save the time resolution to the real vector workspace
-    ssGetRWork(S)[0] = time_resolution;
+    ssGetRWork(S)[0] = conf.time_resolution;
 }
 
 /**
@@ -422,6 +481,28 @@ static void mdlUpdate(SimStruct *S, int_T tid)
     kern->clearPortsToTrigger();
 }
 
+#ifdef TRES_VARIABLE_HIT
+/**
+ * \brief Set the time of the next hit of the block
+ *
+ * The quiescent horizon of the kernel: no task can be triggered before it
+ */
+#define MDL_GET_TIME_OF_NEXT_VAR_HIT
+static void mdlGetTimeOfNextVarHit(SimStruct *S)
+{
+    // Get the C++ object back from the pointers vector
+    tres::Kernel *kern = static_cast<tres::Kernel *>(ssGetPWork(S)[0]);
+
+    // Get the time resolution back from the real vector workspace
+    double time_resolution = ssGetRWork(S)[0];
+
+    int horizon = kern->getQuiescentHorizon();
+    if (horizon == std::numeric_limits<int>::max())
+        ssSetTNext(S, rtInf);
+    else
+        ssSetTNext(S, horizon/(time_resolution));
+}
+#else
 /**
  * \brief Detect zero-crossing points
  *
@@ -441,7 +522,68 @@ static void mdlZeroCrossings(SimStruct *S)
 mexPrintf("\n%s at _time_: %.3f\n", __FUNCTION__, ssGetT(S));
 #endif
 
-    ssGetNonsampledZCs(S)[0] = kern->getNextWakeUpTime()/(time_resolution) - ssGetT(S);
+    ssGetNonsampledZCs(S)[0] = kern->getQuiescentHorizon()/(time_resolution) - ssGetT(S);
+}
+#endif
+
+/**
+ * \brief Save the state of the block into a binary snapshot
+ *
+ * The snapshot holds the state of the tres::Kernel and the last values of
+ * the aperiodic requests (see tres::Kernel::saveState()). Only called for
+ * engines supporting snapshots (see mdlInitializeSizes())
+ */
+#define MDL_SIM_STATE
+static mxArray* mdlGetSimState(SimStruct *S)
+{
+    // Get the C++ objects back from the pointers vector
+    tres::Kernel *kern = static_cast<tres::Kernel *>(ssGetPWork(S)[0]);
+    _tres_kernel::_AperiodicReqsManager *aper_reqs_mgr = static_cast<_tres_kernel::_AperiodicReqsManager *>(ssGetPWork(S)[1]);
+
+    tres::BinaryWriter w;
+    try
+    {
+        kern->saveState(w);
+        w.putVector(aper_reqs_mgr->prev_reqs);
+    }
+    catch (std::exception &e)
+    {
+        static std::string err;
+        err = e.what();
+        ssSetErrorStatus(S, err.c_str());
+        return NULL;
+    }
+
+    mxArray *ss = mxCreateNumericMatrix(1, w.data().size(), mxUINT8_CLASS, mxREAL);
+    memcpy(mxGetData(ss), w.data().data(), w.data().size());
+    return ss;
+}
+
+/**
+ * \brief Restore a snapshot saved by mdlGetSimState()
+ */
+static void mdlSetSimState(SimStruct *S, const mxArray *ss)
+{
+    // Get the C++ objects back from the pointers vector
+    tres::Kernel *kern = static_cast<tres::Kernel *>(ssGetPWork(S)[0]);
+    _tres_kernel::_AperiodicReqsManager *aper_reqs_mgr = static_cast<_tres_kernel::_AperiodicReqsManager *>(ssGetPWork(S)[1]);
+
+    try
+    {
+        tres::BinaryReader r(static_cast<const char *>(mxGetData(ss)), mxGetNumberOfElements(ss));
+        kern->loadState(r);
+        std::vector<boolean_T> prev_reqs;
+        r.getVector(prev_reqs);
+        if (prev_reqs.size() != aper_reqs_mgr->prev_reqs.size())
+            throw tres::BinaryIOExc("The snapshot belongs to a block with different aperiodic requests");
+        aper_reqs_mgr->prev_reqs = prev_reqs;
+    }
+    catch (std::exception &e)
+    {
+        static std::string err;
+        err = e.what();
+        ssSetErrorStatus(S, err.c_str());
+    }
 }
 
 /**
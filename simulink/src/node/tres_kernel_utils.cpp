@@ -37,74 +37,103 @@
  */
 
 /**
- * \brief Convert cell-array-based entity descriptions into vector-of-strings-based descriptions
+ * \brief Read the string stored in a (MATLAB) cell
+ */
+static std::string cellToString(const mxArray *cell)
+{
+    std::vector<char> buf(mxGetN(cell)+1);
+    mxGetString(cell, buf.data(), buf.size());
+    return std::string(buf.data());
+}
+
+/**
+ * \brief Read the numerical parameters in a row of a cell-array-based entity description
  *
  * A number of kernel entities (e.g., task sets, scheduling policies) are described
  * through MATLAB variables that are cell arrays. Such arrays have one or more rows
  * (depending on what they are used for).
  *
- * The first parameter in each row is guaranteed to be a std::string. The other parameters are
- * guaranteed to be numeric or empty (MATLAB) cells. Error checking is performed at MATLAB level
- * by using mask callbacks
+ * The first two parameters in each row are guaranteed to be std::strings (type and
+ * name of the entity). The other parameters are guaranteed to be numeric or empty
+ * (MATLAB) cells. Error checking is performed at MATLAB level by using mask callbacks.
  *
- * This function converts cell-array-based entity descriptions into entity descriptions that are
- * made of a vector of strings. Each string represents a row of the cell array. A string is made
- * of a list of parameters separated by the token ';'. Parameters coincide with the entries in
- * the corresponding row of the cell-array.
+ * This function returns the (non empty) numerical parameters of the i-th row.
  */
-static std::vector<std::string> cellArrayDescrToVectorOfStrings(const mxArray *mx_var)
+static std::vector<double> cellArrayRowParams(const mxArray *mx_var, int i)
 {
-    // The vector-of-strings-based description (output)
-    std::vector<std::string> out_descr;
-
-    // Get the number of entries (rows of an entity description)
-    // and the number of parameters
+    std::vector<double> params;
     int num_entries = mxGetM(mx_var);
     int num_params = mxGetN(mx_var);
-
-    // Convert the description of each task
-    for (int i = 0; i < num_entries; ++i)
+    for (int j = 2; j < num_params; ++j)
     {
-        // The stringstream
-        std::stringstream ss;
+        mxArray *entity_p = mxGetCell(mx_var, (i + num_entries * j));
 
-        // Put the entity type into the stringstream
-        mxArray *entity_type = mxGetCell(mx_var, i);
-        char *type_name = new char[mxGetN(entity_type)+1];
-        mxGetString(entity_type, type_name, mxGetN(entity_type)+1);
-        ss << type_name << ';';
-        delete type_name;
-
-        // Put the entity name into the stringstream
-        mxArray *entity_name = mxGetCell(mx_var, i+num_entries);
-        char *name_string = new char[mxGetN(entity_name)+1];
-        mxGetString(entity_name, name_string, mxGetN(entity_name)+1);
-        ss << name_string << ';';
-        delete name_string;
-
-        // Put the other parameters (numerical) into the stringstream
-        for (int j = 2; j < num_params; ++j)
+        // if the cell is _not_ empty
+        if (mxGetM(entity_p)*mxGetN(entity_p) != 0)
+            params.push_back(*mxGetPr(entity_p));
+    }
+    return params;
+}
+
+/**
+ * \brief Convert a cell-array-based task set description into typed task descriptions
+ *
+ * Each row of the cell array describes a task as type, name, iat, rdl, ph and
+ * (optionally) further parameters, such as the priority and the CPU core (used
+ * by the native engine for partitioned scheduling). The latter are kept as
+ * strings (printed with as many digits as needed to be read back exactly), and
+ * interpreted by the engine.
+ */
+static std::vector<tres::TaskConfig> cellArrayDescrToTaskConfigs(const mxArray *mx_var)
+{
+    std::vector<tres::TaskConfig> tasks(mxGetM(mx_var));
+    for (std::vector<tres::TaskConfig>::size_type i = 0; i < tasks.size(); ++i)
+    {
+        tres::TaskConfig &t = tasks[i];
+        t.type = cellToString(mxGetCell(mx_var, i));
+        t.name = cellToString(mxGetCell(mx_var, i+tasks.size()));
+
+        std::vector<double> p = cellArrayRowParams(mx_var, i);
+        if (p.size() > 0) t.iat = p[0];
+        if (p.size() > 1) t.rdl = p[1];
+        if (p.size() > 2) t.ph = p[2];
+        for (std::vector<double>::size_type j = 3; j < p.size(); ++j)
         {
-            mxArray *entity_p = mxGetCell(mx_var, (i + num_entries * j));
-
-            // if the cell is _not_ empty
-            if (mxGetM(entity_p)*mxGetN(entity_p) != 0)
-            {
-                double *param = mxGetPr(entity_p);
-                ss << *param << ';';
-            }
+            std::stringstream ss;
+            ss << std::setprecision(std::numeric_limits<double>::max_digits10) << p[j];
+            t.params.push_back(ss.str());
         }
-
-        // Insert the stringstream into the description vector
-        out_descr.push_back(ss.str());
     }
+    return tasks;
+}
+
+/**
+ * \brief Convert a cell-array-based (custom) scheduling policy description into a
+ * typed one
+ *
+ * Only the first row of the cell array is considered. The name and the numerical
+ * parameters become the parameters of the policy; numbers are printed with
+ * as many digits as needed to be read back exactly.
+ */
+static tres::SchedulerConfig cellArrayDescrToSchedulerConfig(const mxArray *mx_var)
+{
+    tres::SchedulerConfig sp;
+    int num_entries = mxGetM(mx_var);
+    sp.policy = cellToString(mxGetCell(mx_var, 0));
+    sp.params.push_back(cellToString(mxGetCell(mx_var, num_entries)));
 
-    // Return the vector-of-string-based description
-    return out_descr;
+    std::vector<double> p = cellArrayRowParams(mx_var, 0);
+    for (std::vector<double>::size_type j = 0; j < p.size(); ++j)
+    {
+        std::stringstream ss;
+        ss << std::setprecision(std::numeric_limits<double>::max_digits10) << p[j];
+        sp.params.push_back(ss.str());
+    }
+    return sp;
 }
 
 /**
- * \brief Build the list of parameters that configure the tres::Kernel
+ * \brief Build the configuration of the tres::Kernel
  *
  * The tres::Kernel class (or, more precisely, its underlying concrete
  * implementation) needs to be configured with a bunch of information, such
@@ -112,108 +141,48 @@ static std::vector<std::string> cellArrayDescrToVectorOfStrings(const mxArray *m
  * details like number of CPU cores, and time resolution, to name only a few. This
  * information is stored inside the tres_kernel block as mask parameters.
  *
- * This function reads the mask parameters and returns a vector-of-string-based
- * description of the information needed by the tres::Kernel class. Specifically,
- * the information returned by this function has the following form:
- *   - the number of tasks in the task-set (#tasks) - std::string (1)      <-- vector.begin()
- *   - the task-set description                     - std::string (#tasks)
- *   - the scheduling policy description            - std::string (1)
- *   - the number of CPU cores                      - std::string (1)
- *   - the time resolution                          - std::string (1)
- *                                                                         <-- vector.end()
+ * This function reads the mask parameters and returns them as a tres::KernelConfig
+ * (the name of the kernel instance is left empty).
  *
  * No err checking is performed when reading mask parameters since these are already
  * guaranteed to be valid at MATLAB level (err checking performed by mask callbacks).
  */
-static std::vector<std::string> readMaskAndBuildConfVector(SimStruct *S)
+static tres::KernelConfig readMaskAndBuildConfig(SimStruct *S)
 {
-    char *bufTsd,       // TS_DESCR_VARNAME
-         *bufSchedPol,  // SCHEDULING_POLICY
-         *bufSpd,       // SP_DESCR_VARNAME
-         *bufDeadMiss,  // DEADLINE_MISS_RULE
-         *bufTimeRes;   // TIME_RESOLUTION
-    int bufTsdLen, bufSchedPolLen, bufSpdLen, bufDeadMissLen, bufTimeResLen;
-    std::vector<std::string> kern_params; // The return list of parameters
-    std::stringstream ss;                 // A convenience stringstream
-
-    // Get the number of tasks (it is equal to the size of output port)
-    int_T num_tasks = ssGetOutputPortWidth(S,0);
-
-    // Get the name of the workspace variable for the task set
-    bufTsdLen = mxGetN( ssGetSFcnParam(S,TS_DESCR_VARNAME) )+1;
-    bufTsd = new char[bufTsdLen];
-    mxGetString(ssGetSFcnParam(S,TS_DESCR_VARNAME), bufTsd, bufTsdLen);
-
-    // Get the actual task set description
-    std::vector<std::string> ts_descr = cellArrayDescrToVectorOfStrings(mexGetVariablePtr("base", bufTsd));
-    delete bufTsd;
-
-    // **Insert** the number of tasks and
-    //            the task set description in the return list
-    ss << num_tasks;
-    kern_params.push_back(ss.str());
-    ss.str(std::string());                    // Flush the ss
-    kern_params.insert(kern_params.begin()+1,
-                           ts_descr.begin(),
-                               ts_descr.end());
+    tres::KernelConfig conf;
+
+    // Get the actual task set description (from the workspace variable)
+    std::string ts_varname = cellToString(ssGetSFcnParam(S,TS_DESCR_VARNAME));
+    conf.tasks = cellArrayDescrToTaskConfigs(mexGetVariablePtr("base", ts_varname.c_str()));
 
     // Get the scheduling policy
-    bufSchedPolLen = mxGetN( ssGetSFcnParam(S,SCHEDULING_POLICY) )+1;
-    bufSchedPol = new char[bufSchedPolLen];
-    mxGetString(ssGetSFcnParam(S,SCHEDULING_POLICY), bufSchedPol, bufSchedPolLen);
-    std::vector<std::string> sp_descr;
-	sp_descr.push_back(std::string(bufSchedPol) + ';');
-    delete bufSchedPol;
+    conf.scheduler.policy = cellToString(ssGetSFcnParam(S,SCHEDULING_POLICY));
 
     // Check if it's a custom sched. policy
-    if (sp_descr[0] == "OTHER;")
+    if (conf.scheduler.policy == "OTHER")
     {
-        // Get the name of the workspace variable for the custom sched. policy
-        bufSpdLen = mxGetN( ssGetSFcnParam(S,SP_DESCR_VARNAME) )+1;
-        bufSpd = new char[bufSpdLen];
-        mxGetString(ssGetSFcnParam(S,SP_DESCR_VARNAME), bufSpd, bufSpdLen);
-
         // Get the actual custom sched. policy description
-        // (It's a std::vector<std::string> with size() == 1)
-        sp_descr = cellArrayDescrToVectorOfStrings(mexGetVariablePtr("base", bufSpd));
-        delete bufSpd;
+        // (from the workspace variable)
+        std::string sp_varname = cellToString(ssGetSFcnParam(S,SP_DESCR_VARNAME));
+        conf.scheduler = cellArrayDescrToSchedulerConfig(mexGetVariablePtr("base", sp_varname.c_str()));
     }
 
-    // **Insert** the sched. policy description in the return list
-    kern_params.push_back(sp_descr[0]);
-
     // TODO. Get the scheduler action on deadline miss
-    // TODO. **Insert** the scheduler action on deadline miss in the return list
 
     // Get the number of CPU cores parameter
-    int num_cores = static_cast<int>(mxGetScalar(ssGetSFcnParam(S, NUMBER_OF_CORES)));
-
-    // **Insert** the number of cores in the return list
-    ss << num_cores;
-    kern_params.push_back(ss.str());
-    ss.str(std::string());                    // Flush the ss
+    conf.num_cores = static_cast<int>(mxGetScalar(ssGetSFcnParam(S, NUMBER_OF_CORES)));
 
     // Get the time resolution
-    bufTimeResLen = mxGetN( ssGetSFcnParam(S,TIME_RESOLUTION) )+1;
-    bufTimeRes = new char[bufTimeResLen];
-    mxGetString(ssGetSFcnParam(S,TIME_RESOLUTION), bufTimeRes, bufTimeResLen);
-
-    // Convert the time resolution to a double
-    std::string time_resolution(bufTimeRes);
-    delete bufTimeRes;
+    std::string time_resolution = cellToString(ssGetSFcnParam(S,TIME_RESOLUTION));
     if (time_resolution == "Seconds")
-        ss << 1.0;
+        conf.time_resolution = 1.0;
     else if (time_resolution == "Milli_Seconds")
-        ss << 1.0e3;
+        conf.time_resolution = 1.0e3;
     else if (time_resolution == "Micro_Seconds")
-        ss << 1.0e6;
+        conf.time_resolution = 1.0e6;
     else if (time_resolution == "Nano_Seconds")
-        ss << 1.0e9;
-
-    // **Insert** the time resolution in the return list
-    kern_params.push_back(ss.str());
-    ss.str(std::string());                    // Flush the ss
+        conf.time_resolution = 1.0e9;
 
     // Done, return to the caller
-    return (kern_params);
+    return conf;
 }
@@ -40,9 +40,11 @@
 #define S_FUNCTION_NAME tres_task_df
 #define S_FUNCTION_LEVEL 2
 
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
+#include <tres/BinaryIO.hpp>
 #include <tres/Task.hpp>
 #include "simstruc.h"
 
@@ -93,7 +95,7 @@ static void mdlInitializeSizes(SimStruct *S)
     ssSetNumPWork(S, 1); // tres::Task (set in mdlInitializeConditions())
     ssSetNumRWork(S, 1); // store the value to be issued on the data-flow
                          // port #0 (enable signal for segments)
-    ssSetSimStateCompliance(S, USE_DEFAULT_SIM_STATE);
+    ssSetSimStateCompliance(S, USE_CUSTOM_SIM_STATE);
 }
 
 /* Function: mdlInitializeSampleTimes =====================================
@@ -180,6 +182,59 @@ static void mdlOutputs(SimStruct *S, int_T tid)
 #endif
 }
 
+#define MDL_SIM_STATE
+/* Function: mdlGetSimState ===============================================
+ * Abstract:
+ *    Save the state of the task (and of the random generators owned by
+ *    RandomVar, shared by all the tasks) into a binary snapshot.
+ */
+static mxArray* mdlGetSimState(SimStruct *S)
+{
+    // Get the C++ object back from the pointers vector
+    tres::Task *task = static_cast<tres::Task *>(ssGetPWork(S)[0]);
+
+    tres::BinaryWriter w;
+    try
+    {
+        tres::RandomVar::saveGenerator(w);
+        task->saveState(w);
+    }
+    catch (std::exception &e)
+    {
+        static std::string err;
+        err = e.what();
+        ssSetErrorStatus(S, err.c_str());
+        return NULL;
+    }
+
+    mxArray *ss = mxCreateNumericMatrix(1, w.data().size(), mxUINT8_CLASS, mxREAL);
+    memcpy(mxGetData(ss), w.data().data(), w.data().size());
+    return ss;
+}
+
+/* Function: mdlSetSimState ===============================================
+ * Abstract:
+ *    Restore a snapshot saved by mdlGetSimState().
+ */
+static void mdlSetSimState(SimStruct *S, const mxArray *ss)
+{
+    // Get the C++ object back from the pointers vector
+    tres::Task *task = static_cast<tres::Task *>(ssGetPWork(S)[0]);
+
+    try
+    {
+        tres::BinaryReader r(static_cast<const char *>(mxGetData(ss)), mxGetNumberOfElements(ss));
+        tres::RandomVar::loadGenerator(r);
+        task->loadState(r);
+    }
+    catch (std::exception &e)
+    {
+        static std::string err;
+        err = e.what();
+        ssSetErrorStatus(S, err.c_str());
+    }
+}
+
 /* Function: mdlTerminate =================================================
  *    No termination needed, but we are required to have this routine.
  */
@@ -0,0 +1,83 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file Test.hpp
+ *
+ * Helpers shared by the test drivers
+ */
+
+#ifndef TRES_TEST_HDR
+#define TRES_TEST_HDR
+#include <cmath>
+#include <cstdio>
+
+namespace tres_test
+{
+    /** Number of failed checks */
+    inline int& failures()
+    {
+        static int n = 0;
+        return n;
+    }
+
+    /** Report a failed check */
+    inline void check(bool ok, const char *what)
+    {
+        if (!ok)
+        {
+            std::printf("CHECK FAILED: %s\n", what);
+            ++failures();
+        }
+    }
+
+    /** Check that two numbers agree up to a relative tolerance */
+    inline void checkClose(double a, double b, double tol, const char *what)
+    {
+        bool ok = std::fabs(a - b) <= tol * std::fmax(1.0, std::fmax(std::fabs(a), std::fabs(b)));
+        if (!ok)
+            std::printf("(%.17g != %.17g) ", a, b);
+        check(ok, what);
+    }
+
+    /** Exit status of a driver */
+    inline int status()
+    {
+        if (failures() > 0)
+            std::printf("%d checks failed\n", failures());
+        return failures() > 0 ? 1 : 0;
+    }
+}
+
+#endif // TRES_TEST_HDR
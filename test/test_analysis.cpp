@@ -0,0 +1,177 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_analysis.cpp
+ *
+ * Check the schedulability analyses against textbook examples
+ */
+
+#include <string>
+#include <vector>
+#include <tres_analysis/CanAnalysis.hpp>
+#include <tres_analysis/SchedAnalysis.hpp>
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+/** A periodic task (deadline: the period if 0; priority: optional) */
+static TaskConfig task(const std::string &name, double iat, double rdl = 0, const char *prio = NULL)
+{
+    TaskConfig t;
+    t.type = "PeriodicTask";
+    t.name = name;
+    t.iat = iat;
+    t.rdl = (rdl > 0) ? rdl : iat;
+    t.ph = 0;
+    if (prio)
+        t.params.push_back(prio);
+    return t;
+}
+
+static KernelConfig config(const std::vector<TaskConfig> &tasks, const std::string &policy, int cores = 1)
+{
+    KernelConfig kc;
+    kc.name = "test";
+    kc.tasks = tasks;
+    kc.scheduler.policy = policy;
+    kc.num_cores = cores;
+    if (cores > 1)
+        kc.scheduler.params.push_back("global");
+    return kc;
+}
+
+/** The timing of the tasks, from their WCET (and jitter) */
+static std::vector<TaskTiming> timing(const std::vector<double> &c,
+                                      const std::vector<double> &j = std::vector<double>())
+{
+    std::vector<TaskTiming> t;
+    for (std::vector<double>::size_type i = 0; i < c.size(); ++i)
+        t.push_back(TaskTiming(c[i], i < j.size() ? j[i] : 0));
+    return t;
+}
+
+static std::vector<long long> responseTimes(const SchedAnalysis &a, std::size_t n)
+{
+    std::vector<long long> r;
+    for (std::size_t i = 0; i < n; ++i)
+        r.push_back(a.getResponseTime(i));
+    return r;
+}
+
+int main()
+{
+    // Response-time analysis: (C, T) = (3, 7), (3, 12), (5, 20)
+    KernelConfig rta = config({ task("T0", 7, 0, "1"), task("T1", 12, 0, "2"), task("T2", 20, 0, "3") },
+                              "FIXED_PRIORITY");
+    SchedAnalysis fp(rta, timing({ 3, 3, 5 }));
+    check(fp.analyze() == SchedAnalysis::SCHEDULABLE, "RTA example");
+    check(responseTimes(fp, 3) == std::vector<long long>({ 3, 6, 20 }), "RTA response times");
+    fp.setTiming(2, TaskTiming(6));
+    check(fp.analyze() == SchedAnalysis::UNSCHEDULABLE, "RTA, longer WCET");
+    fp.setTiming(2, TaskTiming(5));
+    fp.setTiming(0, TaskTiming(3, 2));
+    check(fp.analyze() == SchedAnalysis::UNKNOWN, "RTA, miss due to the jitter");
+
+    // Processor demand (QPA), constrained deadlines: (C, D, T)
+    KernelConfig ok = config({ task("T0", 4, 2), task("T1", 6, 5), task("T2", 12, 10) }, "EDF");
+    check(SchedAnalysis::prescreen(ok, timing({ 1, 2, 3 })) == SchedAnalysis::SCHEDULABLE,
+          "QPA, schedulable");
+    check(SchedAnalysis::prescreen(ok, timing({ 1, 2, 3 }, { 0, 3, 0 })) == SchedAnalysis::UNKNOWN,
+          "QPA, miss due to the jitter");
+    KernelConfig miss = config({ task("T0", 6, 3), task("T1", 8, 3), task("T2", 12) }, "EDF");
+    check(SchedAnalysis::prescreen(miss, timing({ 2, 2, 3 })) == SchedAnalysis::UNSCHEDULABLE,
+          "QPA, unschedulable (U < 1)");
+    check(SchedAnalysis::prescreen(config({ task("T0", 10, 4) }, "EDF"), timing({ 3 }, { 2 }))
+          == SchedAnalysis::UNKNOWN, "WCET and jitter larger than the deadline");
+    check(SchedAnalysis::prescreen(config({ task("T0", 10, 4) }, "EDF"), timing({ 5 }))
+          == SchedAnalysis::UNSCHEDULABLE, "WCET larger than the deadline");
+
+    // Global fixed priorities (Bertogna-Cirinei), m = 2
+    KernelConfig bc = config({ task("T0", 4, 0, "1"), task("T1", 5, 0, "2"), task("T2", 10, 0, "3") },
+                             "FIXED_PRIORITY", 2);
+    SchedAnalysis gfp(bc, timing({ 1, 1, 3 }));
+    check(gfp.analyze() == SchedAnalysis::SCHEDULABLE, "global FP");
+    check(responseTimes(gfp, 3) == std::vector<long long>({ 1, 1, 4 }), "global FP response times");
+    gfp.setTiming(2, TaskTiming(9));
+    check(gfp.analyze() == SchedAnalysis::UNKNOWN, "global FP, sufficient test failed");
+
+    // Global EDF (GFB density test), m = 2
+    KernelConfig gfb = config({ task("T0", 10), task("T1", 10), task("T2", 10), task("T3", 10) }, "EDF", 2);
+    check(SchedAnalysis::prescreen(gfb, timing({ 2, 3, 4, 2 })) == SchedAnalysis::SCHEDULABLE,
+          "GFB, density bound met");
+    check(SchedAnalysis::prescreen(gfb, timing({ 9, 9, 1, 0 })) == SchedAnalysis::UNKNOWN,
+          "GFB, density bound failed");
+    check(SchedAnalysis::prescreen(gfb, timing({ 9, 9, 3, 0 })) == SchedAnalysis::UNSCHEDULABLE,
+          "global EDF, overload");
+
+    // screen(): bounds and analysis of the undecided candidates (the WCET
+    // of task i in candidate c is wcet[i * 3 + c])
+    const double wcet[] = { 1, 1, 1,   2, 2, 2,   3, 9, 4 };
+    SchedAnalysis::Verdict out[3];
+    SchedAnalysis(ok, timing({ 1, 2, 3 })).screen(wcet, 3, out);
+    check(out[0] == SchedAnalysis::SCHEDULABLE && out[1] == SchedAnalysis::UNSCHEDULABLE
+          && out[2] == SchedAnalysis::SCHEDULABLE, "screen");
+
+    // CAN, Davis et al. (2007): C = 1 ms (135 bits at 135 kbit/s), A with
+    // T = 2.5 ms, B and C with T = 3.5 ms and D = 3.25 ms; the second
+    // instance of C has the largest response time
+    CanAnalysis can({ "CAN;0x100;0.0025;", "CAN;0x200;0.0035;", "CAN;0x300;0.0035;" },
+                    { "bitrate;135000;" }, 1e6);
+    can.setDeadline(1, 0.00325);
+    can.setDeadline(2, 0.00325);
+    check(can.analyze() == CanAnalysis::UNKNOWN, "CAN, deadline miss");
+    check(can.getFrameTime(0) == 1000 && can.getResponseTime(0) == 2000 && can.getResponseTime(1) == 3000
+          && can.getResponseTime(2) == 3500, "CAN response times");
+
+    // The stuffing modes of the network engine, and the parameters of the
+    // rows without a period
+    CanAnalysis omnet({ "CAN;0x100;", "CAN;0x200;" }, { "stuffing;exact;", "message;0x100;0.01;" }, 1e6);
+    omnet.analyze();
+    check(omnet.getResponseTime(0) > 0 && omnet.getResponseTime(1) == CanAnalysis::NOT_BOUNDED,
+          "CAN message items");
+    bool rejected = false;
+    try
+    {
+        CanAnalysis bad({ "CAN;0x100;0.01;" }, { "stuffing;worts;" }, 1e6);
+    }
+    catch (CanAnalysisExc &)
+    {
+        rejected = true;
+    }
+    check(rejected, "CAN, unknown stuffing mode");
+
+    return status();
+}
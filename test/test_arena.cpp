@@ -0,0 +1,96 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_arena.cpp
+ *
+ * Check the allocation, alignment and release of tres::Arena
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <tres/Arena.hpp>
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+/** Records the order in which the objects are destroyed */
+struct Tracked
+{
+    Tracked(std::vector<int> &log, int id) : _log(log), _id(id) {}
+    ~Tracked() { _log.push_back(_id); }
+    std::vector<int> &_log;
+    int _id;
+};
+
+struct alignas(64) Aligned
+{
+    double v;
+};
+
+int main()
+{
+    std::vector<int> log;
+    {
+        Arena a(1024);
+        for (int i = 0; i < 3; ++i)
+            a.create<Tracked>(log, i);
+        int *n = a.create<int>(7);
+        Aligned *al = a.create<Aligned>();
+        std::string *s = a.create<std::string>(100, 'x');
+        check(*n == 7 && s->size() == 100, "objects built in place");
+        check(reinterpret_cast<std::uintptr_t>(al) % 64 == 0, "alignment");
+
+        const Arena::Stats &st = a.getStats();
+        // One more allocation for each registered destructor
+        check(st.allocations == 10 && st.finalizers == 4, "counters (trivial types need no destructor)");
+
+        // Larger than a block
+        char *big = static_cast<char *>(a.allocate(4096));
+        big[4095] = 1;
+        check(st.blocks >= 2 && st.reserved >= 4096 + 1024, "large allocation");
+
+        a.release();
+        check(log == std::vector<int>({ 2, 1, 0 }), "destructors in reverse order");
+        check(a.getStats().allocations == 0 && a.getStats().blocks == 0, "counters reset");
+
+        // The arena can be used again, and is released when destroyed
+        a.create<Tracked>(log, 3);
+    }
+    check(log == std::vector<int>({ 2, 1, 0, 3 }), "released by the destructor");
+
+    return status();
+}
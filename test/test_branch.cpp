@@ -0,0 +1,106 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_branch.cpp
+ *
+ * Check that the branches of a BranchRunner get streams of their own,
+ * reproducible from the seed, and that failing branches are reported
+ */
+
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <tres/BranchRunner.hpp>
+#include "RandomVar.hpp"
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+int main()
+{
+    const std::size_t N = 16;
+
+    // A variable bound to the default generator, replaced since, and one
+    // bound to the standard generator
+    UniformVar before(0, 1);
+    RandomVar::selectGenerator("xoshiro256**", 1);
+    UniformVar after(0, 1);
+
+    BranchRunner runner(N, 2, 42, 4);
+    BranchRunner::Body body = [&](std::size_t, double *res)
+    {
+        res[0] = before.get();
+        res[1] = after.get();
+    };
+    check(runner.run(body) == N, "all branches completed");
+    std::set<double> seen0, seen1;
+    for (std::size_t b = 0; b < N; ++b)
+    {
+        seen0.insert(runner.result(b)[0]);
+        seen1.insert(runner.result(b)[1]);
+    }
+    check(seen0.size() == N && seen1.size() == N, "a stream per branch");
+
+    // Same seed, same results; and the same as in the calling process
+    BranchRunner again(N, 2, 42, 2);
+    again.run(body);
+    bool same = true;
+    for (std::size_t b = 0; b < N; ++b)
+        same = same && again.result(b)[0] == runner.result(b)[0]
+            && again.result(b)[1] == runner.result(b)[1];
+    check(same, "reproducible from the seed");
+    RandomVar::reseed(42, 5);
+    double r0 = before.get(), r1 = after.get();
+    check(r0 == runner.result(5)[0] && r1 == runner.result(5)[1], "in-process continuation");
+
+    // Throwing and aborting branches
+    BranchRunner failing(4, 1, 1, 2);
+    std::size_t done = failing.run([](std::size_t b, double *res)
+    {
+        if (b == 1)
+            throw std::runtime_error("branch 1");
+        if (b == 2)
+            std::abort();
+        res[0] = static_cast<double>(b);
+    });
+    check(done == 2 && failing.completed(0) && !failing.completed(1) && !failing.completed(2)
+          && failing.completed(3), "failing branches");
+    BranchRunner::Summary s = failing.summarize(0);
+    check(s.count == 2 && s.min == 0 && s.max == 3 && s.mean == 1.5, "summary");
+
+    RandomVar::restoreGenerator();
+    return status();
+}
@@ -0,0 +1,231 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_cache.cpp
+ *
+ * Check the model cache: binary images, and the kernel configurations,
+ * PDFs and traces loaded through it (also from stale or corrupted
+ * entries)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <tres/KernelConfig.hpp>
+#include "GenericVar.hpp"
+#include "ModelCache.hpp"
+#include "RandomGen.hpp"
+#include "RandomVar.hpp"
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+typedef std::vector<std::string> strings;
+
+static const char *CACHE_DIR = "test_cache.d";
+
+/** The entries in the cache directory */
+static strings entries()
+{
+    strings out;
+    DIR *d = opendir(CACHE_DIR);
+    if (d == NULL)
+        return out;
+    while (struct dirent *e = readdir(d))
+    {
+        std::string n(e->d_name);
+        if (n.size() > 4 && n.compare(n.size() - 4, 4, ".img") == 0)
+            out.push_back(std::string(CACHE_DIR) + "/" + n);
+    }
+    closedir(d);
+    return out;
+}
+
+static void write(const std::string &file, const std::string &content)
+{
+    std::ofstream f(file.c_str(), std::ios::binary);
+    f << content;
+}
+
+/** Flip the last byte of a file (i.e., of the payload of an entry) */
+static void corrupt(const std::string &file)
+{
+    std::fstream f(file.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg(-1, std::ios::end);
+    char c = static_cast<char>(f.get());
+    f.seekp(-1, std::ios::end);
+    f.put(static_cast<char>(~c));
+}
+
+static bool sameConfig(const KernelConfig &a, const KernelConfig &b)
+{
+    if (a.tasks.size() != b.tasks.size())
+        return false;
+    for (std::vector<TaskConfig>::size_type i = 0; i < a.tasks.size(); ++i)
+    {
+        const TaskConfig &s = a.tasks[i], &t = b.tasks[i];
+        if (s.type != t.type || s.name != t.name || s.iat != t.iat || s.rdl != t.rdl
+            || s.ph != t.ph || s.params != t.params)
+            return false;
+    }
+    return a.scheduler.policy == b.scheduler.policy && a.scheduler.params == b.scheduler.params
+        && a.num_cores == b.num_cores && a.time_resolution == b.time_resolution
+        && a.name == b.name && a.generator == b.generator && a.seed == b.seed;
+}
+
+/** Samples of a variable, from the given seed of its generator */
+static std::vector<double> samples(RandomVar &v, RandomGen &g)
+{
+    g.init(7);
+    std::vector<double> out;
+    for (int i = 0; i < 100; ++i)
+        out.push_back(v.get());
+    return out;
+}
+
+static void checkImages()
+{
+    check(fnv1a("a", 1) == 0xaf63dc4c8601ec8cULL, "fnv1a");
+
+    BinaryWriter w;
+    w.put<int32_t>(-3);
+    w.putString("abc");
+    w.putVector(std::vector<double>({ 1.5, 2.5 }));
+    BinaryReader r(w.data().data(), w.data().size());
+    std::vector<double> v;
+    check(r.get<int32_t>() == -3 && r.getString() == "abc", "binary image (values)");
+    r.getVector(v);
+    check(v == std::vector<double>({ 1.5, 2.5 }) && r.atEnd(), "binary image (vector)");
+
+    BinaryReader t(w.data().data(), w.data().size() - 1);
+    bool thrown = false;
+    try
+    {
+        t.get<int32_t>();
+        t.getString();
+        t.getVector(v);
+    }
+    catch (BinaryIOExc &)
+    {
+        thrown = true;
+    }
+    check(thrown, "truncated image");
+}
+
+static void checkKernelConfig()
+{
+    strings d = { "2", "PeriodicTask;t1;0.01;0.01;0;3;", "Task;t2;0;0.05;0;1;x;",
+                  "EDF;", "1", "1000", "kern", "pcg64;5;" };
+    KernelConfig c = KernelConfig::fromStrings(d);
+    check(entries().size() == 1, "kernel configuration stored");
+    check(sameConfig(KernelConfig::fromStrings(d), c), "kernel configuration loaded");
+
+    BinaryWriter w;
+    c.serialize(w);
+    BinaryReader r(w.data().data(), w.data().size());
+    check(sameConfig(KernelConfig::deserialize(r), c) && r.atEnd(), "kernel configuration image");
+
+    corrupt(entries()[0]);
+    check(sameConfig(KernelConfig::fromStrings(d), c), "corrupted entry ignored");
+    check(sameConfig(KernelConfig::fromStrings(d), c), "corrupted entry rebuilt");
+
+    // A different description has its own entry
+    d[6] = "kern2";
+    check(KernelConfig::fromStrings(d).name == "kern2" && entries().size() == 2,
+          "changed description");
+
+    // Invalid descriptions are never cached
+    d[4] = "0";
+    bool thrown = false;
+    try
+    {
+        KernelConfig::fromStrings(d);
+    }
+    catch (KernelConfigExc &)
+    {
+        thrown = true;
+    }
+    check(thrown && entries().size() == 2, "invalid description");
+}
+
+static void checkDataFiles()
+{
+    MinStdGen g(1);
+    RandomGen *old = RandomVar::changeGenerator(&g);
+
+    write("test_cache.pdf", "1 0.2\n4 0.5\n10 0.3\n");
+    GenericVar p1("test_cache.pdf");
+    std::vector<double> s1 = samples(p1, g);
+    GenericVar p2("test_cache.pdf");
+    check(samples(p2, g) == s1, "PDF loaded");
+
+    write("test_cache.trc", "3 1 4 1 5\n");
+    DetVar t1("test_cache.trc");
+    DetVar t2("test_cache.trc");
+    std::vector<double> v1 = samples(t1, g);
+    check(samples(t2, g) == v1 && v1[2] == 4, "trace loaded");
+    check(entries().size() == 4, "PDF and trace stored");
+
+    // A changed file is a new entry (the stale one is not used)
+    write("test_cache.trc", "2 7\n");
+    DetVar t3("test_cache.trc");
+    check(t3.get() == 2 && t3.get() == 7 && entries().size() == 5, "changed trace");
+
+    RandomVar::changeGenerator(old);
+    std::remove("test_cache.pdf");
+    std::remove("test_cache.trc");
+}
+
+int main()
+{
+    // The cache reads the directory when first used
+    mkdir(CACHE_DIR, 0755);
+    strings old = entries();
+    for (strings::const_iterator e = old.begin(); e != old.end(); ++e)
+        std::remove(e->c_str());
+    setenv("TRES_CACHE_DIR", CACHE_DIR, 1);
+    check(ModelCache::instance().enabled(), "cache enabled");
+
+    checkImages();
+    checkKernelConfig();
+    checkDataFiles();
+
+    return status();
+}
@@ -0,0 +1,177 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_can.cpp
+ *
+ * Check the frame lengths and the response times of the native CAN
+ * engine (also against the bounds of CanAnalysis), the messages without a
+ * period, and that a network saved mid-run and restored into a fresh one
+ * goes on exactly as an uninterrupted run
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <tres_analysis/CanAnalysis.hpp>
+#include <tres_native/NetworkCanNative.hpp>
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+/** An event of the network: time, name and message */
+typedef std::tuple<long long, std::string, std::string> CanTrace;
+
+/**
+ * Simulate up to the horizon and return the events. If cut > 0, the
+ * network is saved at that time and the simulation goes on with a fresh
+ * network restored from the snapshot
+ */
+static std::vector<CanTrace> simulate(const std::vector<std::string> &msgs, const std::vector<std::string> &ndescr,
+                                      long long horizon, long long cut, std::unique_ptr<NetworkCanNative> &n)
+{
+    std::vector<CanTrace> trace;
+    n.reset(new NetworkCanNative(msgs, ndescr, 1e6));
+    while (n->getTimeOfNextEvent() < horizon)
+    {
+        if (cut > 0 && n->getTimeOfNextEvent() >= cut)
+        {
+            BinaryWriter w;
+            n->saveState(w);
+            n.reset(new NetworkCanNative(msgs, ndescr, 1e6));
+            BinaryReader r(w.data().data(), w.data().size());
+            n->loadState(r);
+            check(r.atEnd(), "whole snapshot read");
+            cut = 0;
+        }
+        NetworkEvent *e = n->getNextEvent();
+        SimMessage *m = e->getGeneratorMessage();
+        trace.push_back(CanTrace(e->getTime(), e->getName(), m ? m->getUID() : ""));
+        n->processNextEvent();
+    }
+    return trace;
+}
+
+int main()
+{
+    // Standard and extended frames of 8 bytes, with the largest number
+    // of stuff bits
+    check(NetworkCanNative::getFrameBits(false, 8) == 135, "standard frame bits");
+    check(NetworkCanNative::getFrameBits(true, 8) == 160, "extended frame bits");
+    check(NetworkCanNative::getFrameBits(false, 0) == 55, "empty frame bits");
+
+    // Two controllers queuing at the same time (1 Mbit/s, microseconds):
+    // the lower identifier wins
+    std::unique_ptr<NetworkCanNative> n;
+    simulate({ "CAN;0x200;0.01;", "CAN;0x100;0.01;" }, { "bitrate;1000000;" }, 100000, 0, n);
+    check(n->getFrameDuration(0) == 135, "frame duration");
+    check(n->getMessageStats(1).delivered == 10 && n->getMessageStats(1).max_response == 135,
+          "response of the higher priority");
+    check(n->getMessageStats(0).delivered == 10 && n->getMessageStats(0).max_response == 270,
+          "response of the lower priority");
+
+    // The response times include the queuing jitter
+    simulate({ "CAN;0x100;0.01;8;A;0;0.002;" }, { "bitrate;1000000;" }, 1000000, 0, n);
+    check(n->getMessageStats(0).max_response > 135 && n->getMessageStats(0).max_response <= 2135,
+          "response time from the start of the period");
+
+    // The example of Davis et al. (2007): the simulation of the critical
+    // instant reaches the bound of the second instance of the lowest
+    // priority message
+    std::vector<std::string> davis = { "CAN;0x100;0.0025;", "CAN;0x200;0.0035;", "CAN;0x300;0.0035;" };
+    simulate(davis, { "bitrate;135000;" }, 100000, 0, n);
+    CanAnalysis can(davis, { "bitrate;135000;" }, 1e6);
+    can.analyze();
+    std::vector<long long> observed;
+    for (std::size_t i = 0; i < davis.size(); ++i)
+        observed.push_back(n->getMessageStats(i).max_response);
+    std::ostringstream report;
+    check(can.report(report, observed) == 0, "response times within the bounds");
+    check(observed[2] == can.getResponseTime(2) && observed[2] == 3500, "bound of the lowest priority reached");
+
+    // Rows of an OMNeT++ message-set: the parameters come from the network
+    // description, or the message is never queued (500 kbit/s)
+    simulate({ "CAN;0x300;", "CAN;0x301;" }, { "message;0x301;0.02;4;" }, 100000, 0, n);
+    check(n->getMessageStats(0).queued == 0, "message without a period");
+    check(n->getMessageStats(1).queued == 5 && n->getMessageStats(1).delivered == 5,
+          "message with the parameters of the network description");
+    check(n->getFrameDuration(1) == 2 * NetworkCanNative::getFrameBits(false, 4), "DLC of the network description");
+
+    bool rejected = false;
+    try
+    {
+        NetworkCanNative bad({ "CAN;0x300;0;" }, {}, 1e6);
+    }
+    catch (NetworkCanNativeExc &)
+    {
+        rejected = true;
+    }
+    check(rejected, "null period");
+
+    // A snapshot taken mid-run, with jitter, pseudo-random data and errors
+    std::vector<std::string> msgs = { "CAN;0x100;0.005;8;A;0;0.001;", "CAN;0x180;0.007;6;A;0.001;0.002;",
+                                      "CAN;0x1abcd;0.01;8;B;0;0.003;", "CAN;0x050;0.02;2;C;" };
+    std::vector<std::string> ndescr = { "bitrate;250000;", "stuffing;exact;", "errors;random:0.05;", "seed;7;" };
+    std::unique_ptr<NetworkCanNative> ref, restored;
+    std::vector<CanTrace> a = simulate(msgs, ndescr, 200000, 0, ref);
+    std::vector<CanTrace> b = simulate(msgs, ndescr, 200000, 73331, restored);
+    check(a == b, "events after the restore");
+    check(ref->getStats().errors > 0 && ref->getStats().errors == restored->getStats().errors
+          && ref->getStats().busy == restored->getStats().busy, "counters after the restore");
+    for (std::size_t i = 0; i < msgs.size(); ++i)
+        check(ref->getMessageStats(i).total_response == restored->getMessageStats(i).total_response,
+              "response times after the restore");
+
+    // A snapshot of a network does not fit another message-set
+    BinaryWriter w;
+    ref->saveState(w);
+    msgs.pop_back();
+    NetworkCanNative other(msgs, ndescr, 1e6);
+    rejected = false;
+    try
+    {
+        BinaryReader r(w.data().data(), w.data().size());
+        other.loadState(r);
+    }
+    catch (BinaryIOExc &)
+    {
+        rejected = true;
+    }
+    check(rejected, "snapshot of a different configuration");
+
+    return status();
+}
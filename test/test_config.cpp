@@ -0,0 +1,146 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_config.cpp
+ *
+ * Check the parsing of the string form of the kernel configuration
+ */
+
+#include <string>
+#include <vector>
+#include <tres/KernelConfig.hpp>
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+typedef std::vector<std::string> strings;
+
+/** The string form of a kernel configuration with the given tasks */
+static strings descr(const strings &tasks, const strings &tail = strings())
+{
+    strings d(1, std::to_string(tasks.size()));
+    d.insert(d.end(), tasks.begin(), tasks.end());
+    d.push_back("FIXED_PRIORITY;");
+    d.push_back("2");
+    d.push_back("1000");
+    d.push_back("kern");
+    d.insert(d.end(), tail.begin(), tail.end());
+    return d;
+}
+
+/** Whether parsing the description throws a KernelConfigExc */
+static bool rejected(const strings &d)
+{
+    try
+    {
+        KernelConfig::fromStrings(d);
+    }
+    catch (KernelConfigExc &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    KernelConfig c = KernelConfig::fromStrings(descr({
+        "PeriodicTask;t1;0.01;0.01;0;",
+        "PeriodicTask;t2;0.02;0.015;0.001;3;",
+        "Task;t3;0;0.05;0;2;1;x;(4,5);" }));
+    check(c.tasks.size() == 3 && c.num_cores == 2 && c.time_resolution == 1000
+          && c.name == "kern" && c.scheduler.policy == "FIXED_PRIORITY"
+          && c.scheduler.params.empty(), "platform and scheduler");
+    check(c.generator.empty(), "no generator");
+
+    const TaskConfig &t1 = c.tasks[0], &t2 = c.tasks[1], &t3 = c.tasks[2];
+    check(t1.type == "PeriodicTask" && t1.name == "t1" && t1.iat == 0.01
+          && t1.rdl == 0.01 && t1.ph == 0 && t1.params.empty(), "task with 5 fields");
+    check(t2.ph == 0.001 && t2.params == strings({ "3" }), "task with 6 fields");
+    check(t3.isAperiodic() && t3.params == strings({ "2", "1", "x", "(4,5)" }),
+          "task with more than 7 fields (kept as is)");
+
+    double v = 0;
+    check(t2.getNumericParam(0, v) && v == 3, "numeric parameter");
+    check(!t2.getNumericParam(1, v), "missing parameter");
+    bool thrown = false;
+    try
+    {
+        t3.getNumericParam(2, v);
+    }
+    catch (KernelConfigExc &)
+    {
+        thrown = true;
+    }
+    check(thrown, "non-numeric parameter");
+
+    c = KernelConfig::fromStrings(descr({ "PeriodicTask;t1;1;1;0;" }, { "minstd;42;" }));
+    check(c.generator == "minstd" && c.seed == 42, "generator and seed");
+    c.selectGenerator();
+    c.generator = "no-such-generator";
+    thrown = false;
+    try
+    {
+        c.selectGenerator();
+    }
+    catch (KernelConfigExc &)
+    {
+        thrown = true;
+    }
+    check(thrown, "unknown generator");
+
+    check(rejected(descr({ "PeriodicTask;t1;1;1;" })), "task with 4 fields");
+    check(rejected(descr({ "PeriodicTask;t1;x;1;0;" })), "non-numeric inter-arrival time");
+    check(rejected(descr({ "PeriodicTask;t1;0;1;0;" })), "periodic task without period");
+    check(rejected(descr({ "PeriodicTask;t1;1;-1;0;" })), "negative deadline");
+    check(rejected(descr({ "PeriodicTask;t1;1;1;0;" }, { "minstd;42;1;" })), "malformed generator");
+    check(rejected(descr({ "PeriodicTask;t1;1;1;0;" }, { "minstd;", "x" })), "too many parameters");
+    // The time resolution is 1000: half a tick is 0.0005
+    check(rejected(descr({ "PeriodicTask;t1;0.0004;0.0004;0;" })), "inter-arrival time of 0 ticks");
+    check(rejected(descr({ "PeriodicTask;t1;1;0.0004;0;" })), "deadline of 0 ticks");
+    check(rejected(descr({ "Task;t1;0.0004;1;0;" })), "sporadic task with 0 ticks");
+    check(!rejected(descr({ "PeriodicTask;t1;0.0005;0.0005;0;", "Task;t2;0;1;0;" })),
+          "one tick, aperiodic task");
+
+    strings d = descr({ "PeriodicTask;t1;1;1;0;" });
+    d[0] = "2";
+    check(rejected(d), "wrong number of tasks");
+    d = descr({ "PeriodicTask;t1;1;1;0;" });
+    d[3] = "0";
+    check(rejected(d), "no CPU cores");
+
+    return status();
+}
@@ -0,0 +1,145 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_datatables.cpp
+ *
+ * Check the loader of PDF and trace files: parsing, residual
+ * probabilities, and interning of the tables
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "DataTables.hpp"
+#include "RandomVar.hpp"
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+typedef std::vector<double> doubles;
+
+static void write(const std::string &file, const std::string &content)
+{
+    std::ofstream f(file.c_str(), std::ios::binary);
+    f << content;
+}
+
+/** The PDF of a file with the given content */
+static std::shared_ptr<const PdfTable> pdf(const std::string &content, int mode = 0)
+{
+    write("test_datatables.pdf", content);
+    return DataTables::instance().pdf("test_datatables.pdf", mode);
+}
+
+/** Whether loading a PDF with the given content throws */
+static bool rejected(const std::string &content)
+{
+    try
+    {
+        pdf(content);
+    }
+    catch (RandomVar::Exc &)
+    {
+        return true;
+    }
+    return false;
+}
+
+static void checkPdf()
+{
+    std::shared_ptr<const PdfTable> p = pdf("4 0.5\n1 0.2\n10 0.3");
+    check(p->values == doubles({ 1, 4, 10 }) && p->probs == doubles({ 0.2, 0.5, 0.3 }),
+          "PDF without trailing newline (sorted by value)");
+    p = pdf("2.7 0.5\n5 0.5\n");
+    check(p->values == doubles({ 2, 5 }), "values truncated to integers");
+
+    p = pdf("1 0.2\n3 0.3\n");
+    check(p->values == doubles({ 1, 3 }), "residual (mode 0): values");
+    checkClose(p->probs[1], 0.8, 1e-12, "residual (mode 0) to the last value");
+    p = pdf("2 0.2\n3 0.3\n", 1);
+    check(p->values == doubles({ 1, 2, 3 }), "residual (mode 1): values");
+    checkClose(p->probs[0], 0.5, 1e-12, "residual (mode 1) to the value 1");
+
+    check(rejected("1 0.5\n1 0.5\n"), "duplicate value");
+    check(rejected("1 0.5\n1.5 0.5\n"), "duplicate truncated value");
+    check(rejected("1 0.7\n2 0.7\n"), "probabilities above 1");
+    check(rejected("1 0.5\n2\n"), "odd number of tokens");
+    check(rejected("1 0.5\n2 x\n"), "malformed number");
+    check(rejected(""), "empty PDF");
+}
+
+static void checkTrace()
+{
+    write("test_datatables.trc", "3 1\t4\n1 5\n");
+    std::shared_ptr<const doubles> t = DataTables::instance().trace("test_datatables.trc");
+    check(*t == doubles({ 3, 1, 4, 1, 5 }), "trace with trailing newline");
+
+    // Interned while in use; a rewritten file is reloaded, also if the
+    // old table is still referenced
+    check(DataTables::instance().trace("test_datatables.trc") == t, "trace interned");
+    write("test_datatables.trc", "2 7 1 8 2\n");
+    std::shared_ptr<const doubles> u = DataTables::instance().trace("test_datatables.trc");
+    check(*u == doubles({ 2, 7, 1, 8, 2 }) && *t == doubles({ 3, 1, 4, 1, 5 }),
+          "rewritten trace (same size)");
+
+    DetVar v("test_datatables.trc");
+    doubles s;
+    for (int i = 0; i < 7; ++i)
+        s.push_back(v.get());
+    check(s == doubles({ 2, 7, 1, 8, 2, 2, 7 }), "DetVar sequence");
+
+    bool thrown = false;
+    try
+    {
+        DataTables::instance().trace("no-such-file.trc");
+    }
+    catch (RandomVar::Exc &)
+    {
+        thrown = true;
+    }
+    check(thrown, "missing trace");
+}
+
+int main()
+{
+    checkPdf();
+    checkTrace();
+    std::remove("test_datatables.pdf");
+    std::remove("test_datatables.trc");
+    return status();
+}
@@ -0,0 +1,204 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_native.cpp
+ *
+ * Check the schedules of the native kernel against hand-computed
+ * examples
+ */
+
+#include <climits>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <tres_native/KernelNative.hpp>
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+typedef std::vector<long long> ticks;
+
+/** A periodic task with implicit deadline (priority, core: optional) */
+static TaskConfig task(const std::string &name, double iat, double ph = 0,
+                       const char *prio = NULL, const char *core = NULL)
+{
+    TaskConfig t;
+    t.type = "PeriodicTask";
+    t.name = name;
+    t.iat = iat;
+    t.rdl = iat;
+    t.ph = ph;
+    if (prio)
+        t.params.push_back(prio);
+    if (core)
+        t.params.push_back(core);
+    return t;
+}
+
+/** A configuration with the given tasks and policy */
+static KernelConfig config(const std::vector<TaskConfig> &tasks, const std::string &policy,
+                           const std::vector<std::string> &params = std::vector<std::string>(),
+                           int cores = 1)
+{
+    KernelConfig kc;
+    kc.name = "test";
+    kc.tasks = tasks;
+    kc.scheduler.policy = policy;
+    kc.scheduler.params = params;
+    kc.num_cores = cores;
+    return kc;
+}
+
+/**
+ * Simulate up to the horizon, as the co-simulation does (each job runs
+ * one instruction of c[i] ticks), and return the worst-case response
+ * time of each task (tasks are named "T<index>")
+ */
+static ticks simulate(const KernelConfig &kc, const std::vector<double> &c, long long horizon,
+                      KernelNative::Stats &stats)
+{
+    std::vector<const double*> pc;
+    for (std::vector<double>::size_type i = 0; i < c.size(); ++i)
+        pc.push_back(&c[i]);
+    ticks wcrt(c.size(), 0), jobs(c.size(), 0);
+
+    KernelNative *k = static_cast<KernelNative*>(KernelNative::createInstance(kc));
+    k->initializeSimulation(1, pc.data());
+    while (k->getTimeOfNextEvent() < horizon)
+    {
+        long long t = k->getTimeOfNextEvent();
+        while (k->getTimeOfNextEvent() == t)
+        {
+            RTOSEvent *e = k->getNextEvent();
+            if (e->getType() == RTOSEventType::END_TASK)
+            {
+                SimTask *task = e->getGeneratorTask();
+                int i = std::atoi(task->getUID().c_str() + 1);
+                const TaskConfig &tc = kc.tasks[i];
+                long long r = t - static_cast<long long>(tc.ph + jobs[i]++ * tc.iat);
+                if (r > wcrt[i])
+                    wcrt[i] = r;
+                task->discardInstructions();
+                task->addInstruction(c[i]);
+            }
+            k->processNextEvent();
+        }
+    }
+    stats = k->getStats();
+    delete k;
+    return wcrt;
+}
+
+static ticks simulate(const KernelConfig &kc, const std::vector<double> &c, long long horizon)
+{
+    KernelNative::Stats stats;
+    return simulate(kc, c, horizon, stats);
+}
+
+/** Whether building the kernel throws a KernelConfigExc */
+static bool rejected(const KernelConfig &kc)
+{
+    try
+    {
+        delete KernelNative::createInstance(kc);
+    }
+    catch (KernelConfigExc &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    // Response-time analysis textbook example: (C, T) = (3, 7), (3, 12),
+    // (5, 20), rate-monotonic priorities
+    KernelConfig fp = config({ task("T0", 7, 0, "1"), task("T1", 12, 0, "2"), task("T2", 20, 0, "3") },
+                             "FIXED_PRIORITY");
+    check(simulate(fp, { 3, 3, 5 }, 420) == ticks({ 3, 6, 20 }), "fixed priority (RTA example)");
+    fp.scheduler.policy = "RATE_MONOTONIC";
+    check(simulate(fp, { 3, 3, 5 }, 420) == ticks({ 3, 6, 20 }), "rate monotonic");
+    fp.scheduler.params.push_back("calendar");
+    check(simulate(fp, { 3, 3, 5 }, 420) == ticks({ 3, 6, 20 }), "calendar event queue");
+
+    // Hyperperiod replay (hyperperiod 420): same schedule, replayed
+    KernelNative::Stats stats;
+    fp.scheduler.params = { "replay" };
+    check(simulate(fp, { 3, 3, 5 }, 4200, stats) == ticks({ 3, 6, 20 }) && stats.replayed_periods > 0,
+          "hyperperiod replay");
+
+    // A full utilization set: schedulable by EDF only
+    KernelConfig edf = config({ task("T0", 4), task("T1", 6) }, "EDF");
+    simulate(edf, { 2, 3 }, 120, stats);
+    check(stats.deadline_misses == 0 && stats.jobs == 30 + 20, "EDF (U = 1)");
+    edf.scheduler.policy = "RATE_MONOTONIC";
+    simulate(edf, { 2, 3 }, 120, stats);
+    check(stats.deadline_misses > 0, "rate monotonic (U = 1) misses");
+
+    // Round robin (quantum 1) and FIFO on two jobs released together
+    KernelConfig rr = config({ task("T0", 10), task("T1", 10) }, "RR", { "1" });
+    check(simulate(rr, { 2, 2 }, 10) == ticks({ 3, 4 }), "round robin");
+    rr.scheduler.policy = "FIFO";
+    rr.scheduler.params.clear();
+    check(simulate(rr, { 2, 2 }, 10) == ticks({ 2, 4 }), "FIFO");
+
+    // Partitioned on two cores (T0 and T1 share core 0)
+    KernelConfig part = config({ task("T0", 10, 0, "1", "0"), task("T1", 10, 0, "2", "0"),
+                                 task("T2", 10, 0, "3", "1") },
+                               "FIXED_PRIORITY", { "partitioned" }, 2);
+    check(simulate(part, { 3, 3, 3 }, 10) == ticks({ 3, 6, 3 }), "partitioned");
+    part.scheduler.params = { "clustered:1" };
+    check(simulate(part, { 3, 3, 3 }, 10) == ticks({ 3, 6, 3 }), "clustered:1");
+    part.scheduler.params = { "global" };
+    check(simulate(part, { 3, 3, 3 }, 10) == ticks({ 3, 3, 6 }), "global");
+    part.scheduler.params = { "clustered:2" };
+    check(simulate(part, { 3, 3, 3 }, 10) == ticks({ 3, 3, 6 }), "clustered:2");
+
+    // Worst-fit packing of unpinned tasks: T0 and T1 (the heaviest) go to
+    // different cores, T2 joins the lighter one
+    KernelConfig wfd = config({ task("T0", 10, 0, "1"), task("T1", 10, 0, "2"),
+                                task("T2", 10, 0, "3") },
+                              "FIXED_PRIORITY", { "partitioned", "wfd" }, 2);
+    check(simulate(wfd, { 5, 4, 3 }, 10) == ticks({ 5, 4, 7 }), "partitioned, worst-fit decreasing");
+
+    check(rejected(config({ task("T0", 10, 0, "1", "2") }, "FIXED_PRIORITY", {}, 2)),
+          "core out of range");
+    check(rejected(config({ task("T0", 10, 0, "x") }, "FIXED_PRIORITY")), "non-numeric priority");
+    check(rejected(config({ task("T0", 10) }, "RR")), "round robin without quantum");
+    check(rejected(config({ task("T0", 10) }, "LOTTERY")), "unknown policy");
+
+    return status();
+}
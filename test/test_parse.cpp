@@ -0,0 +1,113 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_parse.cpp
+ *
+ * Check the tokenizers of tres_parse_utils, both the std::string and the
+ * str_slice ones, on the forms found in task and instruction descriptors
+ */
+
+#include <string>
+#include <vector>
+#include <tres/ParseUtils.hpp>
+#include "Test.hpp"
+
+using namespace tres_parse_utils;
+using namespace tres_test;
+
+typedef std::vector<std::string> strings;
+
+/** The slice-based tokens, as strings */
+static strings str(const std::vector<str_slice> &s)
+{
+    strings out;
+    to_strings(s, out);
+    return out;
+}
+
+int main()
+{
+    check(remove_spaces("  x y  ") == "x y", "remove_spaces");
+    check(remove_spaces("") == "", "remove_spaces (empty)");
+
+    // A trailing substring without separator is ignored
+    strings instr = { "PeriodicTask", "t1", "10", "" };
+    check(split_instr(" PeriodicTask ; t1;10 ; ;tail") == instr, "split_instr");
+    std::vector<str_slice> si;
+    split_instr(str_slice(" PeriodicTask ; t1;10 ; ;tail"), si);
+    check(str(si) == instr, "split_instr (slices)");
+
+    instr_tokenizer tk(str_slice("a; b ;c"));
+    str_slice t;
+    strings toks;
+    while (tk.next(t))
+        toks.push_back(t.str());
+    check(toks == strings({ "a", "b" }), "instr_tokenizer");
+
+    check(split("1, 2,3", ",", "(", ")") == strings({ "1", "2", "3" }), "split");
+
+    check(get_token("  unif(1, 2)") == "unif", "get_token");
+    check(get_param("unif(1, 2)") == "1, 2", "get_param");
+    check(get_param("fixed") == "", "get_param (none)");
+    check(get_token(str_slice("  unif(1, 2)")) == "unif", "get_token (slices)");
+    check(get_param(str_slice("unif(1, 2)")) == "1, 2", "get_param (slices)");
+
+    // Parenthesized parameters are kept whole
+    strings par = { "1", "(2,3)", "4" };
+    check(split_param("1, (2,3), 4") == par, "split_param");
+    std::vector<str_slice> sp;
+    split_param(str_slice("1, (2,3), 4"), sp);
+    check(str(sp) == par, "split_param (slices)");
+
+    bool thrown = false;
+    try
+    {
+        split_param("1,(2");
+    }
+    catch (ParseExc &)
+    {
+        thrown = true;
+    }
+    check(thrown, "split_param (unmatched parenthesis)");
+
+    check(to_double(str_slice("2.5")) == 2.5 && to_int(str_slice("42")) == 42, "to_double, to_int");
+
+    double v;
+    std::string unit;
+    parse_double(" 3.5ms ", v, unit);
+    check(v == 3.5 && unit == "ms", "parse_double");
+
+    return status();
+}
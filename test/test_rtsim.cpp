@@ -0,0 +1,145 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_rtsim.cpp
+ *
+ * Check that the native kernel produces the same schedules as the RTSim
+ * one, and that RTSim kernels refuse to be saved (built with
+ * -DTRES_TEST_RTSIM=ON, as it needs RTSim)
+ */
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tres_native/KernelNative.hpp>
+#include <tres_rtsim/KernelRtSim.hpp>
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+/** The end of a job: time and task */
+typedef std::pair<long long, std::string> JobEnd;
+
+/** The string form of a configuration with the given tasks and policy */
+static std::vector<std::string> descr(const std::vector<std::string> &tasks,
+                                      const std::string &policy)
+{
+    std::vector<std::string> d(1, std::to_string(tasks.size()));
+    d.insert(d.end(), tasks.begin(), tasks.end());
+    d.push_back(policy);
+    d.push_back("1");
+    d.push_back("1");
+    d.push_back("test");
+    return d;
+}
+
+/**
+ * Simulate up to the horizon, as the co-simulation does (each job runs
+ * one instruction of c[i] ticks, in the order of the task-set), and
+ * return the ends of the jobs
+ */
+static std::vector<JobEnd> simulate(Kernel *k, const KernelConfig &kc,
+                                    const std::vector<double> &c, long long horizon)
+{
+    std::vector<const double*> pc;
+    for (std::vector<double>::size_type i = 0; i < c.size(); ++i)
+        pc.push_back(&c[i]);
+    std::vector<JobEnd> ends;
+
+    k->initializeSimulation(1, pc.data());
+    while (k->getTimeOfNextEvent() < horizon)
+    {
+        long long t = k->getTimeOfNextEvent();
+        while (k->getTimeOfNextEvent() == t)
+        {
+            RTOSEvent *e = k->getNextEvent();
+            if (e->getType() == RTOSEventType::END_TASK)
+            {
+                SimTask *task = e->getGeneratorTask();
+                for (std::vector<TaskConfig>::size_type i = 0; i < kc.tasks.size(); ++i)
+                    if (kc.tasks[i].name == task->getUID())
+                    {
+                        ends.push_back(JobEnd(t, task->getUID()));
+                        task->discardInstructions();
+                        task->addInstruction(c[i]);
+                    }
+            }
+            k->processNextEvent();
+        }
+    }
+    delete k;
+    return ends;
+}
+
+static void compare(const std::vector<std::string> &d, const std::vector<double> &c,
+                    long long horizon, const char *what)
+{
+    KernelConfig kc = KernelConfig::fromStrings(d);
+    std::vector<std::string> par(d);
+    std::vector<JobEnd> rtsim = simulate(KernelRtSim::createInstance(par), kc, c, horizon);
+    std::vector<JobEnd> native = simulate(KernelNative::createInstance(kc), kc, c, horizon);
+    check(!native.empty() && native == rtsim, what);
+}
+
+int main()
+{
+    compare(descr({ "PeriodicTask;T0;7;7;0;1;", "PeriodicTask;T1;12;12;0;2;",
+                    "PeriodicTask;T2;20;20;0;3;" }, "FIXED_PRIORITY;"),
+            { 3, 3, 5 }, 420, "fixed priority");
+    compare(descr({ "PeriodicTask;T0;4;4;0;", "PeriodicTask;T1;6;6;1;" }, "EDF;"),
+            { 2, 2 }, 120, "EDF");
+    compare(descr({ "PeriodicTask;T0;5;5;0;", "PeriodicTask;T1;10;8;2;" }, "DEADLINE_MONOTONIC;"),
+            { 2, 3 }, 100, "deadline monotonic");
+
+    // MetaSim keeps its events in a global queue: no (incomplete) snapshots
+    std::vector<std::string> d = descr({ "PeriodicTask;T0;4;4;0;" }, "EDF;");
+    Kernel *k = KernelRtSim::createInstance(d);
+    bool rejected = false;
+    try
+    {
+        BinaryWriter w;
+        k->saveState(w);
+    }
+    catch (BinaryIOExc &)
+    {
+        rejected = true;
+    }
+    check(rejected, "RTSim snapshot");
+    delete k;
+
+    return status();
+}
@@ -0,0 +1,187 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_sampling.cpp
+ *
+ * Check that RandomVar::fill() returns the same sequence as consecutive
+ * calls of get(), and that segments draw their durations in the order of
+ * the generator unless prefetching is enabled
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include "FixedExecSegment.hpp"
+#include "GenericVar.hpp"
+#include "RandExecSegment.hpp"
+#include "RandomVar.hpp"
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+/** Build a variable bound to the standard generator */
+typedef RandomVar* (*Maker)();
+
+static RandomVar* uniform() { return new UniformVar(2, 5); }
+static RandomVar* exponential() { return new ExponentialVar(3); }
+static RandomVar* pareto() { return new ParetoVar(1, 2.5); }
+static RandomVar* normal() { return new NormalVar(10, 2); }
+static RandomVar* poisson() { return new PoissonVar(4); }
+static RandomVar* poissonLarge() { return new PoissonVar(500); }
+static RandomVar* dist() { return new DistVar({ {3, 0.3}, {7, 1} }); }
+static RandomVar* generic() { return new GenericVar("test_sampling.pdf"); }
+
+/** fill() against get(), with the same seed on separate generators */
+static void checkFill(const char *name, Maker make)
+{
+    const size_t N = 10000;
+    std::vector<double> a(N), b(N);
+
+    MinStdGen g1(12345), g2(12345);
+    RandomVar::changeGenerator(&g1);
+    std::unique_ptr<RandomVar> v1(make());
+    RandomVar::changeGenerator(&g2);
+    std::unique_ptr<RandomVar> v2(make());
+    RandomVar::restoreGenerator();
+
+    for (size_t i = 0; i < N; ++i)
+        a[i] = v1->get();
+    // Odd chunks, to cross the internal chunks of the variables
+    for (size_t i = 0; i < N; i += 77)
+        v2->fill(&b[i], std::min<size_t>(77, N - i));
+    check(a == b, name);
+}
+
+/** The generators of the factory, and the legacy sequence */
+static void checkGenerators()
+{
+    // Park and Miller's reference value
+    MinStdGen g(1);
+    RandNum x = 0;
+    for (int i = 0; i < 10000; ++i)
+        x = g.sample();
+    check(x == 1043618065, "minstd reference sequence");
+
+    // Selecting a generator by name (the same seed, the same sequence)
+    const char *names[] = { "minstd", "xoshiro256**", "pcg64" };
+    for (int k = 0; k < 3; ++k)
+    {
+        RandomVar::selectGenerator(names[k], 7);
+        UniformVar a(0, 1);
+        RandomVar::selectGenerator(names[k], 7);
+        UniformVar b(0, 1);
+        bool same = true, inside = true;
+        for (int i = 0; i < 1000; ++i)
+        {
+            double u = a.get();
+            same = same && (u == b.get());
+            inside = inside && (u > 0 && u < 1);
+        }
+        check(same && inside, names[k]);
+    }
+    RandomVar::restoreGenerator();
+}
+
+/** Two segments sharing the standard generator, drawn alternately */
+static void checkSegments()
+{
+    const int N = 200;
+
+    // The reference: the variables drawn directly
+    MinStdGen g(42);
+    UniformVar ra(1, 5, &g), rb(10, 20, &g);
+    std::vector<double> ref;
+    for (int i = 0; i < N; ++i)
+    {
+        ref.push_back(ra.get());
+        ref.push_back(rb.get());
+    }
+
+    // By default, segments give the same sequence
+    RandomVar::init(42);
+    RandExecSegment sa(new UniformVar(1, 5)), sb(new UniformVar(10, 20));
+    std::vector<double> seq;
+    for (int i = 0; i < N; ++i)
+    {
+        seq.push_back(sa.getDuration());
+        seq.push_back(sb.getDuration());
+    }
+    check(seq == ref, "segments reproduce the sequence of the generator");
+
+    // With prefetching, each segment draws a block of samples at once
+    check(!RandExecSegment::getPrefetch(), "prefetching is disabled by default");
+    RandExecSegment::setPrefetch(true);
+    RandomVar::init(42);
+    RandExecSegment pa(new UniformVar(1, 5)), pb(new UniformVar(1, 5));
+    RandExecSegment::setPrefetch(false);
+    MinStdGen h(42);
+    UniformVar rc(1, 5, &h);
+    std::vector<double> block, pblock, qblock;
+    for (int i = 0; i < 128; ++i)
+        block.push_back(rc.get());
+    for (int i = 0; i < 64; ++i)
+    {
+        pblock.push_back(pa.getDuration());
+        qblock.push_back(pb.getDuration());
+    }
+    pblock.insert(pblock.end(), qblock.begin(), qblock.end());
+    check(pblock == block, "prefetching segments draw blocks of samples");
+
+    FixedExecSegment f(3.5);
+    check(f.getDuration() == 3.5 && f.getWCET() == 3.5, "fixed segment");
+}
+
+int main()
+{
+    checkFill("uniform", uniform);
+    checkFill("exponential", exponential);
+    checkFill("pareto", pareto);
+    checkFill("normal", normal);
+    checkFill("poisson", poisson);
+    checkFill("poisson-ptrs", poissonLarge);
+    checkFill("dist", dist);
+    {
+        std::ofstream pdf("test_sampling.pdf");
+        pdf << "1 0.2\n4 0.5\n10 0.3\n";
+    }
+    checkFill("pdf", generic);
+    std::remove("test_sampling.pdf");
+    checkGenerators();
+    checkSegments();
+    return status();
+}
@@ -0,0 +1,208 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_snapshot.cpp
+ *
+ * Check that a native kernel saved mid-run and restored into a fresh one
+ * goes on exactly as an uninterrupted run, and that the generators and
+ * variables restore their positions
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <tres_native/KernelNative.hpp>
+#include "RandomVar.hpp"
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+/** The end of a job: time and task */
+typedef std::pair<long long, std::string> JobEnd;
+
+/** A periodic task with implicit deadline */
+static TaskConfig task(const std::string &name, double iat, double ph = 0)
+{
+    TaskConfig t;
+    t.type = "PeriodicTask";
+    t.name = name;
+    t.iat = iat;
+    t.rdl = iat;
+    t.ph = ph;
+    return t;
+}
+
+static KernelConfig config(const std::string &policy, const std::vector<std::string> &params, int cores)
+{
+    KernelConfig kc;
+    kc.name = "test";
+    kc.tasks = { task("T0", 7), task("T1", 12, 1), task("T2", 20), task("T3", 30, 2) };
+    kc.scheduler.policy = policy;
+    kc.scheduler.params = params;
+    kc.num_cores = cores;
+    return kc;
+}
+
+/**
+ * Simulate up to the horizon, as the co-simulation does (each job runs
+ * one instruction of c[i] ticks), and return the ends of the jobs. If
+ * cut > 0, the kernel is saved at that time and the simulation goes on
+ * with a fresh kernel restored from the snapshot
+ */
+static std::vector<JobEnd> simulate(const KernelConfig &kc, const std::vector<double> &c,
+                                    long long horizon, long long cut, KernelNative::Stats &stats)
+{
+    std::vector<const double*> pc;
+    for (std::vector<double>::size_type i = 0; i < c.size(); ++i)
+        pc.push_back(&c[i]);
+    std::vector<JobEnd> ends;
+
+    std::unique_ptr<Kernel> k(KernelNative::createInstance(kc));
+    k->initializeSimulation(1, pc.data());
+    while (k->getTimeOfNextEvent() < horizon)
+    {
+        long long t = k->getTimeOfNextEvent();
+        if (cut > 0 && t >= cut)
+        {
+            BinaryWriter w;
+            k->saveState(w);
+            k.reset(KernelNative::createInstance(kc));
+            k->initializeSimulation(1, pc.data());
+            BinaryReader r(w.data().data(), w.data().size());
+            k->loadState(r);
+            cut = 0;
+            continue;
+        }
+        while (k->getTimeOfNextEvent() == t)
+        {
+            RTOSEvent *e = k->getNextEvent();
+            if (e->getType() == RTOSEventType::END_TASK)
+            {
+                SimTask *task = e->getGeneratorTask();
+                ends.push_back(JobEnd(t, task->getUID()));
+                task->discardInstructions();
+                task->addInstruction(c[std::stoi(task->getUID().substr(1))]);
+            }
+            k->processNextEvent();
+        }
+    }
+    stats = static_cast<KernelNative*>(k.get())->getStats();
+    return ends;
+}
+
+/**
+ * Save at several times and compare with an uninterrupted run (the
+ * counters too, unless a hyperperiod is being replayed at the horizon:
+ * they are then updated at its end)
+ */
+static void checkKernel(const KernelConfig &kc, const char *what, bool counters = true)
+{
+    const std::vector<double> c = { 2, 3, 4, 6 };
+    KernelNative::Stats s0, s1;
+    std::vector<JobEnd> ref = simulate(kc, c, 2000, 0, s0);
+    bool same = !ref.empty();
+    for (long long cut = 1; cut < 2000; cut += 97)
+        same = same && simulate(kc, c, 2000, cut, s1) == ref
+            && (!counters || (s1.jobs == s0.jobs && s1.deadline_misses == s0.deadline_misses));
+    check(same, what);
+}
+
+/** Draw a few samples of the variables */
+static std::vector<double> draw(const std::vector<RandomVar*> &vars)
+{
+    std::vector<double> out;
+    for (int i = 0; i < 5; ++i)
+        for (std::vector<RandomVar*>::const_iterator v = vars.begin(); v != vars.end(); ++v)
+            out.push_back((*v)->get());
+    return out;
+}
+
+int main()
+{
+    checkKernel(config("FIXED_PRIORITY", {}, 1), "fixed priority");
+    checkKernel(config("EDF", {}, 1), "EDF");
+    checkKernel(config("EDF", { "calendar" }, 1), "EDF, calendar event queue");
+    checkKernel(config("RR", { "2" }, 1), "round robin");
+    checkKernel(config("EDF", { "global" }, 2), "global EDF");
+    checkKernel(config("RATE_MONOTONIC", { "partitioned" }, 2), "partitioned");
+    checkKernel(config("FIXED_PRIORITY", { "replay" }, 1), "hyperperiod replay", false);
+
+    // A snapshot of a kernel does not fit another configuration
+    BinaryWriter w;
+    std::unique_ptr<Kernel> k(KernelNative::createInstance(config("EDF", {}, 1)));
+    k->saveState(w);
+    KernelConfig other = config("EDF", {}, 1);
+    other.tasks.pop_back();
+    k.reset(KernelNative::createInstance(other));
+    bool rejected = false;
+    try
+    {
+        BinaryReader r(w.data().data(), w.data().size());
+        k->loadState(r);
+    }
+    catch (BinaryIOExc &)
+    {
+        rejected = true;
+    }
+    check(rejected, "snapshot of a different configuration");
+
+    // Variables bound to the default generator, to a replaced selected one
+    // and to the current one, and a variable with a generator of its own
+    MinStdGen own(7);
+    UniformVar v0(0, 1);
+    RandomVar::selectGenerator("xoshiro256**", 3);
+    UniformVar v1(0, 1);
+    RandomVar::selectGenerator("pcg64", 5);
+    NormalVar v2(0, 1);
+    UniformVar v3(0, 1, &own);
+    std::vector<RandomVar*> vars = { &v0, &v1, &v2, &v3 };
+    v2.get();   // leave a pending normal sample
+
+    BinaryWriter g;
+    RandomVar::saveGenerator(g);
+    for (std::vector<RandomVar*>::const_iterator v = vars.begin(); v != vars.end(); ++v)
+        (*v)->saveState(g);
+    std::vector<double> ref = draw(vars);
+    BinaryReader r(g.data().data(), g.data().size());
+    RandomVar::loadGenerator(r);
+    for (std::vector<RandomVar*>::const_iterator v = vars.begin(); v != vars.end(); ++v)
+        (*v)->loadState(r);
+    check(r.atEnd() && draw(vars) == ref, "generators and variables");
+    RandomVar::restoreGenerator();
+
+    return status();
+}
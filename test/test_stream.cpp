@@ -0,0 +1,143 @@
+/*********************************************************************
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2014,2015, ReTiS Lab., Scuola Superiore Sant'Anna.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the ReTiS Lab. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*********************************************************************/
+
+/**
+ * \file test_stream.cpp
+ *
+ * Check that StreamDetVar reads back the traces written by
+ * StreamDetVar::writeFile(), in both encodings
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "StreamDetVar.hpp"
+#include "Test.hpp"
+
+using namespace tres;
+using namespace tres_test;
+
+typedef std::vector<double> doubles;
+
+static const char *TRACE = "test_stream.bin";
+
+/** A trace longer than a few windows, with negative values and large jumps */
+static doubles makeTrace()
+{
+    doubles t;
+    for (int i = 0; i < 3 * static_cast<int>(StreamDetVar::WINDOW_SIZE) + 123; ++i)
+        t.push_back(0.001 * std::sin(0.01 * i) + (i % 1000 == 0 ? 5.0 : 0.0) - 0.0005);
+    return t;
+}
+
+/** Largest difference between the trace and n samples of the variable */
+static double maxError(const doubles &t, RandomVar &v, std::size_t from, std::size_t n)
+{
+    double err = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        err = std::fmax(err, std::fabs(v.get() - t[(from + i) % t.size()]));
+    return err;
+}
+
+static void checkEncoding(StreamDetVar::Encoding enc, double tol, const char *what)
+{
+    doubles t = makeTrace();
+    StreamDetVar::writeFile(TRACE, t, enc, 1e-9);
+
+    StreamDetVar v(TRACE);
+    std::printf("%s\n", what);
+    check(v.size() == t.size(), "  number of samples");
+    check(maxError(t, v, 0, 2 * t.size() + 10) <= tol, "  samples (starting over at the end)");
+
+    double mx = t[0], mn = t[0];
+    for (std::size_t i = 0; i < t.size(); ++i)
+    {
+        mx = std::fmax(mx, t[i]);
+        mn = std::fmin(mn, t[i]);
+    }
+    checkClose(v.getMaximum(), mx, tol, "  maximum");
+    checkClose(v.getMinimum(), mn, tol, "  minimum");
+
+    StreamDetVar w(TRACE, 5000);
+    check(maxError(t, w, 5000, 10000) <= tol, "  start offset");
+    w.seek(t.size() + 17);
+    check(maxError(t, w, 17, 5000) <= tol, "  seek (modulo the length)");
+
+    doubles f(t.size() + 1);
+    StreamDetVar z(TRACE);
+    z.fill(f.data(), f.size());
+    double err = 0;
+    for (std::size_t i = 0; i < f.size(); ++i)
+        err = std::fmax(err, std::fabs(f[i] - t[i % t.size()]));
+    check(err <= tol, "  fill");
+}
+
+/** Whether opening a trace throws */
+static bool rejected(const char *file)
+{
+    try
+    {
+        StreamDetVar v(file);
+    }
+    catch (RandomVar::Exc &)
+    {
+        return true;
+    }
+    return false;
+}
+
+int main()
+{
+    checkEncoding(StreamDetVar::RAW, 0, "raw");
+    checkEncoding(StreamDetVar::DELTA_VARINT, 0.5e-9 * 1.0001, "delta-varint");
+
+    std::vector<std::string> par = { TRACE, "3" };
+    std::unique_ptr<RandomVar> c(StreamDetVar::createInstance(par));
+    doubles t = makeTrace();
+    check(maxError(t, *c, 3, 100) <= 1e-9, "instance creator");
+
+    // Truncated and foreign files
+    {
+        std::ofstream f(TRACE, std::ios::binary);
+        f << "not a trace";
+    }
+    check(rejected(TRACE), "malformed file");
+    check(rejected("no-such-trace.bin"), "missing file");
+
+    std::remove(TRACE);
+    return status();
+}